@@ -181,48 +181,72 @@ pub fn main(macros: &[MacroDesc])
     let _ = args.next().expect("Should have an executable name");
     let mac_name = args.next().expect("Was not passed a macro name");
     let input_path = args.next();
+
+    let mut stdin_raw;
+    let mut fp_raw;
+    let stdin = if let Some(p) = input_path {
+            fp_raw = ::std::fs::File::open(p).unwrap();
+            &mut fp_raw as &mut /*dyn */::std::io::Read
+        }
+        else {
+            stdin_raw = ::std::io::stdin().lock();
+            &mut stdin_raw
+        };
+
+    if mac_name == "--server" {
+        // Session mode: serve requests until the compiler closes our stdin
+        // - Each request is a header (see `recv_request_header`) followed by the input stream(s)
+        while let Some(mac_name) = crate::serialisation::recv_request_header(&mut *stdin)
+        {
+            debug!("Request for {}\r", mac_name);
+            match macros.iter().find(|m| m.name == mac_name)
+            {
+            Some(m) => run_macro(m, &mut *stdin),
+            None => {
+                use std::io::Write;
+                ::std::io::stdout().write(&[1]).expect("Stdout write error?");
+                ::std::io::stdout().flush().expect("Stdout write error?");
+                },
+            }
+        }
+        note!("Session done");
+        return ;
+    }
+
     //eprintln!("Searching for macro {}\r", mac_name);
-    for m in macros
+    match macros.iter().find(|m| m.name == mac_name)
     {
-        if m.name == mac_name {
-            use std::io::Write;
-            ::std::io::stdout().write(&[0]).expect("Stdout write error?");
-            ::std::io::stdout().flush().expect("Stdout write error?");
-            debug!("Waiting for input\r");
-            let mut stdin_raw;
-            let mut fp_raw;
-            let stdin = if let Some(p) = input_path {
-                    fp_raw = ::std::fs::File::open(p).unwrap();
-                    &mut fp_raw as &mut /*dyn */::std::io::Read
-                }
-                else {
-                    stdin_raw = ::std::io::stdin().lock();
-                    &mut stdin_raw
-                };
-            let input = crate::serialisation::recv_token_stream(stdin);
-            debug!("INPUT = `{}`\r", input);
-            let output = match m.handler
-                {
-                MacroType::SingleStream(h) => {
-                    Span::freeze_definitions();
-                    (h)(input)
-                    },
-                MacroType::Attribute(h) => {
-                    let input_body = crate::serialisation::recv_token_stream(stdin);
-                    debug!("INPUT BODY = `{}`\r", input_body);
-                    Span::freeze_definitions();
-                    (h)(input, input_body)
-                    },
-                };
-            debug!("OUTPUT = `{}`\r", output);
-            let stdout = ::std::io::stdout();
-            crate::serialisation::send_token_stream(stdout.lock(), output);
-            ::std::io::Write::flush(&mut ::std::io::stdout()).expect("Stdout write error?");
-            note!("Done");
-            return ;
-        }
+    Some(m) => run_macro(m, stdin),
+    None => panic!("Unknown macro name '{}'", mac_name),
     }
-    panic!("Unknown macro name '{}'", mac_name);
+}
+
+fn run_macro(m: &MacroDesc, stdin: &mut /*dyn */::std::io::Read)
+{
+    use std::io::Write;
+    ::std::io::stdout().write(&[0]).expect("Stdout write error?");
+    ::std::io::stdout().flush().expect("Stdout write error?");
+    debug!("Waiting for input\r");
+    let input = crate::serialisation::recv_token_stream(&mut *stdin);
+    debug!("INPUT = `{}`\r", input);
+    let output = match m.handler
+        {
+        MacroType::SingleStream(h) => {
+            Span::freeze_definitions();
+            (h)(input)
+            },
+        MacroType::Attribute(h) => {
+            let input_body = crate::serialisation::recv_token_stream(&mut *stdin);
+            debug!("INPUT BODY = `{}`\r", input_body);
+            Span::freeze_definitions();
+            (h)(input, input_body)
+            },
+        };
+    debug!("OUTPUT = `{}`\r", output);
+    let stdout = ::std::io::stdout();
+    crate::serialisation::send_token_stream(stdout.lock(), output);
+    ::std::io::Write::flush(&mut ::std::io::stdout()).expect("Stdout write error?");
+    note!("Done");
 }
 
 pub fn is_available() -> bool {
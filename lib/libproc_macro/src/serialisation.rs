@@ -20,12 +20,7 @@ pub fn recv_token_stream<R: ::std::io::Read>(reader: R) -> TokenStream
                     continue
                     },
                 Token::SpanDef(sd) => {
-                    crate::Span::define(sd.idx,
-                        if sd.parent_idx == 0 { None } else { Some(crate::Span::from_raw(sd.parent_idx - 1)) },
-                        crate::span::SourceFile( sd.path.into(), sd.is_path_real ),
-                        sd.start_line .. sd.end_line,
-                        sd.start_ofs .. sd.end_ofs,
-                        );
+                    define_span(sd);
                     continue
                     },
                 Token::EndOfStream if end == "" => return TokenStream { inner: toks, },
@@ -86,6 +81,41 @@ pub fn recv_token_stream<R: ::std::io::Read>(reader: R) -> TokenStream
     }
 }
 
+fn define_span(sd: crate::protocol::SpanDef)
+{
+    crate::Span::define(sd.idx,
+        if sd.parent_idx == 0 { None } else { Some(crate::Span::from_raw(sd.parent_idx - 1)) },
+        crate::span::SourceFile( sd.path.into(), sd.is_path_real ),
+        sd.start_line .. sd.end_line,
+        sd.start_ofs .. sd.end_ofs,
+        );
+}
+
+/// Read the header of a session-mode request: the macro name, any new span definitions, then a reference to the call-site span
+///
+/// Returns `None` once the compiler has ended the session (closed our stdin)
+pub fn recv_request_header<R: ::std::io::Read>(reader: R) -> Option<String>
+{
+    let mut s = Reader::new(reader);
+    let name = match s.read_ent()
+        {
+        None => return None,
+        Some(Token::Ident(name)) => name,
+        Some(_) => panic!("Protocol error: request must start with a macro name"),
+        };
+    crate::Span::begin_request(1);
+    loop
+    {
+        match s.read_ent()
+        {
+        Some(Token::SpanDef(sd)) => define_span(sd),
+        Some(Token::SpanRef(idx)) => { crate::Span::begin_request(idx); break },
+        _ => panic!("Protocol error: expected call-site span in request header"),
+        }
+    }
+    Some(name)
+}
+
 // --------------------------------------------------------------------
 // 
 // --------------------------------------------------------------------
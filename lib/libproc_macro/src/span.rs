@@ -7,6 +7,8 @@ impl !Sync for Span {}
 
 static mut SPANS: Vec<Option<RealSpan>> = Vec::new();
 static mut SPANS_COMPLETE: bool = false;
+/// Index of the span for the current invocation (fixed at #1 when running a single macro)
+static mut CALL_SITE: usize = 1;
 impl Span
 {
     pub(crate) fn define(idx: usize, _parent: Option<Span>, source_file: SourceFile, lines: ::std::ops::Range<usize>, ofs: ::std::ops::Range<usize>) {
@@ -26,6 +28,13 @@ impl Span
     pub(crate) fn freeze_definitions() {
         unsafe { SPANS_COMPLETE = true; }
     }
+    /// Start a new request in session mode: spans from earlier requests are kept, new ones may be defined
+    pub(crate) fn begin_request(call_site: usize) {
+        unsafe {
+            SPANS_COMPLETE = false;
+            CALL_SITE = call_site;
+        }
+    }
     pub(crate) fn from_raw(idx: usize) -> Self {
         Span(idx)
     }
@@ -34,7 +43,8 @@ impl Span
 impl Span
 {
     pub fn call_site() -> Span {
-        Span(1)
+        // SAFE: Only written between requests, and spans are !Send
+        Span(unsafe { CALL_SITE })
     }
     //pub fn def_site() -> Span {
     //    Span(1)
@@ -18,7 +18,7 @@
 // - Cache messages for the current phase, clearing the cache (dropping) when various signatures match
 //  > Similar to the `log_get_last_function.py` script
 
-int g_debug_indent_level = 0;
+thread_local int g_debug_indent_level = 0;
 bool g_debug_enabled = true;
 ::std::string g_cur_phase;
 ::std::set< ::std::string>    g_debug_disable_map;
@@ -87,7 +87,8 @@ bool debug_enabled()
 }
 
 DebugTimedPhase::DebugTimedPhase(const char* name):
-    m_name(name)
+    m_name(name),
+    m_profile(name)
 {
     ::std::cout << m_name << ": V V V" << ::std::endl;
     g_cur_phase = m_name;
@@ -2633,6 +2633,8 @@ void Expand(::AST::Crate& crate)
     es.mode = ExpandMode::Final;
     Expand_Mod(es, ::AST::AbsolutePath(), crate.m_root_module);
     ASSERT_BUG(Span(), !es.has_missing, "Expand too too many attempts");
+    // No more macro invocations after this point
+    ProcMacro_StopServers();
 
     //Expand_Attrs(es, crate.m_attrs, AttrStage::Post,  [&](const Span& sp, const auto& d, const auto& a){ d.handle(sp, a, crate); });
 
@@ -16,7 +16,7 @@
 #include "proc_macro.hpp"
 #include <parse/lex.hpp>
 #include <parse/ttstream.hpp>
-#include <unordered_set>
+#include <unordered_map>
 #ifdef _WIN32
 # define NOMINMAX
 # define NOGDI  // Don't include GDI functions (defines some macros that collide with mrustc ones)
@@ -224,30 +224,16 @@ enum class FragType
     Block = 6,
     Pattern = 7,
 };
-struct ProcMacroInv:
-    public TokenStream
+/// A long-lived proc-macro child process, serving many invocations (see `main` in `lib/libproc_macro`)
+///
+/// Spawned with `--server` and fed one request at a time, each request being a header (macro name and call-site span)
+/// followed by the usual input token streams. Closing the child's stdin ends the session.
+struct ProcMacroServer
 {
-    Span    m_parent_span;
-    Span    m_this_span;
-    const ::HIR::ProcMacro& m_proc_macro_desc;
-    AST::Edition    m_edition;
-    ::std::ofstream m_dump_file_out;
-    ::std::ofstream m_dump_file_res;
-
-    /// Spans that have had an index assigned
-    ::std::unordered_map<const SpanInner*,size_t>  known_spans;
-    /// Span indexes that have been sent
-    ::std::unordered_set<size_t>  sent_spans;
-    size_t  next_span_index = 2;
+    ::std::string   m_executable;
 
     struct Handles
     {
-        //~Handles();
-        Handles() {}
-        Handles(Handles&&);
-        Handles(const Handles&) = delete;
-        Handles& operator=(Handles&&) = delete;
-        Handles& operator=(const Handles&) = delete;
 #ifdef _WIN32
         HANDLE  child_handle;
         HANDLE  child_stdin;
@@ -260,6 +246,40 @@ struct ProcMacroInv:
         // NOTE: stderr stays as our stderr
 #endif
     } handles;
+
+    /// Spans that have been sent to this child (and the index they were given)
+    ::std::unordered_map<const SpanInner*,size_t>  known_spans;
+    /// Keeps the spans in `known_spans` alive, so their addresses can't be reused by another span
+    ::std::vector<Span>  known_span_handles;
+    size_t  next_span_index = 1;
+
+    ProcMacroServer(const Span& sp, const char* executable);
+    ProcMacroServer(const ProcMacroServer&) = delete;
+    ProcMacroServer& operator=(const ProcMacroServer&) = delete;
+    ~ProcMacroServer();
+};
+namespace {
+    /// Idle proc-macro servers, keyed by executable path
+    ::std::map< ::std::string, ::std::vector<::std::unique_ptr<ProcMacroServer>> >& idle_proc_macro_servers() {
+        static ::std::map< ::std::string, ::std::vector<::std::unique_ptr<ProcMacroServer>> >    s_servers;
+        return s_servers;
+    }
+}
+
+struct ProcMacroInv:
+    public TokenStream
+{
+    Span    m_parent_span;
+    Span    m_this_span;
+    const ::HIR::ProcMacro& m_proc_macro_desc;
+    AST::Edition    m_edition;
+    ::std::ofstream m_dump_file_out;
+    ::std::ofstream m_dump_file_res;
+
+    /// Child process handling this invocation, returned to the idle list on destruction if `m_server_reusable`
+    ::std::unique_ptr<ProcMacroServer>  m_server;
+    /// Set once the child has finished this request (i.e. the next byte it reads is a new request header)
+    bool    m_server_reusable = false;
     bool    m_eof_hit = false;
 
 public:
@@ -358,10 +378,22 @@ public:
         this->send_bytes_raw(&v, sizeof(v));
     }
 
+    /// Get the index of a span in the child, sending its definition if this child hasn't seen it yet
+    size_t send_span(const Span& sp) {
+        auto it = m_server->known_spans.find(sp.get());
+        if( it != m_server->known_spans.end() )
+            return it->second;
+        auto index = m_server->next_span_index ++;
+        m_server->known_spans.insert(::std::make_pair(sp.get(), index));
+        m_server->known_span_handles.push_back(sp);
+        this->send_span_def(index, sp);
+        return index;
+    }
+    void send_span_ref(size_t index) {
+        this->send_u8(static_cast<uint8_t>(TokenClass::SpanRef));
+        this->send_v128u(index);
+    }
     void send_span_def(size_t index, const Span& sp) {
-        this->known_spans[sp.get()] = index;
-        this->sent_spans.insert(index);
-
         this->send_u8(static_cast<uint8_t>(TokenClass::SpanDef));
         this->send_v128u(index);
         this->send_v128u(0);    // TODO: Parent span
@@ -1676,8 +1708,28 @@ ProcMacroInv::ProcMacroInv(const Span& sp, AST::Edition edition, const char* exe
     {
         DEBUG("Set MRUSTC_DUMP_PROCMACRO=procmacro_dump to dump to `procmacro_dump-NNN-{out,res}.bin`");
     }
+    // Take an idle server for this executable, or start a new one
+    auto& idle = idle_proc_macro_servers()[executable];
+    if( !idle.empty() )
+    {
+        m_server = ::std::move(idle.back());
+        idle.pop_back();
+        DEBUG("Reusing proc macro server for `" << executable << "`");
+    }
+    else
+    {
+        m_server = ::std::unique_ptr<ProcMacroServer>(new ProcMacroServer(sp, executable));
+    }
+
+    // Request header: macro name, then the call-site span (#0 is always empty/undefined)
+    this->send_rword(proc_macro_desc.name.c_str());
+    this->send_span_ref( this->send_span(sp) );
+}
+ProcMacroServer::ProcMacroServer(const Span& sp, const char* executable):
+    m_executable(executable)
+{
 #ifdef _WIN32
-    std::string commandline = std::string{ executable } + " " + proc_macro_desc.name.c_str();
+    std::string commandline = std::string{ executable } + " --server";
     DEBUG(commandline);
 
     HANDLE stdin_read = INVALID_HANDLE_VALUE;
@@ -1754,7 +1806,7 @@ ProcMacroInv::ProcMacroInv(const Span& sp, AST::Edition edition, const char* exe
     posix_spawn_file_actions_addclose(&file_actions, stdout_pipes[0]);
     posix_spawn_file_actions_addclose(&file_actions, stdout_pipes[1]);
 
-    char*   argv[3] = { const_cast<char*>(executable), const_cast<char*>(proc_macro_desc.name.c_str()), nullptr };
+    char*   argv[3] = { const_cast<char*>(executable), const_cast<char*>("--server"), nullptr };
     DEBUG(argv[0] << " " << argv[1]);
     //char*   envp[] = { nullptr };
     int rv = posix_spawn(&this->handles.child_pid, executable, &file_actions, nullptr, argv, environ);
@@ -1769,86 +1821,54 @@ ProcMacroInv::ProcMacroInv(const Span& sp, AST::Edition edition, const char* exe
     close(stdout_pipes[1]);
 #endif
 
-    // Invocation span is #1 (#0 is always empty/undefined)
-    this->send_span_def(1, sp);
 }
-ProcMacroInv::Handles::Handles(Handles&& x):
-#ifdef _WIN32
-    child_handle(x.child_handle),
-    child_stdin(x.child_stdin),
-    child_stdout(x.child_stdout)
-#else
-    child_pid(x.child_pid),
-    child_stdin(x.child_stdin),
-    child_stdout(x.child_stdout)
-#endif
+ProcMacroServer::~ProcMacroServer()
 {
+    // Closing stdin ends the session, the child exits once it sees EOF
 #ifdef _WIN32
-    x.child_handle = INVALID_HANDLE_VALUE;
-    x.child_stdin = INVALID_HANDLE_VALUE;
-    x.child_stdout = INVALID_HANDLE_VALUE;
+    CloseHandle(this->handles.child_stdin);
+    CloseHandle(this->handles.child_stdout);
+    WaitForSingleObject(this->handles.child_handle, INFINITE);
+    CloseHandle(this->handles.child_handle);
 #else
-    x.child_pid = 0;
-    x.child_stdin = -1;
-    x.child_stdout = -1;
+    close(this->handles.child_stdin);
+    close(this->handles.child_stdout);
+    int status;
+    waitpid(this->handles.child_pid, &status, 0);
 #endif
-    DEBUG("");
 }
-#if 0
-ProcMacroInv::Handles& ProcMacroInv::Handles::operator=(Handles&& x)
+void ProcMacro_StopServers()
 {
-#ifdef _WIN32
-    child_handle = x.child_handle;
-    child_stdin  = x.child_stdin;
-    child_stdout = x.child_stdout;
-    x.child_handle = INVALID_HANDLE_VALUE;
-    x.child_stdin = INVALID_HANDLE_VALUE;
-    x.child_stdout = INVALID_HANDLE_VALUE;
-#else
-    child_pid = x.child_pid;
-    child_stdin = x.child_stdin;
-    child_stdout = x.child_stdout;
-
-    x.child_pid = 0;
-#endif
-    DEBUG("");
-    return *this;
+    idle_proc_macro_servers().clear();
 }
-#endif
 ProcMacroInv::~ProcMacroInv()
 {
-#ifdef _WIN32
-    if( this->handles.child_handle != INVALID_HANDLE_VALUE )
-    {
-        DEBUG("Waiting for child to terminate");
-        WaitForSingleObject(this->handles.child_handle, INFINITE);
-        CloseHandle(this->handles.child_stdout);
-        CloseHandle(this->handles.child_stdin);
-        CloseHandle(this->handles.child_handle);
-    }
-#else
-    if( this->handles.child_pid != 0 )
+    if( m_server )
     {
-        DEBUG("Waiting for child " << this->handles.child_pid << " to terminate");
-        int status;
-        waitpid(this->handles.child_pid, &status, 0);
-        close(this->handles.child_stdout);
-        close(this->handles.child_stdin);
+        if( m_server_reusable )
+        {
+            idle_proc_macro_servers()[m_server->m_executable].push_back( ::std::move(m_server) );
+        }
+        else
+        {
+            // Request was abandoned part-way, the pipes could contain anything - so shut this child down
+            DEBUG("Stopping proc macro server for `" << m_server->m_executable << "`");
+            m_server.reset();
+        }
     }
-#endif
 }
 bool ProcMacroInv::check_good()
 {
     char    v;
 #ifdef _WIN32
     DWORD rv = 0;
-    if( !ReadFile(this->handles.child_stdout, &v, 1, &rv, nullptr) )
+    if( !ReadFile(m_server->handles.child_stdout, &v, 1, &rv, nullptr) )
     {
         DEBUG("Error reading from child, " << GetLastError());
         return false;
     }
 #else
-    int rv = read(this->handles.child_stdout, &v, 1);
+    int rv = read(m_server->handles.child_stdout, &v, 1);
 #endif
     if( rv == 0 )
     {
@@ -1862,9 +1882,13 @@ bool ProcMacroInv::check_good()
         return false;
     }
 #endif
-    DEBUG("Child started, value = " << (int)v);
+    DEBUG("Child ready, value = " << (int)v);
     if( v != 0 )
+    {
+        // The child rejected the request (unknown macro name), but is still waiting for the next one
+        m_server_reusable = true;
         return false;
+    }
     return true;
 }
 void ProcMacroInv::send_u8(uint8_t v)
@@ -1882,10 +1906,10 @@ void ProcMacroInv::send_bytes_raw(const void* val, size_t size)
         m_dump_file_out.write( reinterpret_cast<const char*>(val), size);
 #ifdef _WIN32
     DWORD bytesWritten = 0;
-    if( !WriteFile(this->handles.child_stdin, val, size, &bytesWritten, nullptr) || bytesWritten != size )
+    if( !WriteFile(m_server->handles.child_stdin, val, size, &bytesWritten, nullptr) || bytesWritten != size )
         BUG(m_parent_span, "Error writing to child, " << GetLastError());
 #else
-    if( write(this->handles.child_stdin, val, size) != static_cast<ssize_t>(size) )
+    if( write(m_server->handles.child_stdin, val, size) != static_cast<ssize_t>(size) )
         BUG(m_parent_span, "Error writing to child, " << strerror(errno));
 #endif
 }
@@ -1930,9 +1954,9 @@ void ProcMacroInv::recv_bytes_raw(void* out_void, size_t len)
     {
 #ifdef _WIN32
         DWORD n;
-        ReadFile(this->handles.child_stdout, &val[ofs], rem, &n, nullptr);
+        ReadFile(m_server->handles.child_stdout, &val[ofs], rem, &n, nullptr);
 #else
-        auto n = read(this->handles.child_stdout, &val[ofs], rem);
+        auto n = read(m_server->handles.child_stdout, &val[ofs], rem);
 #endif
         if( n == 0 ) {
             BUG(this->m_this_span, "Unexpected EOF while reading from child process");
@@ -2007,6 +2031,7 @@ Token ProcMacroInv::realGetToken_() {
         auto val = this->recv_bytes();
         if( val == "" ) {
             m_eof_hit = true;
+            m_server_reusable = true;
             return Token(TOK_EOF);
         }
         auto t = Lex_FindOperator(val);
@@ -22,3 +22,5 @@ extern ::std::unique_ptr<TokenStream> ProcMacro_Invoke(
 // Function-like macros
 extern ::std::unique_ptr<TokenStream> ProcMacro_Invoke(const Span& sp, const ::AST::Crate& crate, const ::std::vector<RcString>& mac_path, const TokenTree& tt);
 
+/// Shut down any proc macro child processes kept running between invocations (call once expansion is complete)
+extern void ProcMacro_StopServers();
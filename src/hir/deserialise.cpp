@@ -35,6 +35,24 @@ namespace {
     {
     };
 
+    /// MIR body stored in its own block of the metadata, deserialised when first used
+    class LazyMirBlock:
+        public ::MIR::LazyFunction
+    {
+        ::std::shared_ptr<const ::std::vector<RcString>>    m_strings;
+        ::std::shared_ptr<::HIR::serialise::BlockIndex> m_blocks;
+        RcString    m_crate_name;
+        size_t  m_index;
+    public:
+        LazyMirBlock(const ::HIR::serialise::Reader& in, RcString crate_name, size_t index):
+            m_strings(in.strings()),
+            m_blocks(in.blocks()),
+            m_crate_name(::std::move(crate_name)),
+            m_index(index)
+        {}
+        ::MIR::FunctionPointer load() override;
+    };
+
     class HirDeserialiser
     {
         RcString m_crate_name;
@@ -44,6 +62,10 @@ namespace {
         HirDeserialiser(::HIR::serialise::Reader& in):
             m_in(in)
         {}
+        HirDeserialiser(::HIR::serialise::Reader& in, RcString crate_name):
+            m_crate_name(::std::move(crate_name)),
+            m_in(in)
+        {}
 
         RcString read_istring() { return m_in.read_istring(); }
         ::std::string read_string() { return m_in.read_string(); }
@@ -463,6 +485,7 @@ namespace {
             rv.m_param_names = deserialise_vec<RcString>();
             rv.m_pattern = deserialise_vec_c< ::SimplePatEnt>( [&](){ return deserialise_simplepatent(); } );
             rv.m_contents = deserialise_vec_c< ::MacroExpansionEnt>( [&](){ return deserialise_macroexpansionent(); } );
+            rv.update_literal_prefix();
             return rv;
         }
         ::MacroExpansionEnt deserialise_macroexpansionent() {
@@ -529,7 +552,8 @@ namespace {
             auto _ = m_in.open_object("HIR::ExprPtr");
             if( m_in.read_bool() )
             {
-                rv.m_mir = deserialise_mir();
+                auto idx = m_in.read_count();
+                rv.m_mir = ::MIR::FunctionPointer::new_lazy( new LazyMirBlock(m_in, m_crate_name, idx) );
             }
             rv.m_erased_types = deserialise_vec< ::HIR::TypeRef>();
             return rv;
@@ -805,6 +829,8 @@ namespace {
             ::HIR::Function::Markings rv;
             rv.rustc_legacy_const_generics = deserialise_vec<unsigned>();
             rv.track_caller = m_in.read_bool();
+            rv.inline_type = static_cast<::HIR::Function::Markings::Inline>(m_in.read_tag());
+            rv.is_cold = m_in.read_bool();
             return rv;
         }
         ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >   deserialise_fcnargs()
@@ -1029,7 +1055,11 @@ namespace {
     DEF_D( ::HIR::Crate::ImplGroup<std::unique_ptr<T>>,
         ::HIR::Crate::ImplGroup<std::unique_ptr<T>>  rv;
         rv.named = d.deserialise_pathmap< ::std::vector<::std::unique_ptr<T> > >();
-        rv.non_named = d.deserialise_vec< ::std::unique_ptr<T> >();
+        for(auto& impl : d.deserialise_vec< ::std::unique_ptr<T> >())
+        {
+            auto& list = rv.get_list_for_type_mut(impl->m_type);
+            list.push_back(mv$(impl));
+        }
         rv.generic = d.deserialise_vec< ::std::unique_ptr<T> >();
         return rv;
         )
@@ -1455,6 +1485,21 @@ namespace {
 
         return ::MIR::FunctionPointer( new ::MIR::Function(mv$(rv)) );
     }
+    ::MIR::FunctionPointer LazyMirBlock::load()
+    {
+        TRACE_FUNCTION_F(m_crate_name << " #" << m_index);
+        try
+        {
+            ::HIR::serialise::Reader    in { m_strings, m_blocks, m_blocks->read_block(m_index) };
+            HirDeserialiser s { in, m_crate_name };
+            return s.deserialise_mir();
+        }
+        catch(const ::std::runtime_error& e)
+        {
+            ::std::cerr << "Unable to load MIR #" << m_index << " from metadata for " << m_crate_name << ": " << e.what() << ::std::endl;
+            ::std::abort();
+        }
+    }
     ::MIR::BasicBlock HirDeserialiser::deserialise_mir_basicblock()
     {
         TRACE_FUNCTION;
@@ -1699,6 +1744,24 @@ namespace {
         //rv.m_proc_macro_reexports = deserialise_istrumap< ::HIR::Crate::MacroImport>();
         rv.m_lang_items = deserialise_strumap< ::HIR::SimplePath>();
 
+        {
+            size_t n = m_in.read_count();
+            for(size_t i = 0; i < n; i ++)
+                rv.m_shared_instances.insert( deserialise_path() );
+        }
+
+        {
+            size_t n = m_in.read_count();
+            rv.m_type_layouts.reserve(n);
+            for(size_t i = 0; i < n; i ++)
+            {
+                auto ty = deserialise_type();
+                auto size = m_in.read_u64c();
+                auto align = m_in.read_u64c();
+                rv.m_type_layouts.push_back(::HIR::Crate::TypeLayout { mv$(ty), size, align });
+            }
+        }
+
         {
             size_t n = m_in.read_count();
             for(size_t i = 0; i < n; i ++)
@@ -1716,6 +1716,9 @@ namespace {
             "#[rustc_legacy_const_generics(" << idx << ")] out of range (0.." << args.size() + f.m_markings.rustc_legacy_const_generics.size() << ")");
         markings.rustc_legacy_const_generics.push_back( idx );
     }
+    // #[cold] - Only used as an optimisation hint by the backend
+    markings.is_cold = f.m_markings.is_cold;
+
     // #[track_caller] - Provides caller information
     // NOTE: This can only be (cleanly) handled in the backend [where it sees fully monomorphised paths]
     if( attrs.get("track_caller") )
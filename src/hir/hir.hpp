@@ -15,6 +15,7 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <set>
 
 #include <tagged_union.hpp>
 
@@ -215,6 +216,8 @@ public:
             Normal, // #[inline]
             Always  // #[inline(always)]
         } inline_type = Inline::Auto;
+        /// `#[cold]` - Rarely called, callers treat paths leading to it as unlikely
+        bool is_cold = false;
     } m_markings;
 
     Function()
@@ -658,36 +661,63 @@ public:
     {
         typedef ::std::vector<T> list_t;
         ::std::map<::HIR::SimplePath, list_t>   named;
-        list_t  non_named; // TODO: use a map of HIR::TypeRef::Data::Tag
+        /// Impls on non-path types, bucketed by `TypeRef::get_impl_key_range` (e.g. `u8`, `&mut _`, 2-tuples)
+        ::std::map<unsigned, list_t>    non_named;
         list_t  generic;
 
+        /// Get the list that holds impls for exactly `ty` (if there is one)
         const list_t* get_list_for_type(const ::HIR::TypeRef& ty) const {
-            static list_t empty;
             if( const auto* p = ty.get_sort_path() ) {
                 auto it = named.find(*p);
-                if( it != named.end() )
-                    return &it->second;
-                else
-                    return nullptr;
-            }
-            else {
-                // TODO: Sort these by type tag, use the `Primitive` group if `ty` is Infer
-                return &non_named;
+                return it != named.end() ? &it->second : nullptr;
             }
+            auto keys = ty.get_impl_key_range();
+            if( keys.first != keys.second )
+                return &generic;
+            auto it = non_named.find(keys.first);
+            return it != non_named.end() ? &it->second : nullptr;
         }
         list_t& get_list_for_type_mut(const ::HIR::TypeRef& ty) {
             if( const auto* p = ty.get_sort_path() ) {
                 return named[*p];
             }
+            auto keys = ty.get_impl_key_range();
+            if( keys.first != keys.second )
+                return generic;
+            return non_named[keys.first];
+        }
+
+        /// Call `cb` on each list that could contain impls matching `ty`, stopping once it returns true
+        /// - `search_all_named` searches all named lists for non-literal ivars (non-path types get all `non_named` buckets)
+        template<typename Cb>
+        bool find_lists_for_type(const ::HIR::TypeRef& ty, bool search_all_named, Cb cb) const {
+            if( const auto* p = ty.get_sort_path() ) {
+                auto it = named.find(*p);
+                if( it != named.end() && cb(it->second) )
+                    return true;
+            }
             else {
-                // TODO: Ivars match with core types
-                return non_named;
+                auto keys = ty.get_impl_key_range();
+                for(auto it = non_named.lower_bound(keys.first); it != non_named.end() && it->first <= keys.second; ++it)
+                {
+                    if( cb(it->second) )
+                        return true;
+                }
+                if( search_all_named && ty.data().is_Infer() && !ty.data().as_Infer().is_lit() )
+                {
+                    for(const auto& list : named)
+                    {
+                        if( cb(list.second) )
+                            return true;
+                    }
+                }
             }
+            return cb(generic);
         }
     };
     /// Impl blocks on just a type, split into three groups
     // - Named type (sorted on the path)
-    // - Primitive types
+    // - Primitive/structural types (sorted on the simplified type)
     // - Unsorted (generics, and everything before outer type resolution)
     ImplGroup<::std::unique_ptr<::HIR::TypeImpl>>  m_type_impls;
 
@@ -705,6 +735,8 @@ public:
     ImplGroup<const ::HIR::TypeImpl*>   m_all_type_impls;
     ::std::map< ::HIR::SimplePath, ImplGroup<const ::HIR::TraitImpl*> > m_all_trait_impls;
     ::std::map< ::HIR::SimplePath, ImplGroup<const ::HIR::MarkerImpl*> > m_all_marker_impls;
+    /// Incremented whenever impls are added after indexing (closure and auto-generated impls), used to invalidate impl selection caches
+    unsigned    m_impl_generation = 0;
 
     /// List of legacy-exported macros
     std::vector<RcString> m_exported_macro_names;
@@ -712,6 +744,19 @@ public:
     /// Language items avaliable through this crate (includes ones from loaded externs)
     ::std::unordered_map< ::std::string, ::HIR::SimplePath> m_lang_items;
 
+    /// Monomorphised generic function instances emitted (with public linkage) by this crate's codegen
+    /// - Downstream crates reference these instead of emitting their own copy
+    ::std::set< ::HIR::Path>    m_shared_instances;
+
+    /// Size and alignment of one of this crate's types (as calculated during trans)
+    struct TypeLayout {
+        ::HIR::TypeRef  ty;
+        size_t  size;
+        size_t  align;
+    };
+    /// Layouts of this crate's (monomorphic) types, used to seed the layout cache of downstream crates
+    ::std::vector<TypeLayout>   m_type_layouts;
+
     /// Referenced crates (in load order) - Used to ensure final linking order is sane
     // NOT SERIALISED
     ::std::vector<RcString> m_ext_crates_ordered;
@@ -15,6 +15,7 @@
 #include <hir_expand/main_bindings.hpp>
 #include <mir/main_bindings.hpp>
 #include <trans/target.hpp>
+#include <parallel.hpp>   // lazy_state_lock
 
 namespace {
     bool is_unbounded_infer(const ::HIR::TypeRef& type) {
@@ -883,11 +884,74 @@ bool ::HIR::TraitImpl::overlaps_with(const Crate& crate, const ::HIR::TraitImpl&
 
 namespace
 {
+    bool is_bound_path(const ::HIR::TypeData& d)
+    {
+        const auto& e = d.as_Path();
+        return e.path.m_data.is_Generic() && !e.binding.is_Unbound() && !e.binding.is_Opaque();
+    }
+    /// Cheap structural pre-check of an impl's type against a queried type, returns false only if `matches_type` would fail
+    /// - Only looks at the heads of the types (without resolving ivars/generics in `ty`), recursing through structural types
+    bool impl_type_may_match(const ::HIR::TypeRef& impl_ty, const ::HIR::TypeRef& ty, unsigned depth=0)
+    {
+        // Limit the recursion, this is meant to be cheaper than the full match
+        if( depth > 4 )
+            return true;
+        // Anything unknown or loosely matched could match
+        const auto& l = impl_ty.data();
+        const auto& r = ty.data();
+        if( l.is_Generic() || r.is_Generic() || r.is_Infer() || l.is_ErasedType() || r.is_ErasedType() )
+            return true;
+        // - Paths are fuzzy unless they're both bound generic paths
+        if( (l.is_Path() && !is_bound_path(l)) || (r.is_Path() && !is_bound_path(r)) )
+            return true;
+        if( l.tag() != r.tag() )
+            return false;
+        TU_MATCH_HDRA( (l, r), {)
+        default:
+            return true;
+        TU_ARMA(Primitive, le, re)
+            return le == re;
+        TU_ARMA(Path, le, re) {
+            const auto& lp = le.path.m_data.as_Generic();
+            const auto& rp = re.path.m_data.as_Generic();
+            if( lp.m_path != rp.m_path )
+                return false;
+            if( lp.m_params.m_types.size() != rp.m_params.m_types.size() )
+                return true;
+            for(size_t i = 0; i < lp.m_params.m_types.size(); i ++)
+                if( !impl_type_may_match(lp.m_params.m_types[i], rp.m_params.m_types[i], depth+1) )
+                    return false;
+            return true;
+            }
+        TU_ARMA(TraitObject, le, re)
+            return le.m_trait.m_path.m_path == re.m_trait.m_path.m_path;
+        TU_ARMA(Array, le, re)
+            return impl_type_may_match(le.inner, re.inner, depth+1);
+        TU_ARMA(Slice, le, re)
+            return impl_type_may_match(le.inner, re.inner, depth+1);
+        TU_ARMA(Tuple, le, re) {
+            if( le.size() != re.size() )
+                return false;
+            for(size_t i = 0; i < le.size(); i ++)
+                if( !impl_type_may_match(le[i], re[i], depth+1) )
+                    return false;
+            return true;
+            }
+        TU_ARMA(Borrow, le, re)
+            return le.type == re.type && impl_type_may_match(le.inner, re.inner, depth+1);
+        TU_ARMA(Pointer, le, re)
+            return le.type == re.type && impl_type_may_match(le.inner, re.inner, depth+1);
+        }
+        throw "";
+    }
+
     template<typename ImplType>
     bool find_impls_list(const typename ::HIR::Crate::ImplGroup<::std::unique_ptr<ImplType>>::list_t& impl_list, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, ::std::function<bool(const ImplType&)> callback)
     {
         for(const auto& impl : impl_list)
         {
+            if( !impl_type_may_match(impl->m_type, type) )
+                continue ;
             if( impl->matches_type(type, ty_res) )
             {
                 if( callback(*impl) )
@@ -903,6 +967,8 @@ namespace
     {
         for(const auto& impl : impl_list)
         {
+            if( !impl_type_may_match(impl->m_type, type) )
+                continue ;
             if( impl->matches_type(type, ty_res) )
             {
                 if( callback(*impl) )
@@ -913,6 +979,14 @@ namespace
         }
         return false;
     }
+    /// Search all lists in an impl group that could contain impls for `type`
+    template<typename ImplPtr, typename ImplType>
+    bool find_impls_group(const ::HIR::Crate::ImplGroup<ImplPtr>& group, bool search_all_named, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, const ::std::function<bool(const ImplType&)>& callback)
+    {
+        return group.find_lists_for_type(type, search_all_named, [&](const typename ::HIR::Crate::ImplGroup<ImplPtr>::list_t& list) {
+            return find_impls_list<ImplType>(list, type, ty_res, callback);
+            });
+    }
 }
 namespace
 {
@@ -924,25 +998,8 @@ namespace
         auto it = crate.m_trait_impls.find( trait );
         if( it != crate.m_trait_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
-            // - If the type is an ivar, search all types
-            if( type.data().is_Infer() && !type.data().as_Infer().is_lit() )
-            {
-                DEBUG("Search all lists");
-                for(const auto& list : it->second.named)
-                {
-                    if( find_impls_list(list.second, type, ty_res, callback) )
-                        return true;
-                }
-            }
-
-            // 2. Search fully generic list.
-            if( find_impls_list(it->second.generic, type, ty_res, callback) )
+            // Search the list for the type's path (or simplified type, or all lists if it's an ivar), then the generic list
+            if( find_impls_group(it->second, /*search_all_named=*/true, type, ty_res, callback) )
                 return true;
         }
 
@@ -1013,25 +1070,8 @@ bool ::HIR::Crate::find_trait_impls(const ::HIR::SimplePath& trait, const ::HIR:
         auto it = this->m_all_trait_impls.find( trait );
         if( it != this->m_all_trait_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
-            // - If the type is an ivar, search all types
-            if( type.data().is_Infer() && !type.data().as_Infer().is_lit() )
-            {
-                DEBUG("Search all lists");
-                for(const auto& list : it->second.named)
-                {
-                    if( find_impls_list(list.second, type, ty_res, callback) )
-                        return true;
-                }
-            }
-
-            // 2. Search fully generic list.
-            if( find_impls_list(it->second.generic, type, ty_res, callback) )
+            // Search the list for the type's path (or simplified type, or all lists if it's an ivar), then the generic list
+            if( find_impls_group(it->second, /*search_all_named=*/true, type, ty_res, callback) )
                 return true;
         }
 
@@ -1062,15 +1102,7 @@ namespace
         auto it = crate.m_marker_impls.find( trait );
         if( it != crate.m_marker_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
-
-            // 2. Search fully generic list.
-            if( find_impls_list(it->second.generic, type, ty_res, callback) )
+            if( find_impls_group(it->second, /*search_all_named=*/false, type, ty_res, callback) )
                 return true;
         }
 
@@ -1083,15 +1115,7 @@ bool ::HIR::Crate::find_auto_trait_impls(const ::HIR::SimplePath& trait, const :
         auto it = this->m_all_marker_impls.find( trait );
         if( it != this->m_all_marker_impls.end() )
         {
-            // 1. Find named impls (associated with named types)
-            if( const auto* impl_list = it->second.get_list_for_type(type) )
-            {
-                if( find_impls_list(*impl_list, type, ty_res, callback) )
-                    return true;
-            }
-
-            // 2. Search fully generic list.
-            if( find_impls_list(it->second.generic, type, ty_res, callback) )
+            if( find_impls_group(it->second, /*search_all_named=*/false, type, ty_res, callback) )
                 return true;
         }
 
@@ -1115,35 +1139,13 @@ namespace
 {
     bool find_type_impls_int(const ::HIR::Crate& crate, const ::HIR::TypeRef& type, ::HIR::t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback)
     {
-        // 1. Find named impls (associated with named types)
-        if( const auto* impl_list = crate.m_type_impls.get_list_for_type(type) )
-        {
-            if( find_impls_list(*impl_list, type, ty_res, callback) )
-                return true;
-        }
-
-        // 2. Search fully generic list?
-        if( find_impls_list(crate.m_type_impls.generic, type, ty_res, callback) )
-            return true;
-
-        return false;
+        return find_impls_group(crate.m_type_impls, /*search_all_named=*/false, type, ty_res, callback);
     }
 }
 bool ::HIR::Crate::find_type_impls(const ::HIR::TypeRef& type, t_cb_resolve_type ty_res, ::std::function<bool(const ::HIR::TypeImpl&)> callback) const
 {
     if( m_all_trait_impls.size() > 0 ) {
-        // 1. Find named impls (associated with named types)
-        if( const auto* impl_list = this->m_all_type_impls.get_list_for_type(type) )
-        {
-            if( find_impls_list(*impl_list, type, ty_res, callback) )
-                return true;
-        }
-
-        // 2. Search fully generic list?
-        if( find_impls_list(this->m_all_type_impls.generic, type, ty_res, callback) )
-            return true;
-
-        return false;
+        return find_impls_group(this->m_all_type_impls, /*search_all_named=*/false, type, ty_res, callback);
     }
     // TODO: Determine the source crate for this type (coherence) and only search that
 
@@ -1173,6 +1175,7 @@ const ::MIR::Function* HIR::Crate::get_or_gen_mir(const ::HIR::ItemPath& ip, con
     }
     else
     {
+        ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
         if( !ep.m_mir )
         {
             TRACE_FUNCTION_F(ip);
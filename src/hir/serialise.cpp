@@ -415,7 +415,17 @@
         void serialise(const ::HIR::Crate::ImplGroup<T>& ig)
         {
             serialise_pathmap(ig.named);
-            serialise_vec(ig.non_named);
+            // Written as a flat list, the buckets are re-created on load
+            {
+                size_t n = 0;
+                for(const auto& list : ig.non_named)
+                    n += list.second.size();
+                auto _ = m_out.open_object(typeid(::std::vector<T>).name());
+                m_out.write_count(n);
+                for(const auto& list : ig.non_named)
+                    for(const auto& i : list.second)
+                        serialise(i);
+            }
             serialise_vec(ig.generic);
         }
 
@@ -443,6 +453,21 @@
                 serialise_strmap(lang_items_filtered);
             }
 
+            m_out.write_count(crate.m_shared_instances.size());
+            for(const auto& p : crate.m_shared_instances)
+                serialise_path(p);
+
+            // Layouts are a cache derived from the (already hashed) type definitions, so aren't part of the interface
+            m_out.set_interface_hash_enabled(false);
+            m_out.write_count(crate.m_type_layouts.size());
+            for(const auto& l : crate.m_type_layouts)
+            {
+                serialise_type(l.ty);
+                m_out.write_u64c(l.size);
+                m_out.write_u64c(l.align);
+            }
+            m_out.set_interface_hash_enabled(true);
+
             m_out.write_count(crate.m_ext_crates.size());
             for(const auto& ext : crate.m_ext_crates)
             {
@@ -451,7 +476,10 @@
                 //m_out.write_string(ext.second.m_path);
             }
             serialise_vec(crate.m_ext_libs);
+            // Link paths depend on where the crate was built, so aren't part of the interface
+            m_out.set_interface_hash_enabled(false);
             serialise_vec(crate.m_link_paths);
+            m_out.set_interface_hash_enabled(true);
         }
         void serialise(const ::HIR::ExternLibrary& lib)
         {
@@ -733,7 +761,13 @@
             save_mir &= static_cast<bool>(exp.m_mir);
             m_out.write_bool( save_mir );
             if( save_mir ) {
+                // MIR is stored in its own block (so it can be loaded on first use), with a fresh type cache
+                auto saved_types = ::std::move(m_types);
+                m_types.clear();
+                m_out.open_block();
                 serialise(*exp.m_mir);
+                m_out.write_count( m_out.close_block() );
+                m_types = ::std::move(saved_types);
             }
             serialise_vec( exp.m_erased_types );
         }
@@ -1190,6 +1224,8 @@
             auto _ = m_out.open_object("HIR::Function::Markings");
             serialise_vec(m.rustc_legacy_const_generics);
             m_out.write_bool(m.track_caller);
+            m_out.write_tag(static_cast<int>(m.inline_type));
+            m_out.write_bool(m.is_cold);
         }
         void serialise(const ::HIR::Constant& item)
         {
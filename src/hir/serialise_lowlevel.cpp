@@ -29,14 +29,22 @@ public:
     WriterInner(const ::std::string& filename);
     ~WriterInner();
     void write(const void* buf, size_t len);
+    /// Complete the compressed stream, and append the blocks and their index
+    void finish(const ::std::vector< ::std::pair<::std::vector<uint8_t>, size_t> >& blocks, uint64_t interface_hash);
 };
 
 Writer::Writer():
-    m_inner(nullptr)
+    m_inner(nullptr),
+    m_interface_hash(0xcbf29ce484222325),
+    m_interface_hash_enabled(true)
 {
 }
 Writer::~Writer()
 {
+    if( m_inner ) {
+        assert(m_open_blocks.empty());
+        m_inner->finish(m_blocks, m_interface_hash);
+    }
     delete m_inner, m_inner = nullptr;
 }
 void Writer::open(const ::std::string& filename)
@@ -70,12 +78,48 @@ void Writer::write(const void* buf, size_t len)
 {
     if( m_inner ) {
         DEBUG("write(" << FMT_CB(ss, for(size_t i = 0; i < len; i ++) ss << std::setw(2) << std::setfill('0') << std::hex << unsigned( ((const uint8_t*)buf)[i] )) << ")");
-        m_inner->write(buf, len);
+        for(size_t i = 0; m_interface_hash_enabled && i < len; i ++)
+        {
+            m_interface_hash ^= reinterpret_cast<const uint8_t*>(buf)[i];
+            m_interface_hash *= 0x100000001b3;
+        }
+        if( !m_open_blocks.empty() ) {
+            auto& d = m_open_blocks.back().data;
+            d.insert(d.end(), reinterpret_cast<const uint8_t*>(buf), reinterpret_cast<const uint8_t*>(buf) + len);
+        }
+        else {
+            m_inner->write(buf, len);
+        }
     }
     else {
         // No-op, pre caching
     }
 }
+void Writer::open_block()
+{
+    m_open_blocks.push_back(OpenBlock());
+    // Object names are cached per-stream, so start the block with an empty cache
+    ::std::swap(m_open_blocks.back().saved_objname_cache, m_objname_cache);
+}
+size_t Writer::close_block()
+{
+    assert(!m_open_blocks.empty());
+    auto b = ::std::move(m_open_blocks.back());
+    m_open_blocks.pop_back();
+    m_objname_cache = ::std::move(b.saved_objname_cache);
+    if( !m_inner ) {
+        // Pre caching, the index isn't written.
+        return 0;
+    }
+
+    ::std::vector<uint8_t>  compressed( compressBound(b.data.size()) );
+    uLongf  len = compressed.size();
+    if( compress2(compressed.data(), &len, b.data.data(), b.data.size(), Z_BEST_COMPRESSION) != Z_OK )
+        throw ::std::runtime_error("zlib compress failure");
+    compressed.resize(len);
+    m_blocks.push_back(::std::make_pair( ::std::move(compressed), b.data.size() ));
+    return m_blocks.size() - 1;
+}
 void Writer::write_string(const RcString& v)
 {
     if( m_inner ) {
@@ -108,6 +152,10 @@ WriterInner::WriterInner(const ::std::string& filename):
     m_zstream.next_out = m_buffer.data();
 }
 WriterInner::~WriterInner()
+{
+    deflateEnd(&m_zstream);
+}
+void WriterInner::finish(const ::std::vector< ::std::pair<::std::vector<uint8_t>, size_t> >& blocks, uint64_t interface_hash)
 {
     assert( m_zstream.avail_in == 0 );
 
@@ -130,7 +178,29 @@ WriterInner::~WriterInner()
             m_zstream.next_out = m_buffer.data();
         }
     } while(ret == Z_OK);
-    deflateEnd(&m_zstream);
+
+    // Append the blocks, followed by the index
+    auto write_u64 = [&](uint64_t v) {
+        uint8_t buf[8];
+        for(int i = 0; i < 8; i ++)
+            buf[i] = static_cast<uint8_t>(v >> (8*i));
+        m_backing.write( reinterpret_cast<char*>(buf), sizeof(buf) );
+        };
+    ::std::vector<uint64_t> offsets;
+    offsets.reserve(blocks.size());
+    for(const auto& b : blocks)
+    {
+        offsets.push_back( m_backing.tellp() );
+        m_backing.write( reinterpret_cast<const char*>(b.first.data()), b.first.size() );
+    }
+    for(size_t i = 0; i < blocks.size(); i ++)
+    {
+        write_u64(offsets[i]);
+        write_u64(blocks[i].second);
+    }
+    write_u64(interface_hash);
+    write_u64(blocks.size());
+    write_u64(BLOCK_INDEX_MAGIC);
 }
 
 void WriterInner::write(const void* buf, size_t len)
@@ -205,6 +275,11 @@ ReadBuffer::ReadBuffer(size_t cap):
 {
     m_backing.reserve(cap);
 }
+ReadBuffer::ReadBuffer(::std::vector<uint8_t> data):
+    m_backing(::std::move(data)),
+    m_ofs(0)
+{
+}
 size_t ReadBuffer::read(void* dst, size_t len)
 {
     size_t rem = m_backing.size() - m_ofs;
@@ -233,16 +308,27 @@ void ReadBuffer::populate(ReaderInner& is)
 Reader::Reader(const ::std::string& filename):
     m_inner( new ReaderInner(filename) ),
     m_buffer(1024),
-    m_pos(0)
+    m_pos(0),
+    m_blocks( ::std::make_shared<BlockIndex>(filename) )
 {
     size_t n_strings = read_count();
-    m_strings.reserve(n_strings);
+    auto strings = ::std::make_shared<::std::vector<RcString>>();
+    strings->reserve(n_strings);
     DEBUG("n_strings = " << n_strings);
     for(size_t i = 0; i < n_strings; i ++)
     {
         auto s = read_string();
-        m_strings.push_back( RcString::new_interned(s) );
+        strings->push_back( RcString::new_interned(s) );
     }
+    m_strings = ::std::move(strings);
+}
+Reader::Reader(::std::shared_ptr<const ::std::vector<RcString>> strings, ::std::shared_ptr<BlockIndex> blocks, ::std::vector<uint8_t> data):
+    m_inner(nullptr),
+    m_buffer(::std::move(data)),
+    m_pos(0),
+    m_strings(::std::move(strings)),
+    m_blocks(::std::move(blocks))
+{
 }
 Reader::~Reader()
 {
@@ -259,7 +345,11 @@ void Reader::read(void* buf, size_t len)
     buf = reinterpret_cast<uint8_t*>(buf) + used;
     len -= used;
 
-    if( len >= m_buffer.capacity() )
+    if( !m_inner )
+    {
+        throw ::std::runtime_error( FMT("Reader::read - Unexpected end of block at " << m_pos + used << ", " << len << " bytes short") );
+    }
+    else if( len >= m_buffer.capacity() )
     {
         m_inner->read(buf, len);
     }
@@ -320,6 +410,11 @@ size_t ReaderInner::read(void* buf, size_t len)
         int ret = inflate(&m_zstream, Z_NO_FLUSH);
         if(ret == Z_STREAM_ERROR)
             throw ::std::runtime_error("zlib inflate stream error");
+        // The main stream is followed by the blocks, so stop at the end of the stream (instead of EOF)
+        if(ret == Z_STREAM_END) {
+            m_byte_out_count += len - m_zstream.avail_out;
+            return len - m_zstream.avail_out;
+        }
         switch(ret)
         {
         case Z_NEED_DICT:
@@ -337,5 +432,72 @@ size_t ReaderInner::read(void* buf, size_t len)
     return len;
 }
 
+// --------------------------------------------------------------------
+namespace {
+    uint64_t read_u64_at(::std::ifstream& is, ::std::streamoff ofs)
+    {
+        uint8_t buf[8];
+        is.seekg(ofs);
+        is.read(reinterpret_cast<char*>(buf), sizeof(buf));
+        if( is.gcount() != sizeof(buf) )
+            throw ::std::runtime_error("Truncated block index");
+        uint64_t rv = 0;
+        for(int i = 0; i < 8; i ++)
+            rv |= static_cast<uint64_t>(buf[i]) << (8*i);
+        return rv;
+    }
+}
+
+BlockIndex::BlockIndex(const ::std::string& path):
+    m_path(path),
+    m_file(path, ::std::ios_base::in|::std::ios_base::binary)
+{
+    if( !m_file.is_open() )
+        throw ::std::runtime_error("Unable to open file");
+    m_file.seekg(0, ::std::ios_base::end);
+    ::std::streamoff    file_len = m_file.tellg();
+    if( file_len < static_cast<::std::streamoff>(BLOCK_INDEX_TRAILER_SIZE) || read_u64_at(m_file, file_len - 8) != BLOCK_INDEX_MAGIC )
+        throw ::std::runtime_error("No block index, metadata is from an older version of mrustc (rebuild the crate)");
+    uint64_t count = read_u64_at(m_file, file_len - 16);
+    if( count > static_cast<uint64_t>(file_len) / 16 )
+        throw ::std::runtime_error("Corrupted block index");
+    ::std::streamoff    index_ofs = file_len - BLOCK_INDEX_TRAILER_SIZE - count * 16;
+
+    m_entries.reserve(count);
+    for(uint64_t i = 0; i < count; i ++)
+    {
+        auto ofs = read_u64_at(m_file, index_ofs + i * 16);
+        auto raw_size = read_u64_at(m_file, index_ofs + i * 16 + 8);
+        m_entries.push_back(::std::make_pair( ofs, raw_size ));
+    }
+}
+::std::vector<uint8_t> BlockIndex::read_block(size_t idx)
+{
+    if( idx >= m_entries.size() )
+        throw ::std::runtime_error( FMT("Block index " << idx << " out of range in " << m_path) );
+    uint64_t ofs = m_entries[idx].first;
+    uint64_t end = (idx + 1 < m_entries.size() ? m_entries[idx+1].first : ofs);
+    if( idx + 1 == m_entries.size() )
+    {
+        // The last block ends at the start of the index
+        m_file.clear();
+        m_file.seekg(0, ::std::ios_base::end);
+        end = static_cast<uint64_t>(m_file.tellg()) - BLOCK_INDEX_TRAILER_SIZE - m_entries.size() * 16;
+    }
+
+    ::std::vector<uint8_t>  compressed( end - ofs );
+    m_file.clear();
+    m_file.seekg(ofs);
+    m_file.read( reinterpret_cast<char*>(compressed.data()), compressed.size() );
+    if( static_cast<size_t>(m_file.gcount()) != compressed.size() )
+        throw ::std::runtime_error( FMT("Truncated block " << idx << " in " << m_path) );
+
+    ::std::vector<uint8_t>  rv( m_entries[idx].second );
+    uLongf  len = rv.size();
+    if( uncompress(rv.data(), &len, compressed.data(), compressed.size()) != Z_OK || len != rv.size() )
+        throw ::std::runtime_error( FMT("Corrupted block " << idx << " in " << m_path) );
+    return rv;
+}
+
 }   // namespace serialise
 }   // namespace HIR
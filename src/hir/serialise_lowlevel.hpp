@@ -17,11 +17,22 @@
 // 0xFD indicates start of a named object (string index follows)
 // 0xFE indicates start of an unnamed object
 // 0xFF indicates end of an object
+//
+// File layout:
+// - The main zlib stream (string table, then the crate)
+// - Zero or more separately compressed blocks (see `Writer::open_block`), each a self-contained stream
+//   sharing only the string table with the main stream.
+// - Block index: `{ u64 offset, u64 raw_size }` per block, then `u64 interface_hash`, `u64 count` and `u64 BLOCK_INDEX_MAGIC`
+//
+// The interface hash is a hash of all of the uncompressed data (i.e. everything a downstream crate can see), and is
+// at a fixed offset from the end of the file so build tools can check it without decoding the metadata.
 
 #include <int128.h>
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <fstream>
 #include <stddef.h>
 #include <assert.h>
 #include <rc_string.hpp>
@@ -32,11 +43,28 @@ namespace serialise {
 class WriterInner;
 class ReaderInner;
 
+/// Marks the end of a metadata file that has a block index
+static const uint64_t BLOCK_INDEX_MAGIC = 0x3258444948524d00;   // "\0MRHIDX2"
+/// Size of the fixed part of the trailer (interface hash, block count, and magic)
+static const size_t BLOCK_INDEX_TRAILER_SIZE = 3*8;
+
 class Writer
 {
     WriterInner*    m_inner;
     ::std::map<RcString, unsigned>  m_istring_cache;
     ::std::map<const char*, unsigned>  m_objname_cache;
+
+    struct OpenBlock {
+        ::std::vector<uint8_t>  data;
+        ::std::map<const char*, unsigned>  saved_objname_cache;
+    };
+    /// Blocks currently being written (innermost last)
+    ::std::vector<OpenBlock>    m_open_blocks;
+    /// Completed (compressed) blocks, written out after the main stream
+    ::std::vector< ::std::pair<::std::vector<uint8_t>, size_t> >  m_blocks;
+    /// FNV-1a hash of all uncompressed data written (main stream and blocks, in write order)
+    uint64_t    m_interface_hash;
+    bool    m_interface_hash_enabled;
 public:
     Writer();
     Writer(const Writer&) = delete;
@@ -46,6 +74,18 @@ public:
     void open(const ::std::string& filename);
     void write(const void* data, size_t count);
 
+    /// Exclude (or re-include) the following data from the interface hash
+    void set_interface_hash_enabled(bool enabled) {
+        m_interface_hash_enabled = enabled;
+    }
+
+    /// Redirect output to a new separately-compressed block (can be nested)
+    /// - The block can be loaded without decoding the main stream (see `BlockIndex`), so must not refer to
+    ///   anything cached by the enclosing stream (other than the string table).
+    void open_block();
+    /// Finish the current block and return its index
+    size_t close_block();
+
     void write_u8(uint8_t v) {
         write(reinterpret_cast<const char*>(&v), 1);
     }
@@ -229,26 +269,47 @@ class ReadBuffer
     unsigned int    m_ofs;
 public:
     ReadBuffer(size_t size);
+    ReadBuffer(::std::vector<uint8_t> data);
 
     size_t capacity() const { return m_backing.capacity(); }
     size_t read(void* dst, size_t len);
     void populate(ReaderInner& is);
 };
 
+/// Random access to the separately compressed blocks of a metadata file
+class BlockIndex
+{
+    ::std::string   m_path;
+    ::std::ifstream m_file;
+    ::std::vector< ::std::pair<uint64_t, uint64_t> >   m_entries;
+public:
+    BlockIndex(const ::std::string& path);
+
+    size_t size() const { return m_entries.size(); }
+    /// Read and decompress a block (NOTE: not thread safe)
+    ::std::vector<uint8_t> read_block(size_t idx);
+};
+
 class Reader
 {
     ReaderInner*    m_inner;
     ReadBuffer  m_buffer;
     size_t  m_pos;
-    ::std::vector<RcString> m_strings;
+    ::std::shared_ptr<const ::std::vector<RcString>>    m_strings;
+    ::std::shared_ptr<BlockIndex>   m_blocks;
 
     ::std::vector<std::string>  m_objname_cache;
 public:
     Reader(const ::std::string& path);
+    /// Read a block returned by `BlockIndex::read_block`
+    Reader(::std::shared_ptr<const ::std::vector<RcString>> strings, ::std::shared_ptr<BlockIndex> blocks, ::std::vector<uint8_t> data);
     Reader(const Writer&) = delete;
     Reader(Writer&&) = delete;
     ~Reader();
 
+    const ::std::shared_ptr<const ::std::vector<RcString>>& strings() const { return m_strings; }
+    const ::std::shared_ptr<BlockIndex>& blocks() const { return m_blocks; }
+
     size_t get_pos() const { return m_pos; }
     void read(void* dst, size_t count);
 
@@ -362,7 +423,7 @@ public:
     }
     RcString read_istring() {
         size_t idx = read_count();
-        return m_strings.at(idx);
+        return m_strings->at(idx);
     }
     ::std::string read_string() {
         size_t len = read_u8();
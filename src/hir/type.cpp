@@ -9,6 +9,9 @@
 #include <span.hpp>
 #include "expr.hpp" // Hack for cloning array types
 #include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <hir_typeck/common.hpp> // visit_ty_with and monomorphise_type_needed (for flags)
 
 namespace HIR {
 
@@ -388,6 +391,9 @@ bool ::HIR::TypeRef::operator==(const ::HIR::TypeRef& x) const
 
     if( !m_ptr || !x.m_ptr )
         return false;
+    // Two interned types with the same flags would have been merged if they were equal
+    if( this->is_interned() && x.is_interned() && m_ptr->m_flags == x.m_ptr->m_flags )
+        return false;
     if( data().tag() != x.data().tag() )
         return false;
 
@@ -1167,6 +1173,149 @@ HIR::TypeData_NamedFunction_Ty HIR::TypeData_NamedFunction_Ty::clone() const {
 {
     return HIR::TypeRef(*this);
 }
+size_t HIR::TypeRef::hash() const
+{
+    size_t  rv = static_cast<size_t>(data().tag());
+    auto mix = [&](size_t v) { rv ^= v + 0x9e3779b97f4a7c15ull + (rv << 6) + (rv >> 2); };
+    TU_MATCH_HDRA( (data()), {)
+    default:
+        // Rare (in interned types and layout queries), just use the tag
+        break;
+    TU_ARMA(Primitive, te) {
+        mix(static_cast<size_t>(te));
+        }
+    TU_ARMA(Path, te) {
+        if( const auto* pe = te.path.m_data.opt_Generic() ) {
+            if( !pe->m_path.components().empty() )
+                mix(::std::hash<RcString>()(pe->m_path.components().back()));
+            for(const auto& t : pe->m_params.m_types)
+                mix(t.hash());
+        }
+        else if( const auto* pe = te.path.m_data.opt_UfcsKnown() ) {
+            mix(pe->type.hash());
+            mix(::std::hash<RcString>()(pe->item));
+        }
+        else if( const auto* pe = te.path.m_data.opt_UfcsInherent() ) {
+            mix(pe->type.hash());
+            mix(::std::hash<RcString>()(pe->item));
+        }
+        }
+    TU_ARMA(Generic, te) {
+        mix(te.binding);
+        }
+    TU_ARMA(Array, te) {
+        mix(te.inner.hash());
+        if( te.size.is_Known() )
+            mix(static_cast<size_t>(te.size.as_Known()));
+        }
+    TU_ARMA(Slice, te) {
+        mix(te.inner.hash());
+        }
+    TU_ARMA(Tuple, te) {
+        for(const auto& t : te)
+            mix(t.hash());
+        }
+    TU_ARMA(Borrow, te) {
+        mix(static_cast<size_t>(te.type));
+        mix(te.inner.hash());
+        }
+    TU_ARMA(Pointer, te) {
+        mix(static_cast<size_t>(te.type));
+        mix(te.inner.hash());
+        }
+    TU_ARMA(Function, te) {
+        for(const auto& t : te.m_arg_types)
+            mix(t.hash());
+        mix(te.m_rettype.hash());
+        }
+    TU_ARMA(Closure, te) {
+        mix(reinterpret_cast<::std::uintptr_t>(te.node));
+        }
+    }
+    return rv;
+}
+namespace {
+    /// Compute the `TypeRef::Flags` for a type, and if it can be interned
+    unsigned compute_type_flags(const ::HIR::TypeRef& ty, bool& out_internable)
+    {
+        unsigned rv = 0;
+        bool internable = true;
+        visit_ty_with(ty, [&](const ::HIR::TypeRef& t)->bool {
+            TU_MATCH_HDRA( (t.data()), {)
+            default:
+                break;
+            TU_ARMA(Infer, e) {
+                rv |= ::HIR::TypeRef::FLAG_HAS_IVARS;
+                internable = false;
+                }
+            TU_ARMA(ErasedType, e) {
+                rv |= ::HIR::TypeRef::FLAG_HAS_ERASED;
+                }
+            TU_ARMA(Path, e) {
+                // The binding isn't part of the interning key, so don't merge bound and unbound paths
+                if( e.binding.is_Unbound() )
+                    internable = false;
+                }
+            }
+            return false;
+            });
+        // NOTE: Generic types imply generics, so the second walk is only needed when there are no generic types
+        if( monomorphise_type_needed(ty, /*ignore_lifetimes=*/true) )
+            rv |= ::HIR::TypeRef::FLAG_HAS_GENERIC_TYPES | ::HIR::TypeRef::FLAG_HAS_GENERICS;
+        else if( monomorphise_type_needed(ty, /*ignore_lifetimes=*/false) )
+            rv |= ::HIR::TypeRef::FLAG_HAS_GENERICS;
+        out_internable = internable;
+        return rv;
+    }
+}
+::HIR::TypeRef HIR::TypeRef::intern() const
+{
+    if( this->is_interned() )
+        return this->clone();
+    bool internable;
+    unsigned flags = compute_type_flags(*this, internable);
+    if( !internable )
+        return this->clone();
+
+    // Keyed on the structural hash and `==` (so types that only differ by lifetimes are merged), and the flags (so
+    // the stored flags are still exact for all merged types).
+    // Sharded by hash, as this is called from parallel monomorphisation/codegen workers.
+    struct Key {
+        size_t  hash;
+        ::HIR::TypeRef  ty;
+        bool operator==(const Key& x) const { return hash == x.hash && (ty.m_ptr->m_flags & ~FLAG_INTERNED) == (x.ty.m_ptr->m_flags & ~FLAG_INTERNED) && ty == x.ty; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const { return k.hash; }
+    };
+    struct Shard {
+        ::std::mutex    lock;
+        ::std::unordered_set<Key, KeyHash>  set;
+    };
+    static const size_t NUM_SHARDS = 16;
+    static Shard    shards[NUM_SHARDS];
+
+    // NOTE: The flags are mixed into the hash, and set on the un-interned copy for the lookup
+    auto ty = this->clone_shallow();
+    ty.m_ptr->m_flags = flags;
+    auto h = this->hash() ^ flags;
+    auto& shard = shards[h % NUM_SHARDS];
+    ::std::lock_guard<::std::mutex>  lh { shard.lock };
+    auto it = shard.set.find(Key { h, ty.clone() });
+    if( it == shard.set.end() )
+    {
+        ty.m_ptr->m_flags = flags | FLAG_INTERNED;
+        it = shard.set.insert(Key { h, ::std::move(ty) }).first;
+    }
+    return it->ty.clone();
+}
+unsigned HIR::TypeRef::flags() const
+{
+    if( this->is_interned() )
+        return m_ptr->m_flags;
+    bool internable;
+    return compute_type_flags(*this, internable);
+}
 ::HIR::TypeRef HIR::TypeRef::clone_shallow() const
 {
     TU_MATCH_HDRA( (data()), {)
@@ -1585,3 +1734,43 @@ HIR::TypeData_NamedFunction_Ty HIR::TypeData_NamedFunction_Ty::clone() const {
     }
     throw "";
 }
+
+::std::pair<unsigned,unsigned> HIR::TypeRef::get_impl_key_range() const
+{
+    // Key is the tag (offset by one, so zero is never a valid key) in the upper bits, and a tag-specific sub-key in the lower 16 bits
+    // - The sub-key only uses properties that `MatchGenerics::cmp_type` requires to be equal
+    auto make_key = [](TypeData::Tag tag, size_t sub)->unsigned {
+        return ((static_cast<unsigned>(tag) + 1) << 16) | static_cast<unsigned>(::std::min<size_t>(sub, 0xFFFF));
+        };
+    auto single = [&](size_t sub) {
+        auto k = make_key(data().tag(), sub);
+        return ::std::make_pair(k, k);
+        };
+    TU_MATCH_HDRA( (data()), {)
+    TU_ARMA(Infer, e) {
+        // Literal ivars can only match primitives
+        if( e.is_lit() )
+            return ::std::make_pair(make_key(TypeData::TAG_Primitive, 0), make_key(TypeData::TAG_Primitive, 0xFFFF));
+        }
+    TU_ARMA(Generic, e) {
+        }
+    TU_ARMA(Path, e) {
+        }
+    TU_ARMA(ErasedType, e) {
+        }
+    TU_ARMA(Diverge, e)     return single(0);
+    TU_ARMA(Primitive, e)   return single(static_cast<unsigned>(e));
+    TU_ARMA(TraitObject, e) return single(0);
+    TU_ARMA(Array, e)       return single(0);
+    TU_ARMA(Slice, e)       return single(0);
+    TU_ARMA(Tuple, e)       return single(e.size());
+    TU_ARMA(Borrow, e)      return single(static_cast<unsigned>(e.type));
+    TU_ARMA(Pointer, e)     return single(static_cast<unsigned>(e.type));
+    TU_ARMA(NamedFunction, e)   return single(0);
+    TU_ARMA(Function, e)    return single(e.m_arg_types.size());
+    TU_ARMA(Closure, e)     return single(0);
+    TU_ARMA(Generator, e)   return single(0);
+    }
+    // Could be anything
+    return ::std::make_pair(0u, ~0u);
+}
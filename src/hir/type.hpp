@@ -10,6 +10,7 @@
 #pragma once
 
 #include <tagged_union.hpp>
+#include <atomic>
 #include <hir/path.hpp>
 #include <hir/expr_ptr.hpp>
 #include <span.hpp>
@@ -261,12 +262,15 @@ public:
     // Existing TypeRef
 
 private:
-    unsigned    m_refcount;
+    ::std::atomic<unsigned> m_refcount;
+    /// `TypeRef::Flags`, only populated once interned
+    unsigned    m_flags;
 public:
     TypeData   m_data;
 private:
     TypeInner(TypeData d):
         m_refcount(1),
+        m_flags(0),
         m_data(mv$(d))
     {
     }
@@ -289,8 +293,7 @@ inline TypeRef::~TypeRef()
 {
     if(m_ptr)
     {
-        m_ptr->m_refcount -= 1;
-        if(m_ptr->m_refcount == 0)
+        if(m_ptr->m_refcount.fetch_sub(1) == 1)
         {
             delete m_ptr;
             m_ptr = nullptr;
@@ -298,7 +301,8 @@ inline TypeRef::~TypeRef()
     }
 }
 inline const TypeData& TypeRef::data() const { assert(m_ptr); return m_ptr->m_data; }
-inline TypeData& TypeRef::data_mut() { assert(m_ptr); return m_ptr->m_data; }
+inline TypeData& TypeRef::data_mut() { assert(m_ptr); if(m_ptr->m_flags & FLAG_INTERNED) *this = this->clone_shallow(); return m_ptr->m_data; }
+inline bool TypeRef::is_interned() const { assert(m_ptr); return (m_ptr->m_flags & FLAG_INTERNED) != 0; }
 inline TypeData& TypeRef::get_unique() { assert(m_ptr); if(m_ptr->m_refcount != 1) *this = this->clone_shallow(); return m_ptr->m_data; }
 
 
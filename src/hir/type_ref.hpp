@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstdint>
+#include <utility>
 #include <rc_string.hpp>
 #include <span.hpp>
 
@@ -117,6 +118,27 @@ public:
     static TypeRef new_closure(::HIR::ExprNode_Closure* node_ptr);
     static TypeRef new_generator(::HIR::ExprNode_Generator* node_ptr);
 
+    /// Summary of what a type contains (see `flags`)
+    enum Flags : unsigned {
+        FLAG_INTERNED = 1 << 0,
+        /// `monomorphise_type_needed(ty)`
+        FLAG_HAS_GENERICS = 1 << 1,
+        /// `monomorphise_type_needed(ty, /*ignore_lifetimes=*/true)`
+        FLAG_HAS_GENERIC_TYPES = 1 << 2,
+        FLAG_HAS_IVARS = 1 << 3,
+        FLAG_HAS_ERASED = 1 << 4,
+    };
+    /// Return the shared instance of this type from the global interning table
+    /// - Types containing ivars (or unbound paths) are just refcount-cloned
+    /// - Types that are equal (by `==`, which ignores lifetimes) and have the same flags share an instance
+    /// - Interned instances are never modified, `data_mut` on one switches to a private copy first
+    TypeRef intern() const;
+    bool is_interned() const;
+    /// Get the `Flags` for this type (stored for interned types, otherwise walks the type)
+    unsigned flags() const;
+    /// Structural hash, consistent with `==` (so ignores lifetimes and path bindings)
+    size_t hash() const;
+
     /// Create a new instance by incrementing refcount
     TypeRef clone() const;
     /// Create a new instance by copying TypeData (only one layer deep)
@@ -143,6 +165,10 @@ public:
     Compare compare_with_placeholders(const Span& sp, const ::HIR::TypeRef& x, t_cb_resolve_type resolve_placeholder) const;
 
     const ::HIR::SimplePath* get_sort_path() const;
+    /// Range of keys (inclusive) of the impl buckets that could contain impls for this type (see `HIR::Crate::ImplGroup`)
+    /// - Types with a known head (primitives, tuples, pointers, ...) give a single key
+    /// - Literal ivars give the range of primitive keys, and other unknown types (ivars, generics, unresolved paths) give everything
+    ::std::pair<unsigned,unsigned> get_impl_key_range() const;
 };
 
 }
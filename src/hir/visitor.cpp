@@ -23,9 +23,12 @@ namespace {
                 cb(*impl);
             }
         }
-        for( auto& impl : g.non_named )
+        for( auto& impl_group : g.non_named )
         {
-            cb(*impl);
+            for( auto& impl : impl_group.second )
+            {
+                cb(*impl);
+            }
         }
         for( auto& impl : g.generic )
         {
@@ -698,43 +698,60 @@ namespace {
 
                 this->m_in_expr --;
             }
+            // External expression, MIR not loaded yet - bind it when it's first used
+            else if( expr.m_mir.is_lazy() )
+            {
+                const auto& crate = m_crate;
+                auto* impl_generics = m_ms.m_impl_generics;
+                auto* item_generics = m_ms.m_item_generics;
+                expr.m_mir.add_load_fixup([&crate,impl_generics,item_generics](::MIR::Function& mir) {
+                    Visitor v { crate };
+                    v.m_ms.m_impl_generics = impl_generics;
+                    v.m_ms.m_item_generics = item_generics;
+                    v.visit_ext_mir(mir);
+                    });
+            }
             // External expression (has MIR)
             else if( auto* mir = expr.get_ext_mir_mut() )
             {
-                for(auto& ty : mir->locals)
-                    this->visit_type(ty);
-                struct MirVisitor: public ::MIR::visit::VisitorMut
-                {
-                    Visitor& upper_visitor;
-                    MirVisitor(Visitor& upper_visitor):
-                        upper_visitor(upper_visitor)
-                    {
-                    }
-                    void visit_type(::HIR::TypeRef& t) override {
-                        upper_visitor.visit_type(t);
-                    }
-                    void visit_path(::HIR::Path& p) override {
-                        upper_visitor.visit_path(p, ::HIR::Visitor::PathContext::VALUE);
-                    }
-                    bool visit_lvalue(::MIR::LValue& lv, ::MIR::visit::ValUsage u) override {
-                        if( lv.m_root.is_Static() ) {
-                            upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
-                        }
-                        return false;
-                    }
-                };
-                MirVisitor  mv(*this);
-                for(auto& block : mir->blocks)
+                visit_ext_mir(*mir);
+            }
+            else
+            {
+            }
+        }
+        void visit_ext_mir(::MIR::Function& mir)
+        {
+            for(auto& ty : mir.locals)
+                this->visit_type(ty);
+            struct MirVisitor: public ::MIR::visit::VisitorMut
+            {
+                Visitor& upper_visitor;
+                MirVisitor(Visitor& upper_visitor):
+                    upper_visitor(upper_visitor)
                 {
-                    for(auto& stmt : block.statements)
-                    {
-                        mv.visit_stmt(stmt);
+                }
+                void visit_type(::HIR::TypeRef& t) override {
+                    upper_visitor.visit_type(t);
+                }
+                void visit_path(::HIR::Path& p) override {
+                    upper_visitor.visit_path(p, ::HIR::Visitor::PathContext::VALUE);
+                }
+                bool visit_lvalue(::MIR::LValue& lv, ::MIR::visit::ValUsage u) override {
+                    if( lv.m_root.is_Static() ) {
+                        upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
                     }
-                    mv.visit_terminator(block.terminator);
+                    return false;
                 }
-            }
-            else
+            };
+            MirVisitor  mv(*this);
+            for(auto& block : mir.blocks)
             {
+                for(auto& stmt : block.statements)
+                {
+                    mv.visit_stmt(stmt);
+                }
+                mv.visit_terminator(block.terminator);
             }
         }
     };
@@ -1185,43 +1202,60 @@ namespace {
                 ExprVisitor v { *this };
                 (*expr).visit(v);
             }
+            // External expression, MIR not loaded yet - bind it when it's first used
+            else if( expr.m_mir.is_lazy() )
+            {
+                const auto& crate = m_crate;
+                auto* impl_generics = m_ms.m_impl_generics;
+                auto* item_generics = m_ms.m_item_generics;
+                expr.m_mir.add_load_fixup([&crate,impl_generics,item_generics](::MIR::Function& mir) {
+                    Visitor_Post v { crate };
+                    v.m_ms.m_impl_generics = impl_generics;
+                    v.m_ms.m_item_generics = item_generics;
+                    v.visit_ext_mir(mir);
+                    });
+            }
             // External expression (has MIR)
             else if( auto* mir = expr.get_ext_mir_mut() )
             {
-                for(auto& ty : mir->locals)
-                    this->visit_type(ty);
-                struct MirVisitor: public ::MIR::visit::VisitorMut
-                {
-                    Visitor_Post& upper_visitor;
-                    MirVisitor(Visitor_Post& upper_visitor):
-                        upper_visitor(upper_visitor)
-                    {
-                    }
-                    void visit_type(::HIR::TypeRef& t) override {
-                        upper_visitor.visit_type(t);
-                    }
-                    void visit_path(::HIR::Path& p) override {
-                        upper_visitor.visit_path(p, ::HIR::Visitor::PathContext::VALUE);
-                    }
-                    bool visit_lvalue(::MIR::LValue& lv, ::MIR::visit::ValUsage u) override {
-                        if( lv.m_root.is_Static() ) {
-                            upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
-                        }
-                        return false;
-                    }
-                };
-                MirVisitor  mv(*this);
-                for(auto& block : mir->blocks)
+                visit_ext_mir(*mir);
+            }
+            else
+            {
+            }
+        }
+        void visit_ext_mir(::MIR::Function& mir)
+        {
+            for(auto& ty : mir.locals)
+                this->visit_type(ty);
+            struct MirVisitor: public ::MIR::visit::VisitorMut
+            {
+                Visitor_Post& upper_visitor;
+                MirVisitor(Visitor_Post& upper_visitor):
+                    upper_visitor(upper_visitor)
                 {
-                    for(auto& stmt : block.statements)
-                    {
-                        mv.visit_stmt(stmt);
+                }
+                void visit_type(::HIR::TypeRef& t) override {
+                    upper_visitor.visit_type(t);
+                }
+                void visit_path(::HIR::Path& p) override {
+                    upper_visitor.visit_path(p, ::HIR::Visitor::PathContext::VALUE);
+                }
+                bool visit_lvalue(::MIR::LValue& lv, ::MIR::visit::ValUsage u) override {
+                    if( lv.m_root.is_Static() ) {
+                        upper_visitor.visit_path(lv.m_root.as_Static(), ::HIR::Visitor::PathContext::VALUE);
                     }
-                    mv.visit_terminator(block.terminator);
+                    return false;
                 }
-            }
-            else
+            };
+            MirVisitor  mv(*this);
+            for(auto& block : mir.blocks)
             {
+                for(auto& stmt : block.statements)
+                {
+                    mv.visit_stmt(stmt);
+                }
+                mv.visit_terminator(block.terminator);
             }
         }
     };
@@ -18,6 +18,7 @@
 #include <int128.h> // 128 bit integer support
 
 #include "constant_evaluation.hpp"
+#include <parallel.hpp>   // lazy_state_lock
 #include <trans/monomorphise.hpp>   // For handling monomorph of MIR in provided associated constants
 #include <trans/codegen.hpp>    // For encoding as part of transmute
 
@@ -3681,6 +3682,8 @@ void ConvertHIR_ConstantEvaluate_ConstGeneric( const Span& sp, const ::HIR::Crat
 {
     if( auto* cge_p = cg.opt_Unevaluated() )
     {
+        // Can be called from parallel typecheck/optimisation, and evaluation updates shared items
+        ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
         const auto& cge = *cge_p;
         const auto& e = *cge->expr;
         ASSERT_BUG(sp, e.m_state, "TODO: Should the expression state be set already?");
@@ -3756,6 +3759,7 @@ void ConvertHIR_ConstantEvaluate_MethodParams(
     {
         if(v.is_Unevaluated())
         {
+            ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
             const auto& ue = *v.as_Unevaluated();
             const auto& e = *ue.expr;
             auto name = FMT("param_" << &v << "#");
@@ -1018,13 +1018,13 @@ namespace resolve_ufcs {
                 DEBUG(*path << " += " << FMT_CB(os, fmt(os, *ty_impl)));
                 ig.named[*path].push_back(mv$(ty_impl));
             }
-            else if( type.data().is_Path() || type.data().is_Generic() )
-            {
-                return false;
-            }
             else
             {
-                ig.non_named.push_back(mv$(ty_impl));
+                auto keys = type.get_impl_key_range();
+                // Generics, unresolved paths, and erased types stay in the generic list
+                if( keys.first != keys.second )
+                    return false;
+                ig.non_named[keys.first].push_back(mv$(ty_impl));
             }
             return true;
             });
@@ -1045,7 +1045,9 @@ namespace resolve_ufcs {
         for(const auto& e : src.named) {
             push_index_impl_group_list(dst.named[e.first], e.second);
         }
-        push_index_impl_group_list(dst.non_named, src.non_named);
+        for(const auto& e : src.non_named) {
+            push_index_impl_group_list(dst.non_named[e.first], e.second);
+        }
         push_index_impl_group_list(dst.generic  , src.generic  );
     }
     void push_index_impls(::HIR::Crate& dst, const ::HIR::Crate& src)
@@ -1076,7 +1078,9 @@ namespace resolve_ufcs {
         for(const auto& e : src.m_type_impls.named) {
             push_index_inherent_methods_list(icache, lang_Box, e.second);
         }
-        push_index_inherent_methods_list(icache, lang_Box, src.m_type_impls.non_named);
+        for(const auto& e : src.m_type_impls.non_named) {
+            push_index_inherent_methods_list(icache, lang_Box, e.second);
+        }
         push_index_inherent_methods_list(icache, lang_Box, src.m_type_impls.generic  );
     }
 }   // namespace ""
@@ -1106,7 +1110,7 @@ void ConvertHIR_ResolveUFCS_SortImpls(::HIR::Crate& crate)
     sort_impl_group<HIR::TypeImpl>(crate.m_type_impls,
         [](::std::ostream& os, const HIR::TypeImpl& i){ os << "impl" << i.m_params.fmt_args() << " " << i.m_type; }
         );
-    DEBUG("Type impl counts: " << crate.m_type_impls.named.size() << " path groups, " << crate.m_type_impls.non_named.size() << " primitive, " << crate.m_type_impls.generic.size() << " ungrouped");
+    DEBUG("Type impl counts: " << crate.m_type_impls.named.size() << " path groups, " << crate.m_type_impls.non_named.size() << " primitive groups, " << crate.m_type_impls.generic.size() << " ungrouped");
     for(auto& impl_group : crate.m_trait_impls)
     {
         sort_impl_group<HIR::TraitImpl>(impl_group.second,
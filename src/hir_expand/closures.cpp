@@ -104,6 +104,7 @@ namespace {
             trait_impl_list_r.push_back(ptr.get());
             auto& trait_impl_list   = crate.m_trait_impls[p].get_list_for_type_mut(ptr->m_type);
             trait_impl_list.push_back(mv$(ptr));
+            crate.m_impl_generation ++;
             };
         for(auto& impl : this->impls_closure)
         {
@@ -140,6 +141,7 @@ namespace {
                     });
                 crate.m_all_type_impls.named[path].push_back( ptr.get() );
                 crate.m_type_impls.named[path].push_back( mv$(ptr) );
+                crate.m_impl_generation ++;
                 } break;
             case ::HIR::ExprNode_Closure::Class::Unknown:
                 BUG(Span(), "Encountered Unkown closure type in new impls");
@@ -1226,6 +1228,7 @@ namespace {
                     /*source module*/::HIR::SimplePath(m_resolve.m_crate.m_crate_name, {})
                     }));
                 const_cast<::HIR::Crate&>(m_resolve.m_crate).m_all_trait_impls[lang_Copy].get_list_for_type_mut(closure_type).push_back( v.back().get() );
+                const_cast<::HIR::Crate&>(m_resolve.m_crate).m_impl_generation ++;
             }
 
             // ---
@@ -261,6 +261,8 @@ struct TyVisitorMonomorphNeeded: TyVisitor<WConst>
     }
     bool visit_type(const ::HIR::TypeRef& ty) override
     {
+        if( ty.is_interned() )
+            return (ty.flags() & (ignore_lifetimes ? ::HIR::TypeRef::FLAG_HAS_GENERIC_TYPES : ::HIR::TypeRef::FLAG_HAS_GENERICS)) != 0;
         if( ty.data().is_Generic() )
             return true;
         if( ty.data().is_Array() && ty.data().as_Array().size.is_Unevaluated() /*&& ty.data().as_Array().size.as_Unevaluated().*/ )
@@ -11,6 +11,7 @@
 #include <hir/generic_params.hpp>
 #include <hir/type.hpp>
 #include <hir_typeck/monomorph.hpp>
+#include <set>
 
 typedef ::std::function<bool(const ::HIR::TypeRef&)> t_cb_visit_ty;
 /// Calls the provided callback on every type seen when recursing the type.
@@ -31,6 +32,9 @@ extern ::HIR::PathParams clone_path_params_with(const Span& sp, const ::HIR::Pat
 extern void check_type_class_primitive(const Span& sp, const ::HIR::TypeRef& type, ::HIR::InferClass ic, ::HIR::CoreType ct);
 
 class StaticTraitResolve;
-extern void Typecheck_Expressions_ValidateOne(const StaticTraitResolve& resolve, const ::std::vector<::std::pair< ::HIR::Pattern, ::HIR::TypeRef>>& args, const ::HIR::TypeRef& ret_ty, const ::HIR::ExprPtr& code);
+/// `defined_aliases` - If non-null, only these type-alias impl-traits are expanded (the ones defined by this body, as other
+/// bodies may still be being checked)
+extern void Typecheck_Expressions_ValidateOne(const StaticTraitResolve& resolve, const ::std::vector<::std::pair< ::HIR::Pattern, ::HIR::TypeRef>>& args, const ::HIR::TypeRef& ret_ty, const ::HIR::ExprPtr& code,
+    const ::std::set<const ::HIR::TypeData_ErasedType_AliasInner*>* defined_aliases=nullptr);
 
 
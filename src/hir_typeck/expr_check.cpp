@@ -10,6 +10,7 @@
 #include <hir_typeck/static.hpp>
 #include "main_bindings.hpp"
 #include <algorithm>
+#include <parallel.hpp>   // lazy_state_lock
 
 namespace {
     typedef ::std::vector< ::std::pair< ::HIR::Pattern, ::HIR::TypeRef> >   t_args;
@@ -36,6 +37,8 @@ namespace {
 
     public:
         bool expand_erased_types;
+        /// If non-null, only these type-alias impl-traits are expanded (see `Typecheck_Expressions_ValidateOne`)
+        const ::std::set<const ::HIR::TypeData_ErasedType_AliasInner*>*  defined_aliases = nullptr;
 
         ExprVisitor_Validate(const StaticTraitResolve& res, const t_args& args, const ::HIR::TypeRef& ret_type):
             m_resolve(res),
@@ -1178,13 +1181,23 @@ namespace {
         void check_types_equal(const Span& sp, const ::HIR::TypeRef& l, const ::HIR::TypeRef& r) const
         {
             struct Resolve: HIR::ResolvePlaceholders {
+                const ::std::set<const ::HIR::TypeData_ErasedType_AliasInner*>*  defined_aliases;
                 mutable ::HIR::TypeRef  tmp;
+                Resolve(const ::std::set<const ::HIR::TypeData_ErasedType_AliasInner*>* defined_aliases): defined_aliases(defined_aliases) {}
                 const ::HIR::TypeRef& get_type(const Span& sp, const HIR::TypeRef& ty) const override {
                     //ASSERT_BUG(sp, ty.data().is_Infer(), "Unexpected ivar");
                     if( const auto* e = ty.data().opt_ErasedType() )
                     {
                         if( const auto* ee = e->m_inner.opt_Alias() )
                         {
+                            // Aliases defined by other bodies may not be known yet (if those bodies are being checked on
+                            // other threads), so leave them opaque instead of depending on the scheduling.
+                            if( defined_aliases && defined_aliases->count(ee->inner.get()) == 0 ) {
+                                return ty;
+                            }
+                            // NOTE: Only ever set once (and already set for the aliases defined by this body), the lock
+                            // is for the memory ordering with the setting thread.
+                            ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
                             if( ee->inner->type != HIR::TypeRef() ) {
                                 return tmp = MonomorphStatePtr(nullptr, &ee->params, nullptr).monomorph_type(sp, ee->inner->type);
                             }
@@ -1195,7 +1208,7 @@ namespace {
                 const ::HIR::ConstGeneric& get_val(const Span& sp, const HIR::ConstGeneric& v) const override {
                     return v;
                 }
-            } get_types;
+            } get_types { defined_aliases };
             // TODO: Recurse when an erased type is encountered
             //if( const auto* e = l.data().opt_ErasedType() )
             //{
@@ -1458,10 +1471,12 @@ namespace {
     };
 }
 
-void Typecheck_Expressions_ValidateOne(const StaticTraitResolve& resolve, const ::std::vector<::std::pair< ::HIR::Pattern, ::HIR::TypeRef>>& args, const ::HIR::TypeRef& ret_ty, const ::HIR::ExprPtr& code)
+void Typecheck_Expressions_ValidateOne(const StaticTraitResolve& resolve, const ::std::vector<::std::pair< ::HIR::Pattern, ::HIR::TypeRef>>& args, const ::HIR::TypeRef& ret_ty, const ::HIR::ExprPtr& code,
+    const ::std::set<const ::HIR::TypeData_ErasedType_AliasInner*>* defined_aliases)
 {
     ExprVisitor_Validate    ev(resolve, args, ret_ty);
     ev.expand_erased_types = false; // TODO: Make this an argument, we don't want to do this too early
+    ev.defined_aliases = defined_aliases;
     ev.visit_root( const_cast<::HIR::ExprPtr&>(code) );
 }
 
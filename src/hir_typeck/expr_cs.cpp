@@ -16,6 +16,7 @@
 #include "expr_visit.hpp"
 #include "expr_cs.hpp"
 #include "hir_conv/main_bindings.hpp"
+#include <parallel.hpp>   // lazy_state_lock
 
 namespace {
     inline HIR::ExprNodeP mk_exprnodep(HIR::ExprNode* en, ::HIR::TypeRef ty){ en->m_res_type = mv$(ty); return HIR::ExprNodeP(en); }
@@ -1364,6 +1365,8 @@ namespace {
                     auto p = ent.first->generics.make_nop_params(0);
                     MonomorphStatePtr(nullptr, &p, nullptr).monomorph_type(node.span(), ty);
                 }
+                // NOTE: The alias is shared with other functions, which may be being checked on other threads
+                ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
                 if( ent.first->type == HIR::TypeRef() ) {
                     DEBUG("type " << ent.first->path << " = " << ty);
                     ent.first->type = std::move(ty);
@@ -8246,7 +8249,12 @@ void Typecheck_Code_CS(const typeck::ModuleState& ms, t_args& args, const ::HIR:
         DEBUG("==== FINAL VALIDATE ====");
         StaticTraitResolve  static_resolve(ms.m_crate);
         static_resolve.set_both_generics_raw(ms.m_impl_generics, ms.m_item_generics);
-        Typecheck_Expressions_ValidateOne(static_resolve, args, result_type, expr);
+        // Only the type-alias impl-traits defined by this body are expanded, so the result doesn't depend on which other
+        // bodies have been checked (possibly in parallel)
+        ::std::set<const HIR::TypeData_ErasedType_AliasInner*>  defined_aliases;
+        for(const auto& ent : context.m_erased_type_aliases)
+            defined_aliases.insert(ent.first);
+        Typecheck_Expressions_ValidateOne(static_resolve, args, result_type, expr, &defined_aliases);
 
         DEBUG("=== Method const params ===");
         struct VisitMethodConst: public HIR::ExprVisitorDef {
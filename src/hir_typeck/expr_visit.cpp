@@ -10,6 +10,8 @@
 #include <hir/visitor.hpp>
 #include "expr_visit.hpp"
 #include <hir/expr_state.hpp>
+#include <parallel.hpp>
+#include <self_profile.hpp>
 
 void Typecheck_Code(const typeck::ModuleState& ms, t_args& args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr) {
     if( expr.m_state->stage < ::HIR::ExprState::Stage::Typecheck )
@@ -106,14 +108,49 @@ namespace typeck {
 
 namespace {
 
+    /// An expression root collected for typechecking on a worker thread
+    struct DeferredTypecheck
+    {
+        ::typeck::ModuleState   ms;
+        // Owned copy of `ms.m_current_trait` (the visitor's copy is on the stack)
+        ::std::unique_ptr<::HIR::GenericPath>   current_trait;
+        t_args* args;
+        t_args  tmp_args;
+        ::HIR::TypeRef  result_type;
+        ::HIR::ExprPtr* expr;
+        // Item name for the self-profiler (only populated when profiling)
+        ::std::string   profile_name;
+
+        DeferredTypecheck(const ::typeck::ModuleState& ms, t_args* args, const ::HIR::TypeRef& result_type, ::HIR::ExprPtr& expr, ::std::string profile_name):
+            ms(ms),
+            args(args),
+            result_type(result_type.clone()),
+            expr(&expr),
+            profile_name(::std::move(profile_name))
+        {
+            if( ms.m_current_trait )
+            {
+                current_trait = ::std::make_unique<::HIR::GenericPath>(ms.m_current_trait->clone());
+                this->ms.m_current_trait = current_trait.get();
+            }
+        }
+        void run()
+        {
+            ProfileScope    _profile_item_("Typecheck", [&](){ return profile_name; });
+            Typecheck_Code(ms, args ? *args : tmp_args, result_type, *expr);
+        }
+    };
 
     class OuterVisitor:
         public ::HIR::Visitor
     {
         ::typeck::ModuleState m_ms;
+        /// If non-null, function bodies are collected here instead of being checked immediately
+        ::std::vector<::std::unique_ptr<DeferredTypecheck>>*  m_deferred;
     public:
-        OuterVisitor(::HIR::Crate& crate):
-            m_ms(crate)
+        OuterVisitor(::HIR::Crate& crate, ::std::vector<::std::unique_ptr<DeferredTypecheck>>* deferred=nullptr):
+            m_ms(crate),
+            m_deferred(deferred)
         {
         }
 
@@ -209,7 +246,17 @@ namespace {
             if( item.m_code )
             {
                 DEBUG("Function code " << p);
-                Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
+                // `const fn` bodies can be typechecked on-demand by constant evaluation, so are always checked here
+                // (before any worker starts) to avoid racing with that.
+                if( m_deferred && !item.m_const )
+                {
+                    m_deferred->push_back(::std::make_unique<DeferredTypecheck>( m_ms, &item.m_args, item.m_return, item.m_code, g_self_profile_enabled ? FMT(p) : "" ));
+                }
+                else
+                {
+                    PROFILE_ITEM("Typecheck", p);
+                    Typecheck_Code( m_ms, item.m_args, item.m_return, item.m_code );
+                }
             }
             else
             {
@@ -255,8 +302,24 @@ namespace {
     };
 }
 
-void Typecheck_Expressions(::HIR::Crate& crate)
+void Typecheck_Expressions(::HIR::Crate& crate, unsigned num_threads)
 {
-    OuterVisitor    visitor { crate };
-    visitor.visit_crate( crate );
+    // NOTE: Debug output is only sensible when single-threaded
+    if( num_threads > 1 && !debug_enabled() )
+    {
+        // Check everything that can be referenced by constant evaluation (constants, statics, array sizes, const fns)
+        // immediately, and collect other function bodies to be checked in parallel.
+        ::std::vector<::std::unique_ptr<DeferredTypecheck>>  deferred;
+        OuterVisitor    visitor { crate, &deferred };
+        visitor.visit_crate( crate );
+
+        parallel_for_each_index(num_threads, deferred.size(), [&](unsigned , size_t idx) {
+            deferred[idx]->run();
+            });
+    }
+    else
+    {
+        OuterVisitor    visitor { crate };
+        visitor.visit_crate( crate );
+    }
 }
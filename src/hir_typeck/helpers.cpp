@@ -8,6 +8,7 @@
 #include "helpers.hpp"
 #include <hir_conv/main_bindings.hpp>
 #include <algorithm>
+#include <atomic>
 
 // --------------------------------------------------------------------
 // HMTypeInferrence
@@ -3012,7 +3013,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
         StackHandle& operator=(const StackHandle&) = delete;
         ~StackHandle() { if(stack) stack->pop_back(); stack = nullptr; }
     };
-    static std::vector<StackEnt>    s_recurse_stack;
+    thread_local std::vector<StackEnt>    s_recurse_stack;
     auto se = StackEnt(trait, params_ptr, type);
     // NOTE: Allow 1 level of recursion (EAT being run)
     if( std::count(s_recurse_stack.begin(), s_recurse_stack.end(), se) > 1 ) {
@@ -3026,7 +3027,7 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     if( m_crate.get_trait_by_path(sp, trait).m_is_marker )
     {
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait )
                 continue ;
@@ -3447,11 +3448,10 @@ bool TraitResolution::find_trait_impls_crate(const Span& sp,
     }
     if( placeholders_needed )
     {
-        static uint64_t s_ph_counter = 0;
+        static ::std::atomic<uint64_t> s_ph_counter { 0 };
         // NOTE: Not using interning, because these are short-lived
         // - Also, adding an interned string is quite expensive
-        placeholder_name = RcString(FMT("ph_" << &impl_params_def << "_" << s_ph_counter));
-        s_ph_counter += 1;
+        placeholder_name = RcString(FMT("ph_" << &impl_params_def << "_" << s_ph_counter++));
         for(unsigned int i = 0; i < out_impl_params.m_types.size(); i ++ )
         {
             if( out_impl_params.m_types[i] == HIR::TypeRef() )
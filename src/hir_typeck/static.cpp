@@ -10,6 +10,81 @@
 #include <hir/expr.hpp>
 #include <hir_conv/main_bindings.hpp>
 
+namespace {
+    /// Returns true if the result of a trait query on this type can't depend on the generic scope
+    bool is_selection_cacheable(const ::HIR::TypeRef& ty)
+    {
+        if( monomorphise_type_needed(ty) )
+            return false;
+        return !visit_ty_with(ty, [](const ::HIR::TypeRef& t) {
+            TU_MATCH_HDRA( (t.data()), {)
+            default:
+                return false;
+            TU_ARMA(Infer, e)
+                return true;
+            TU_ARMA(ErasedType, e)
+                return true;
+            TU_ARMA(Path, e)
+                return !e.path.m_data.is_Generic() || e.binding.is_Unbound() || e.binding.is_Opaque();
+            }
+            throw "";
+            });
+    }
+    bool is_selection_cacheable(const ::HIR::PathParams& params)
+    {
+        for(const auto& v : params.m_values)
+            if( !v.is_Evaluated() )
+                return false;
+        for(const auto& ty : params.m_types)
+            if( !is_selection_cacheable(ty) )
+                return false;
+        return true;
+    }
+
+    /// Make a copy of an `ImplRef` that doesn't borrow from the query
+    ImplRef clone_implref(const ImplRef& ir, const ::HIR::SimplePath& trait_path)
+    {
+        TU_MATCH_HDRA( (ir.m_data), {)
+        TU_ARMA(TraitImpl, e) {
+            return ImplRef(e.impl_params.clone(), *e.trait_ptr, trait_path, *e.impl);
+            }
+        TU_ARMA(BoundedPtr, e) {
+            ::HIR::TraitPath::assoc_list_t  assoc;
+            for(const auto& a : *e.assoc)
+                assoc.insert(::std::make_pair(a.first, a.second.clone()));
+            return ImplRef(e.hrls ? e.hrls->clone() : ::HIR::GenericParams(), e.type->clone(), e.trait_args->clone(), mv$(assoc));
+            }
+        TU_ARMA(Bounded, e) {
+            ::HIR::TraitPath::assoc_list_t  assoc;
+            for(const auto& a : e.assoc)
+                assoc.insert(::std::make_pair(a.first, a.second.clone()));
+            return ImplRef(e.hrls.clone(), e.type.clone(), e.trait_args.clone(), mv$(assoc));
+            }
+        }
+        throw "";
+    }
+}
+
+void StaticTraitResolve::update_selection_cache_enabled()
+{
+    // Bounds on concrete types (e.g. `where u32: Foo`) would be visible to monomorphic queries
+    m_selection_cache_enabled = true;
+    for(const auto& b : m_trait_bounds)
+    {
+        if( !monomorphise_type_needed(b.first.first) ) {
+            m_selection_cache_enabled = false;
+            return ;
+        }
+    }
+    for(const auto& e : m_type_equalities)
+    {
+        if( !monomorphise_type_needed(e.first) ) {
+            m_selection_cache_enabled = false;
+            return ;
+        }
+    }
+}
+
 bool StaticTraitResolve::find_impl(
     const Span& sp,
     const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
@@ -17,6 +92,89 @@ bool StaticTraitResolve::find_impl(
     t_cb_find_impl found_cb,
     bool dont_handoff_to_specialised
     ) const
+{
+    if( dont_handoff_to_specialised || !trait_params || !m_selection_cache_enabled
+        || !is_selection_cacheable(type) || !is_selection_cacheable(*trait_params) )
+    {
+        return find_impl__uncached(sp, trait_path, trait_params, type, found_cb, dont_handoff_to_specialised);
+    }
+
+    if( m_selection_cache_generation != m_crate.m_impl_generation )
+    {
+        // Can't clear while an entry is being filled/replayed further up the stack
+        if( m_selection_cache_active > 0 )
+            return find_impl__uncached(sp, trait_path, trait_params, type, found_cb, false);
+        DEBUG("Impl list changed, clearing selection cache");
+        m_selection_cache.clear();
+        m_selection_cache_generation = m_crate.m_impl_generation;
+    }
+
+    auto key = ::std::make_tuple(trait_path, trait_params->clone(), type.clone());
+    auto it = m_selection_cache.find(key);
+    // Number of candidates already passed to `found_cb` from the cache
+    size_t n_replayed = 0;
+    if( it != m_selection_cache.end() )
+    {
+        auto& ent = it->second;
+        if( ent.in_use )
+            return find_impl__uncached(sp, trait_path, trait_params, type, found_cb, false);
+        m_selection_cache_hits ++;
+        DEBUG("Selection cache hit for " << trait_path << *trait_params << " for " << type
+            << " (" << m_selection_cache_hits << " hits, " << m_selection_cache_misses << " misses)");
+        ent.in_use = true;
+        m_selection_cache_active ++;
+        // NOTE: Index loop, as `found_cb` can recurse into `find_impl`
+        for(; n_replayed < ent.candidates.size(); n_replayed ++)
+        {
+            const auto& c = ent.candidates[n_replayed];
+            if( found_cb(clone_implref(c.first, ::std::get<0>(it->first)), c.second) ) {
+                ent.in_use = false;
+                m_selection_cache_active --;
+                return true;
+            }
+        }
+        ent.in_use = false;
+        m_selection_cache_active --;
+        if( ent.complete )
+            return false;
+        // The original query stopped early, run the full search (skipping the candidates already seen)
+        DEBUG("- Partial entry, searching");
+    }
+    else
+    {
+        m_selection_cache_misses ++;
+        DEBUG("Selection cache miss for " << trait_path << *trait_params << " for " << type
+            << " (" << m_selection_cache_hits << " hits, " << m_selection_cache_misses << " misses)");
+        ::std::get<2>(key) = ::std::get<2>(key).intern();
+        it = m_selection_cache.insert(::std::make_pair(mv$(key), SelectionCacheEnt())).first;
+    }
+
+    // Record the candidates while passing them through
+    auto& ent = it->second;
+    const auto& cached_trait_path = ::std::get<0>(it->first);
+    ent.candidates.clear();
+    ent.complete = false;
+    ent.in_use = true;
+    m_selection_cache_active ++;
+    bool rv = find_impl__uncached(sp, trait_path, trait_params, type, [&](ImplRef impl, bool is_fuzzed)->bool {
+        ent.candidates.push_back(::std::make_pair( clone_implref(impl, cached_trait_path), is_fuzzed ));
+        if( ent.candidates.size() <= n_replayed )
+            return false;
+        return found_cb(mv$(impl), is_fuzzed);
+        }, false);
+    ent.complete = !rv;
+    ent.in_use = false;
+    m_selection_cache_active --;
+    return rv;
+}
+
+bool StaticTraitResolve::find_impl__uncached(
+    const Span& sp,
+    const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+    const ::HIR::TypeRef& type,
+    t_cb_find_impl found_cb,
+    bool dont_handoff_to_specialised
+    ) const
 {
     TRACE_FUNCTION_F(trait_path << FMT_CB(os, if(trait_params) { os << *trait_params; } else { os << "<?>"; }) << " for " << type);
     auto cb_ident = HIR::ResolvePlaceholdersNop();
@@ -77,7 +235,7 @@ bool StaticTraitResolve::find_impl(
             }
             else {
             }
-            static ::HIR::TraitPath::assoc_list_t   assoc_unit;
+            thread_local ::HIR::TraitPath::assoc_list_t   assoc_unit;
             if(assoc_unit.empty()) {
                 assoc_unit.insert(std::make_pair( RcString::new_interned("Discriminant"), HIR::TraitPath::AtyEqual {
                     m_lang_DiscriminantKind,
@@ -87,9 +245,9 @@ bool StaticTraitResolve::find_impl(
             return found_cb( ImplRef(&null_hrls, &type, trait_params, &assoc_unit), false );
         }
         else if( TARGETVER_LEAST_1_54 && trait_path == m_lang_Pointee ) {
-            static ::HIR::TraitPath::assoc_list_t   assoc_unit;
-            static ::HIR::TraitPath::assoc_list_t   assoc_slice;
-            static RcString name_Metadata;
+            thread_local ::HIR::TraitPath::assoc_list_t   assoc_unit;
+            thread_local ::HIR::TraitPath::assoc_list_t   assoc_slice;
+            thread_local RcString name_Metadata;
             if(assoc_unit.empty()) {
                 name_Metadata = RcString::new_interned("Metadata");
                 assoc_unit.insert(std::make_pair( name_Metadata, HIR::TraitPath::AtyEqual {
@@ -636,7 +794,7 @@ bool StaticTraitResolve::find_impl(
             return rv;
 
         // Detect recursion and return true if detected
-        static ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
+        thread_local ::std::vector< ::std::tuple< const ::HIR::SimplePath*, const ::HIR::PathParams*, const ::HIR::TypeRef*> >    stack;
         for(const auto& ent : stack ) {
             if( *::std::get<0>(ent) != trait_path )
                 continue ;
@@ -1549,6 +1707,7 @@ void StaticTraitResolve::expand_associated_types_inner(const Span& sp, ::HIR::Ty
             else
             {
                 this->expand_associated_types__UfcsKnown(sp, input);
+                input = input.intern();
                 m_aty_cache.insert(std::make_pair( std::move(k), input.clone() ));
             }
             return;
@@ -1635,12 +1794,12 @@ bool StaticTraitResolve::expand_associated_types__UfcsKnown(const Span& sp, ::HI
     auto& e = input.data_mut().as_Path();
     auto& e2 = e.path.m_data.as_UfcsKnown();
 
-    static unsigned s_recursion_level;
+    thread_local unsigned s_recursion_level;
     struct RecurseEntry {
         HIR::TypeRef    ty;
         unsigned level;
     };
-    static std::vector<RecurseEntry>    s_recursion_stack;
+    thread_local std::vector<RecurseEntry>    s_recursion_stack;
     {
         bool hit_same_level_loop = false;
         for(const auto& ent : s_recursion_stack) {
@@ -2077,7 +2236,7 @@ bool StaticTraitResolve::type_is_copy(const Span& sp, const ::HIR::TypeRef& ty)
         }
         auto pp = ::HIR::PathParams();
         bool rv = this->find_impl__bounds(sp, m_lang_Copy, &pp, ty, [&](auto , bool ){ return true; });
-        m_copy_cache.insert(::std::make_pair( ty.clone(), rv ));
+        m_copy_cache.insert(::std::make_pair( ty.intern(), rv ));
         return rv;
         }
     TU_ARMA(Path, e) {
@@ -2107,7 +2266,7 @@ bool StaticTraitResolve::type_is_copy(const Span& sp, const ::HIR::TypeRef& ty)
         }
         auto pp = ::HIR::PathParams();
         bool rv = this->find_impl(sp, m_lang_Copy, &pp, ty, [&](auto , bool){ return true; }, true);
-        m_copy_cache.insert(::std::make_pair( ty.clone(), rv ));
+        m_copy_cache.insert(::std::make_pair( ty.intern(), rv ));
         return rv;
         }
     TU_ARMA(Diverge, e) {
@@ -2197,7 +2356,7 @@ bool StaticTraitResolve::type_is_clone(const Span& sp, const ::HIR::TypeRef& ty)
         }
         auto pp = ::HIR::PathParams();
         bool rv = this->find_impl__bounds(sp, m_lang_Clone, &pp, ty, [&](auto , bool ){ return true; });
-        m_clone_cache.insert(::std::make_pair( ty.clone(), rv ));
+        m_clone_cache.insert(::std::make_pair( ty.intern(), rv ));
         return rv;
         }
     TU_ARMA(Path, e) {
@@ -2210,12 +2369,12 @@ bool StaticTraitResolve::type_is_clone(const Span& sp, const ::HIR::TypeRef& ty)
         {
             bool rv = true;
             // TODO: Check all captures
-            m_clone_cache.insert(::std::make_pair( ty.clone(), rv ));
+            m_clone_cache.insert(::std::make_pair( ty.intern(), rv ));
             return rv;
         }
         auto pp = ::HIR::PathParams();
         bool rv = this->find_impl(sp, m_lang_Clone, &pp, ty, [&](auto , bool){ return true; }, true);
-        m_clone_cache.insert(::std::make_pair( ty.clone(), rv ));
+        m_clone_cache.insert(::std::make_pair( ty.intern(), rv ));
         return rv;
         }
     TU_ARMA(Diverge, e) {
@@ -2934,7 +3093,7 @@ bool StaticTraitResolve::type_needs_drop_glue(const Span& sp, const ::HIR::TypeR
         bool has_direct_drop = this->find_impl(sp, m_lang_Drop, &pp, ty, [&](auto , bool){ return true; }, true);
         if( has_direct_drop )
         {
-            m_drop_cache.insert(::std::make_pair(ty.clone(), true));
+            m_drop_cache.insert(::std::make_pair(ty.intern(), true));
             return true;
         }
 
@@ -3001,7 +3160,7 @@ bool StaticTraitResolve::type_needs_drop_glue(const Span& sp, const ::HIR::TypeR
             needs_drop_glue = false;
             )
         )
-        m_drop_cache.insert(::std::make_pair(ty.clone(), needs_drop_glue));
+        m_drop_cache.insert(::std::make_pair(ty.intern(), needs_drop_glue));
         return needs_drop_glue;
         }
     TU_ARMA(Diverge, e) {
@@ -12,6 +12,7 @@
 #include "impl_ref.hpp"
 #include <range_vec_map.hpp>
 #include "resolve_common.hpp"
+#include <tuple>
 
 enum class MetadataType {
     Unknown,    // Unknown still
@@ -37,11 +38,34 @@ class StaticTraitResolve:
     public TraitResolveCommon
 {
     MetadataType   m_self_metadata = MetadataType::Unknown;
+    // NOTE: Cached types are interned (see `HIR::TypeRef::intern`), so lookups using interned types (e.g. from
+    // monomorphised MIR) end with a pointer comparison, and repeated results share one node.
     mutable ::std::map< ::HIR::TypeRef, bool >  m_copy_cache;
     mutable ::std::map< ::HIR::TypeRef, bool >  m_clone_cache;
     mutable ::std::map< ::HIR::TypeRef, bool >  m_drop_cache;
     mutable ::std::map< std::string, HIR::TypeRef>  m_aty_cache;
 
+    /// Result of a `find_impl` query with monomorphic inputs: the candidates passed to the callback, in order
+    struct SelectionCacheEnt {
+        ::std::vector< ::std::pair<ImplRef, bool> > candidates;
+        /// Set if the search ran to completion (otherwise `candidates` is only the prefix that the first caller looked at)
+        bool    complete = false;
+        /// Set while this entry is being filled or replayed, recursive queries for the same key bypass the cache
+        bool    in_use = false;
+    };
+    typedef ::std::tuple< ::HIR::SimplePath, ::HIR::PathParams, ::HIR::TypeRef >   selection_key_t;
+    /// Selection cache, keyed on (trait, trait params, type)
+    /// - Kept across generic scope changes, as monomorphic queries don't depend on the scope (unless it has bounds on
+    ///   concrete types, see `m_selection_cache_enabled`)
+    mutable ::std::map< selection_key_t, SelectionCacheEnt >   m_selection_cache;
+    /// Value of `HIR::Crate::m_impl_generation` when the cache was last valid
+    mutable unsigned    m_selection_cache_generation = 0;
+    /// Number of entries currently in use (being filled or replayed)
+    mutable unsigned    m_selection_cache_active = 0;
+    mutable unsigned    m_selection_cache_hits = 0;
+    mutable unsigned    m_selection_cache_misses = 0;
+    bool    m_selection_cache_enabled = true;
+
 public:
     explicit StaticTraitResolve(const ::HIR::Crate& crate):
         TraitResolveCommon(crate)
@@ -55,7 +79,9 @@ private:
         m_drop_cache.clear();
         m_aty_cache.clear();
         TraitResolveCommon::prep_indexes(Span());
+        update_selection_cache_enabled();
     }
+    void update_selection_cache_enabled();
 public:
 
     /// \brief State manipulation
@@ -125,9 +151,26 @@ public:
         m_item_generics = nullptr;
         prep_indexes();
     }
+
+    /// Snapshot of the current generic scope, used to replay it on another resolver (e.g. on a worker thread)
+    struct GenericsState {
+        MetadataType    self_metadata;
+        const ::HIR::GenericParams* impl_generics;
+        const ::HIR::GenericParams* item_generics;
+    };
+    GenericsState get_generics_state() const {
+        return GenericsState { m_self_metadata, m_impl_generics, m_item_generics };
+    }
+    void set_generics_state(const GenericsState& s) {
+        m_self_metadata = s.self_metadata;
+        m_impl_generics = s.impl_generics;
+        m_item_generics = s.item_generics;
+        prep_indexes();
+    }
     // Used by ResolveUFCS to regenerate
     void prep_indexes(const Span& sp) {
         TraitResolveCommon::prep_indexes(sp);
+        update_selection_cache_enabled();
     }
     /// \}
 
@@ -153,6 +196,13 @@ public:
         ) const;
 
 private:
+    bool find_impl__uncached(
+        const Span& sp,
+        const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
+        const ::HIR::TypeRef& type,
+        t_cb_find_impl found_cb,
+        bool dont_handoff_to_specialised
+        ) const;
     bool find_impl__bounds(
         const Span& sp,
         const ::HIR::SimplePath& trait_path, const ::HIR::PathParams* trait_params,
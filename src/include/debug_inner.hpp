@@ -3,6 +3,7 @@
 #pragma once
 #include <ctime>
 #include <initializer_list>
+#include "self_profile.hpp"
 
 extern void debug_init_phases(const char* env_var_name, std::initializer_list<const char*> il);
 
@@ -10,6 +11,7 @@ class DebugTimedPhase
 {
     const char* m_name;
     clock_t m_start;
+    ProfileScope    m_profile;
 public:
     DebugTimedPhase(const char* name);
     ~DebugTimedPhase();
@@ -0,0 +1,113 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/mmir_binary.hpp
+ * - Binary encoding of monomorphised MIR (written by the `monomir` backend, read by standalone_miri)
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/// File layout:
+/// - `MAGIC`, then the (little-endian u64) offset of the trailer
+/// - Item records (types, statics, and functions), in the order they were emitted
+/// - Trailer:
+///   - String table: `count`, then `len` + bytes for each string (paths, names)
+///   - Type table: `count`, then each type (see `TypeTag`, which can only refer to earlier types)
+///   - Crates: `count`, then a string index for each dependency's `.mir` file
+///   - Item index: `count`, then `ItemType` (u8) + record offset for each item
+///
+/// All integers (except the header) are unsigned LEB128, strings/types are referred to by index into the tables.
+/// Function records hold the signature followed by the body, so a reader can decode the signature up front and leave
+/// the (much larger) body until the function is first used.
+///
+/// MIR enums are stored using their `TAGGED_UNION` tag numbers, as both sides are built from `mir/mir.hpp`.
+namespace MmirBinary
+{
+    static const char MAGIC[8] = { 'M','M','I','R','B','I','N','1' };
+    static const size_t HEADER_SIZE = 8 + 8;
+
+    enum class ItemType : uint8_t
+    {
+        /// name, size, align, drop glue (string index + 1), DST metadata (type index + 1), fields, variants
+        Type,
+        /// name, type, bytes, relocations
+        Static,
+        /// name, arguments, return type, flags (see `FunctionFlags`), [link name, abi], [body]
+        Function,
+    };
+    enum FunctionFlags : uint8_t
+    {
+        FUNCTION_HAS_BODY = 1 << 0,
+        FUNCTION_IS_EXTERN = 1 << 1,
+        FUNCTION_IS_VARIADIC = 1 << 2,
+    };
+
+    enum class TypeTag : uint8_t
+    {
+        Unit,
+        Diverge,
+        /// `Primitive` (u8)
+        Primitive,
+        /// Mangled path
+        Composite,
+        /// Mangled path of the trait (used for the vtable type)
+        TraitObject,
+        /// size, inner
+        Array,
+        /// inner
+        Slice,
+        /// borrow type (u8), inner
+        Borrow,
+        /// borrow type (u8), inner
+        Pointer,
+        /// flags (u8: 1 = unsafe, 2 = variadic), abi, argument count, arguments, return type
+        Function,
+    };
+    /// Primitive types (in the same order as `HIR::CoreType`)
+    enum class Primitive : uint8_t
+    {
+        Usize, Isize,
+        U8, I8,
+        U16, I16,
+        U32, I32,
+        U64, I64,
+        U128, I128,
+        F32, F64,
+        Bool,
+        Char, Str,
+    };
+
+    static inline void write_uint(::std::string& out, uint64_t v)
+    {
+        do {
+            uint8_t b = v & 0x7F;
+            v >>= 7;
+            out.push_back(static_cast<char>(v ? (b | 0x80) : b));
+        } while(v);
+    }
+    /// Returns false if the value runs off the end of the buffer
+    static inline bool read_uint(const uint8_t*& p, const uint8_t* end, uint64_t& out)
+    {
+        out = 0;
+        for(unsigned shift = 0; p != end && shift < 64; shift += 7)
+        {
+            uint8_t b = *p++;
+            out |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if( !(b & 0x80) )
+                return true;
+        }
+        return false;
+    }
+    /// Signed integers are zig-zag encoded (so small negative values stay small)
+    static inline void write_sint(::std::string& out, int64_t v)
+    {
+        write_uint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+    static inline int64_t decode_sint(uint64_t v)
+    {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+}
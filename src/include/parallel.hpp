@@ -0,0 +1,75 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/parallel.hpp
+ * - Helper for running independent jobs on a pool of worker threads
+ */
+#pragma once
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/// Lock held while populating lazily-computed state stored in the shared (otherwise read-only) HIR
+/// - E.g. on-demand constant evaluation and MIR generation, and type layouts
+/// - Recursive, as populating one item often requires populating others
+inline ::std::recursive_mutex& lazy_state_lock()
+{
+    static ::std::recursive_mutex   lock;
+    return lock;
+}
+
+/// Run `cb(worker_idx, job_idx)` for every job index in `0 .. job_count`
+///
+/// - Jobs are handed out in index order to `num_threads` workers (worker 0 is the calling thread)
+/// - `worker_idx` is stable for the lifetime of a worker, so can be used to index per-thread state
+/// - The first exception thrown by a job is re-thrown on the calling thread once all workers have stopped
+template<typename Fcn>
+void parallel_for_each_index(unsigned num_threads, size_t job_count, Fcn cb)
+{
+    num_threads = static_cast<unsigned>( ::std::min<size_t>(num_threads, job_count) );
+    if( num_threads <= 1 )
+    {
+        for(size_t i = 0; i < job_count; i ++)
+            cb(0u, i);
+        return ;
+    }
+
+    ::std::atomic<size_t>   next_job { 0 };
+    ::std::atomic<bool> failed { false };
+    ::std::exception_ptr    first_error;
+    ::std::mutex    error_lock;
+    auto worker = [&](unsigned worker_idx) {
+        try
+        {
+            while( !failed )
+            {
+                size_t i = next_job ++;
+                if( i >= job_count )
+                    break;
+                cb(worker_idx, i);
+            }
+        }
+        catch(...)
+        {
+            ::std::lock_guard<::std::mutex>   lh { error_lock };
+            if( !first_error )
+                first_error = ::std::current_exception();
+            failed = true;
+        }
+        };
+
+    ::std::vector<::std::thread>    workers;
+    workers.reserve(num_threads - 1);
+    for(unsigned i = 1; i < num_threads; i ++)
+        workers.push_back(::std::thread(worker, i));
+    worker(0);
+    for(auto& t : workers)
+        t.join();
+
+    if( first_error )
+        ::std::rethrow_exception(first_error);
+}
@@ -9,14 +9,17 @@
 
 #include <cstring>
 #include <ostream>
+#include <atomic>
 #include "../common.hpp"
 
 class RcString
 {
     struct Inner {
-        unsigned int    refcount;
+        ::std::atomic<unsigned int> refcount;   // Atomic, as strings are shared between worker threads
         unsigned int    size;
-        unsigned int    ordering;   // Populated only for interned strings, 0 otherwise
+        // Populated only for interned strings, 0 otherwise
+        // - Atomic as it's renumbered when new strings are interned (which can happen on worker threads)
+        ::std::atomic<unsigned int> ordering;
         unsigned int    data[1];    // Actually arbitary
     }*  m_ptr;
 public:
@@ -78,7 +81,7 @@ public:
     const char* begin() const { return c_str(); }
     const char* end() const { return c_str() + size(); }
 
-    bool is_interned() const { return m_ptr && m_ptr->ordering != 0; }
+    bool is_interned() const { return m_ptr && m_ptr->ordering.load(::std::memory_order_relaxed) != 0; }
     size_t size() const { return m_ptr ? m_ptr->size : 0; }
     const char* c_str() const {
         if( m_ptr )
@@ -0,0 +1,52 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * include/self_profile.hpp
+ * - Opt-in compile-time profiler (`--self-profile <file>`)
+ */
+#pragma once
+#include <string>
+#include <sstream>
+#include <cstdint>
+
+/// Set once profiling has been started (checked before doing any profiling work)
+extern bool g_self_profile_enabled;
+
+/// Start recording, the results are written to `outfile` (Chrome trace-event JSON) at exit
+extern void SelfProfile_Start(const ::std::string& outfile);
+/// Write the trace file and print a summary of the most expensive phases/items
+/// - Called automatically at exit, safe to call more than once
+extern void SelfProfile_Finish();
+
+/// Records the time spent (and allocations made) between construction and destruction
+class ProfileScope
+{
+    bool    m_active;
+    bool    m_is_phase;
+    const char* m_category;
+    ::std::string   m_name;
+    uint64_t    m_start_wall_us;
+    uint64_t    m_start_cpu_us;
+    uint64_t    m_start_allocs;
+public:
+    /// A top-level compiler phase (uses whole-process CPU time and allocation counts)
+    explicit ProfileScope(const char* phase_name);
+    /// An item (e.g. a function) within a phase, counted against the current thread
+    /// - `name_cb` is only called if profiling is enabled
+    template<typename Fcn>
+    ProfileScope(const char* category, Fcn name_cb):
+        m_active(false)
+    {
+        if( g_self_profile_enabled ) {
+            start(category, name_cb(), false);
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ~ProfileScope();
+private:
+    void start(const char* category, ::std::string name, bool is_phase);
+};
+
+/// Profile the rest of the current block as an item (e.g. `PROFILE_ITEM("MIR Optimise", path);`)
+#define PROFILE_ITEM(category, ss)  ProfileScope _profile_item_(category, [&]()->::std::string { ::std::ostringstream __os; __os << ss; return __os.str(); })
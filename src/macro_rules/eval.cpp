@@ -1996,10 +1996,37 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
     TRACE_FUNCTION_F(rules.m_rules.size() << " options");
     ASSERT_BUG(sp, rules.m_rules.size() > 0, "Empty macro_rules set");
 
+    // Leading tokens of the input, compared against each arm's literal prefix to skip arms that can't match
+    ::std::vector<const Token*> input_prefix;
+    {
+        size_t  max_prefix = 0;
+        for(const auto& arm : rules.m_rules)
+            max_prefix = ::std::max(max_prefix, arm.m_literal_prefix.size());
+        auto lex = TokenStreamRO(input);
+        while( input_prefix.size() < max_prefix )
+        {
+            input_prefix.push_back( &lex.next_tok() );
+            if( lex.next() == TOK_EOF )
+                break;
+            lex.consume();
+        }
+    }
+    size_t  n_skipped = 0;
+
     ::std::vector< ::std::pair<size_t, ::std::vector<bool>> >    matches;
     ::std::vector< std::pair<size_t, eTokenType> >  fail_pos;
     for(size_t i = 0; i < rules.m_rules.size(); i ++)
     {
+        // NOTE: `input_prefix` only stops short at EOF, which a longer arm prefix can never match - so the common length is enough
+        const auto& arm_prefix = rules.m_rules[i].m_literal_prefix;
+        size_t n_check = ::std::min(arm_prefix.size(), input_prefix.size());
+        if( !::std::equal(arm_prefix.begin(), arm_prefix.begin() + n_check, input_prefix.begin(), [](const Token& a, const Token* b){ return a == *b; }) )
+        {
+            DEBUG(i << " SKIPPED (literal prefix)");
+            n_skipped ++;
+            continue ;
+        }
+
         auto lex = TokenStreamRO(input);
         auto arm_stream = MacroPatternStream(rules.m_rules[i].m_pattern);
 
@@ -2077,6 +2104,8 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
         {
             matches.push_back( ::std::make_pair(i, arm_stream.take_history()) );
             DEBUG(i << " MATCHED");
+            // The first matching arm is always the one used, so there's no need to check the rest
+            break;
         }
         else
         {
@@ -2085,6 +2114,8 @@ unsigned int Macro_InvokeRules_MatchPattern(const Span& sp, const MacroRules& ru
         }
     }
 
+    DEBUG(n_skipped << "/" << rules.m_rules.size() << " arms skipped by literal prefix");
+
     if( matches.size() == 0 )
     {
         // ERROR!
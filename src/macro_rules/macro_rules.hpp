@@ -168,17 +168,27 @@ struct MacroRulesArm
     /// Rule contents
     ::std::vector<MacroExpansionEnt> m_contents;
 
+    /// Literal tokens that must start the input for this arm to match (derived from `m_pattern`, not serialised)
+    /// - Ends with `TOK_EOF` if the pattern is entirely literal
+    /// - Used to skip arms without running the full pattern matcher
+    ::std::vector<Token>    m_literal_prefix;
+
     ~MacroRulesArm();
     MacroRulesArm()
     {}
     MacroRulesArm(::std::vector<SimplePatEnt> pattern, ::std::vector<MacroExpansionEnt> contents):
         m_pattern( mv$(pattern) ),
         m_contents( mv$(contents) )
-    {}
+    {
+        update_literal_prefix();
+    }
     MacroRulesArm(const MacroRulesArm&) = delete;
     MacroRulesArm& operator=(const MacroRulesArm&) = delete;
     MacroRulesArm(MacroRulesArm&&) = default;
     MacroRulesArm& operator=(MacroRulesArm&&) = default;
+
+    /// Re-calculate `m_literal_prefix` from `m_pattern`
+    void update_literal_prefix();
 };
 
 /// A sigle 'macro_rules!' block
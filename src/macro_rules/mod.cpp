@@ -294,4 +294,21 @@ MacroRules::~MacroRules()
 MacroRulesArm::~MacroRulesArm()
 {
 }
+void MacroRulesArm::update_literal_prefix()
+{
+    m_literal_prefix.clear();
+    for(const auto& ent : m_pattern)
+    {
+        if( const auto* e = ent.opt_ExpectTok() ) {
+            m_literal_prefix.push_back( e->clone() );
+        }
+        else if( ent.is_End() ) {
+            m_literal_prefix.push_back( Token(TOK_EOF) );
+            break;
+        }
+        else {
+            break;
+        }
+    }
+}
 
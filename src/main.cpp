@@ -96,10 +96,27 @@ struct ProgramParams
         bool dump_hir = false;
         bool dump_mir = false;
     } debug;
+    /// Number of worker threads used by passes that support running in parallel (`-Z threads=N`)
+    unsigned num_threads = 1;
+    /// Output file for `--self-profile` (empty if not profiling)
+    ::std::string   self_profile_file;
     struct {
         ::std::string   codegen_type;
         ::std::string   emit_build_command;
         ::std::string   panic_type;
+        /// `-C unwind` - How panics unwind the stack in the C backend (`setjmp` or `tables`)
+        ::std::string   unwind_type;
+        unsigned    codegen_units = 1;
+        /// `-C lto` - Link-time optimisation across crates (using the C compiler's LTO)
+        bool    lto = false;
+        /// `-C profile-generate=<dir>` - Instrument the generated code, writing profiles to `<dir>`
+        ::std::string   profile_generate;
+        /// `-C profile-use=<dir>` - Optimise using the profiles in `<dir>`
+        ::std::string   profile_use;
+        /// `-Z share-generics` - Off by default
+        bool share_generics = false;
+        /// `-Z c-annotations` - Off by default
+        bool c_annotations = false;
     } codegen;
 
     ProgramParams(int argc, char *argv[]);
@@ -245,6 +262,10 @@ int main(int argc, char *argv[])
     init_debug_list();
     ProgramParams   params(argc, argv);
 
+    if( params.self_profile_file != "" ) {
+        SelfProfile_Start(params.self_profile_file);
+    }
+
     if(params.debug.pause) {
         char c;
         ::std::cerr << "Pausing to attach a debugger\nType any text to continue" << std::endl;
@@ -668,7 +689,7 @@ int main(int argc, char *argv[])
             });
         // Check the rest of the expressions (including function bodies)
         CompilePhaseV("Typecheck Expressions", [&]() {
-            Typecheck_Expressions(*hir_crate);
+            Typecheck_Expressions(*hir_crate, params.num_threads);
             });
         // === HIR Expansion ===
         // Annotate how each node's result is used
@@ -731,7 +752,7 @@ int main(int argc, char *argv[])
 
         // Lower expressions into MIR
         CompilePhaseV("Lower MIR", [&]() {
-            HIR_GenerateMIR(*hir_crate);
+            HIR_GenerateMIR(*hir_crate, params.codegen.unwind_type == "tables");
             });
 
         if( params.debug.dump_mir )
@@ -770,7 +791,7 @@ int main(int argc, char *argv[])
 
         // Optimise the MIR
         CompilePhaseV("MIR Optimise", [&]() {
-            MIR_OptimiseCrate(*hir_crate, params.debug.disable_mir_optimisations);
+            MIR_OptimiseCrate(*hir_crate, params.debug.disable_mir_optimisations, params.num_threads);
             });
 
         if( params.debug.dump_mir )
@@ -803,8 +824,14 @@ int main(int argc, char *argv[])
         TransOptions    trans_opt;
         trans_opt.mode = params.codegen.codegen_type == "" ? "c" : params.codegen.codegen_type;
         trans_opt.build_command_file = params.codegen.emit_build_command;
+        trans_opt.codegen_units = params.codegen.codegen_units;
         trans_opt.opt_level = params.opt_level;
         trans_opt.panic_crate = params.codegen.panic_type == "" ? "panic_abort" : "panic_"+params.codegen.panic_type;
+        trans_opt.unwind_tables = params.codegen.unwind_type == "tables";
+        trans_opt.lto = params.codegen.lto;
+        trans_opt.profile_generate = params.codegen.profile_generate;
+        trans_opt.profile_use = params.codegen.profile_use;
+        trans_opt.c_annotations = params.codegen.c_annotations;
         for(const char* libdir : params.lib_search_dirs ) {
             // Store these paths for use in final linking.
             hir_crate->m_link_paths.push_back( libdir );
@@ -813,6 +840,10 @@ int main(int argc, char *argv[])
             hir_crate->m_ext_libs.push_back(::HIR::ExternLibrary { libname });
         }
         trans_opt.emit_debug_info = params.emit_debug_info;
+        // Weak symbols are needed for sibling crates that share the same instance, and sharing blocks inlining by the C compiler
+        trans_opt.share_generics = params.codegen.share_generics
+            && trans_opt.mode == "c"
+            && Target_GetCurSpec().m_backend_c.m_codegen_mode == CodegenMode::Gnu11;
 
         // Generate code for non-generic public items (if requested)
         if( params.test_harness )
@@ -869,7 +900,7 @@ int main(int argc, char *argv[])
         // - Generate monomorphised versions of all functions
         CompilePhaseV("Trans Monomorph", [&]() { Trans_Monomorphise_List(*hir_crate, items); });
         // - Do post-monomorph inlining
-        CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items, false); });
+        CompilePhaseV("MIR Optimise Inline", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items, false, params.num_threads); });
 
         memory_dump("Trans");
 
@@ -877,11 +908,16 @@ int main(int argc, char *argv[])
         switch(crate_type)
         {
         case ::AST::Crate::Type::RustLib:
+            if( trans_opt.share_generics ) {
+                Trans_Enumerate_RecordSharedInstances(*hir_crate, items);
+            }
+            Target_ExportTypeLayouts(*hir_crate);
             // Save a loadable HIR dump
             hir_file = params.outfile + ".hir";
             CompilePhaseV("HIR Serialise", [&]() { HIR_Serialise(hir_file, *hir_crate); });
             break;
         case ::AST::Crate::Type::RustDylib:
+            Target_ExportTypeLayouts(*hir_crate);
             // Save a loadable HIR dump
             CompilePhaseV("HIR Serialise", [&]() {
                 //auto saved_ext_crates = ::std::move(hir_crate->m_ext_crates);
@@ -895,7 +931,7 @@ int main(int argc, char *argv[])
 
 
         // - Do post-monomorph inlining
-        CompilePhaseV("MIR Optimise Inline PostSave", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items, true); });
+        CompilePhaseV("MIR Optimise Inline PostSave", [&]() { MIR_OptimiseCrate_Inlining(*hir_crate, items, true, params.num_threads); });
         // - Clean up ununused functions
         CompilePhaseV("Trans Enumerate Cleanup", [&]() { Trans_Enumerate_Cleanup(*hir_crate, items); });
 
@@ -1094,6 +1130,47 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     get_optval();
                     this->codegen.panic_type = optval;
                 }
+                else if( optname == "unwind" ) {
+                    get_optval();
+                    if( optval != "setjmp" && optval != "tables" ) {
+                        ::std::cerr << "Invalid value for -C unwind - '" << optval << "' (expected `setjmp` or `tables`)" << ::std::endl;
+                        exit(1);
+                    }
+                    this->codegen.unwind_type = optval;
+                }
+                else if( optname == "codegen-units" ) {
+                    get_optval();
+                    char* end;
+                    auto v = ::std::strtoul(optval.c_str(), &end, 10);
+                    if( *end != '\0' || v == 0 ) {
+                        ::std::cerr << "Invalid value for -C codegen-units - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                    this->codegen.codegen_units = v;
+                }
+                else if( optname == "profile-generate" || optname == "profile-use" ) {
+                    get_optval();
+                    if( optval == "" ) {
+                        ::std::cerr << "Invalid value for -C " << optname << " - expected a directory" << ::std::endl;
+                        exit(1);
+                    }
+                    (optname == "profile-generate" ? this->codegen.profile_generate : this->codegen.profile_use) = optval;
+                    if( this->codegen.profile_generate != "" && this->codegen.profile_use != "" ) {
+                        ::std::cerr << "-C profile-generate and -C profile-use can't be used together" << ::std::endl;
+                        exit(1);
+                    }
+                }
+                else if( optname == "lto" ) {
+                    // NOTE: `thin` is accepted for compatibility, the C compiler decides how to partition
+                    if( eq_pos == ::std::string::npos || optval == "yes" || optval == "on" || optval == "true" || optval == "fat" || optval == "thin" )
+                        this->codegen.lto = true;
+                    else if( optval == "no" || optval == "off" || optval == "false" )
+                        this->codegen.lto = false;
+                    else {
+                        ::std::cerr << "Invalid value for -C lto - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                }
                 else {
                     ::std::cerr << "Unknown codegen option: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -1182,6 +1259,38 @@ ProgramParams::ProgramParams(int argc, char *argv[])
                     no_optval();
                     this->run_borrowcheck = true;
                 }
+                else if( optname == "threads" ) {
+                    get_optval();
+                    char* end;
+                    auto v = ::std::strtoul(optval.c_str(), &end, 10);
+                    if( *end != '\0' || v == 0 ) {
+                        ::std::cerr << "Invalid value for -Z threads - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                    this->num_threads = v;
+                }
+                else if( optname == "share-generics" ) {
+                    get_optval();
+                    if( optval == "yes" )
+                        this->codegen.share_generics = true;
+                    else if( optval == "no" )
+                        this->codegen.share_generics = false;
+                    else {
+                        ::std::cerr << "Invalid value for -Z share-generics - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                }
+                else if( optname == "c-annotations" ) {
+                    get_optval();
+                    if( optval == "yes" )
+                        this->codegen.c_annotations = true;
+                    else if( optval == "no" )
+                        this->codegen.c_annotations = false;
+                    else {
+                        ::std::cerr << "Invalid value for -Z c-annotations - '" << optval << "'" << ::std::endl;
+                        exit(1);
+                    }
+                }
                 else {
                     ::std::cerr << "Unknown -Z flag: '" << optname << "'" << ::std::endl;
                     exit(1);
@@ -1348,6 +1457,10 @@ ProgramParams::ProgramParams(int argc, char *argv[])
             else if( strcmp(arg, "--test") == 0 ) {
                 this->test_harness = true;
             }
+            // `--self-profile <file>`  - Record per-phase and per-item timings, written as Chrome trace-event JSON
+            else if( const char* profile_file = check_with_arg("self-profile") ) {
+                this->self_profile_file = profile_file;
+            }
             else if( const char* edition_str = check_with_arg("edition") ) {
                 if( strcmp(edition_str, "2015") == 0 ) {
                     this->edition = AST::Edition::Rust2015;
@@ -1427,6 +1540,8 @@ void ProgramParams::show_help() const
         "--cfg flag=\"val\"   : Set a string #[cfg]/cfg! flag\n"
         "--target <name>    : Compile code for the given target\n"
         "--test             : Generate a unit test executable\n"
+        "--self-profile <file>\n"
+        "                   : Write per-phase/per-item timings to <file> (Chrome trace-event JSON)\n"
         "-C <option>        : Code-generation options\n"
         "-Z <option>        : Debugging/experimental options\n"
         ;
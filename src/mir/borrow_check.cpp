@@ -489,6 +489,171 @@ namespace {
     };
 }
 
+namespace {
+    /// A borrow of a local/argument, stored (directly or as part of a larger value) in a local
+    struct Loan
+    {
+        ::MIR::BasicBlockId bb;
+        unsigned    stmt;
+        const ::MIR::LValue*    lv;
+        /// Local that holds the borrow (the borrow is live while this local is)
+        unsigned    holder;
+        bool    is_unique;
+    };
+
+    /// Forward "may be borrowed" dataflow over all borrows in the function, checking that no borrowed value is moved or
+    /// overwritten while the local holding the borrow is still live.
+    ///
+    /// Holders are only live until their last use (drops of borrows are ignored, they're no-ops)
+    void BorrowCheck_Loans(::MIR::TypeResolve& state, const ::MIR::Function& fcn)
+    {
+        namespace df = ::MIR::dataflow;
+        using ::MIR::visit::ValUsage;
+        typedef ::std::function<void(::std::function<bool(const ::MIR::LValue&, ValUsage)>)>  visit_t;
+
+        // - Enumerate loans
+        ::std::vector<Loan> loans;
+        for(size_t bb_idx = 0; bb_idx < fcn.blocks.size(); bb_idx ++)
+        {
+            const auto& bb = fcn.blocks[bb_idx];
+            for(size_t stmt_idx = 0; stmt_idx < bb.statements.size(); stmt_idx ++)
+            {
+                const auto* se = bb.statements[stmt_idx].opt_Assign();
+                if( !se || !se->src.is_Borrow() || !se->dst.m_root.is_Local() )
+                    continue ;
+                const auto& src = se->src.as_Borrow();
+                // Borrows through a pointer don't borrow the local itself
+                if( ::std::any_of(src.val.m_wrappers.begin(), src.val.m_wrappers.end(), [](const ::MIR::LValue::Wrapper& w){ return w.is_Deref(); }) )
+                    continue ;
+                if( !src.val.m_root.is_Local() && !src.val.m_root.is_Argument() )
+                    continue ;
+                loans.push_back(Loan { static_cast<::MIR::BasicBlockId>(bb_idx), static_cast<unsigned>(stmt_idx), &src.val, se->dst.m_root.as_Local(), src.type != ::HIR::BorrowType::Shared });
+            }
+        }
+        if( loans.empty() )
+            return ;
+        DEBUG(loans.size() << " loans");
+
+        // Loans held by each local (killed when that local is overwritten)
+        ::std::vector<::MIR::BitSet>    loans_by_holder(fcn.locals.size(), ::MIR::BitSet(loans.size()));
+        for(size_t i = 0; i < loans.size(); i ++)
+            loans_by_holder[loans[i].holder].set(i);
+
+        // Apply the effect of a statement/terminator (with `loan_idx` being the first loan in this block at/after the
+        // statement)
+        auto apply = [&](::MIR::BitSet& live_loans, size_t& loan_idx, ::MIR::BasicBlockId bb_idx, unsigned stmt_idx, visit_t visit) {
+            visit([&](const ::MIR::LValue& lv, ValUsage vu) {
+                if( vu == ValUsage::Write && lv.m_wrappers.empty() && lv.m_root.is_Local() )
+                    live_loans.subtract(loans_by_holder[lv.m_root.as_Local()]);
+                return false;
+                });
+            for(; loan_idx < loans.size() && loans[loan_idx].bb == bb_idx && loans[loan_idx].stmt == stmt_idx; loan_idx ++)
+                live_loans.set(loan_idx);
+            };
+        auto first_loan = [&](::MIR::BasicBlockId bb_idx)->size_t {
+            return ::std::lower_bound(loans.begin(), loans.end(), bb_idx, [](const Loan& l, ::MIR::BasicBlockId b){ return l.bb < b; }) - loans.begin();
+            };
+
+        // - Liveness of the locals (for holders)
+        auto add_liveness = [&](df::GenKill& gk, visit_t visit) {
+            // Definitions first, then uses (as operands are read before the destination is written)
+            visit([&](const ::MIR::LValue& lv, ValUsage vu) {
+                if( vu == ValUsage::Write && lv.m_wrappers.empty() && lv.m_root.is_Local() )
+                    gk.add_kill(lv.m_root.as_Local());
+                return false;
+                });
+            visit([&](const ::MIR::LValue& lv, ValUsage vu) {
+                for(const auto& w : lv.m_wrappers)
+                    if( w.is_Index() )
+                        gk.add_gen(w.as_Index());
+                if( lv.m_root.is_Local() && !(vu == ValUsage::Write && lv.m_wrappers.empty()) )
+                    gk.add_gen(lv.m_root.as_Local());
+                return false;
+                });
+            };
+        auto add_stmt_liveness = [&](df::GenKill& gk, const ::MIR::BasicBlock& bb, size_t stmt_idx) {
+            if( stmt_idx == bb.statements.size() )
+                add_liveness(gk, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.terminator, cb); });
+            else if( !bb.statements[stmt_idx].is_Drop() )
+                add_liveness(gk, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.statements[stmt_idx], cb); });
+            };
+        df::Cfg cfg(fcn);
+        ::std::vector<df::GenKill>  live_effects(fcn.blocks.size(), df::GenKill(fcn.locals.size()));
+        for(size_t bb_idx = 0; bb_idx < fcn.blocks.size(); bb_idx ++)
+        {
+            const auto& bb = fcn.blocks[bb_idx];
+            for(size_t i = bb.statements.size() + 1; i --; )
+                add_stmt_liveness(live_effects[bb_idx], bb, i);
+        }
+        auto live_out = df::solve(cfg, df::Direction::Backward, df::Join::Union, ::MIR::BitSet(fcn.locals.size()), live_effects);
+
+        auto entry_states = df::solve(cfg, df::Direction::Forward, df::Join::Union, ::MIR::BitSet(loans.size()),
+            [&](::MIR::BasicBlockId bb_idx, ::MIR::BitSet& s) {
+                const auto& bb = fcn.blocks[bb_idx];
+                auto loan_idx = first_loan(bb_idx);
+                for(size_t i = 0; i < bb.statements.size(); i ++)
+                    apply(s, loan_idx, bb_idx, i, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.statements[i], cb); });
+                apply(s, loan_idx, bb_idx, bb.statements.size(), [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.terminator, cb); });
+            });
+
+        // - Check each access against the loans live before it
+        for(auto bb_idx : cfg.rpo)
+        {
+            const auto& bb = fcn.blocks[bb_idx];
+            // Locals live before each statement
+            ::std::vector<::MIR::BitSet>    live_locals(bb.statements.size() + 1);
+            {
+                auto s = live_out[bb_idx];
+                for(size_t i = bb.statements.size() + 1; i --; )
+                {
+                    df::GenKill gk(fcn.locals.size());
+                    add_stmt_liveness(gk, bb, i);
+                    gk.apply(s);
+                    live_locals[i] = s;
+                }
+            }
+            auto live_loans = entry_states[bb_idx];
+            auto loan_idx = first_loan(bb_idx);
+            auto check = [&](unsigned stmt_idx, const ::MIR::LValue* skip, visit_t visit) {
+                visit([&](const ::MIR::LValue& lv, ValUsage vu) {
+                    if( vu == ValUsage::Read || vu == ValUsage::Borrow )
+                        return false;
+                    if( &lv == skip )
+                        return false;
+                    if( vu == ValUsage::Move && state.lvalue_is_copy(lv) )
+                        return false;
+                    live_loans.for_each_set([&](size_t i) {
+                        const auto& l = loans[i];
+                        if( !lv.is_either_subset(*l.lv) )
+                            return ;
+                        if( !live_locals[stmt_idx].get(l.holder) )
+                            return ;
+                        MIR_BUG(state, "Borrow check failure: " << (vu == ValUsage::Move ? "Move" : "Write") << " of " << lv
+                            << " while borrowed (" << (l.is_unique ? "&mut " : "&") << *l.lv << " at BB" << l.bb << "/" << l.stmt
+                            << ", held in _" << l.holder << ")");
+                        });
+                    return false;
+                    });
+                apply(live_loans, loan_idx, bb_idx, stmt_idx, visit);
+                };
+            for(size_t i = 0; i < bb.statements.size(); i ++)
+            {
+                // NOTE: Drops are checked by the value state validation
+                if( bb.statements[i].is_Drop() ) {
+                    apply(live_loans, loan_idx, bb_idx, i, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.statements[i], cb); });
+                    continue ;
+                }
+                state.set_cur_stmt(bb_idx, i);
+                check(i, nullptr, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.statements[i], cb); });
+            }
+            state.set_cur_stmt_term(bb_idx);
+            // NOTE: A call's return value is written after the call returns (so after any borrows passed to it end)
+            const auto* ret_val = bb.terminator.is_Call() ? &bb.terminator.as_Call().ret_val : nullptr;
+            check(bb.statements.size(), ret_val, [&](auto cb){ ::MIR::visit::visit_mir_lvalues(bb.terminator, cb); });
+        }
+    }
+}
+
 void MIR_BorrowCheck(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path, ::MIR::Function& fcn, const ::HIR::Function::args_t& args, const ::HIR::TypeRef& ret_type)
 {
     static Span sp;
@@ -778,15 +943,10 @@ void MIR_BorrowCheck(const StaticTraitResolve& resolve, const ::HIR::ItemPath& p
         }
     }
 
-    auto val_states = FcnState(args.size(), fcn.locals.size());
-
     // 1. Determine the lifetime (scope) of each variable (from assignment to last use)
-    // - Needs to represent disjoint lifetimes (i.e. same variable assigned multiple times)
-    // - Walk the graph, finding assignments of locals and tracking last use until next assignment
-    //   > At next assignment (or drop/move), record that lifetime span (as start,path,end)
-
-    // 2. Run full state tracking, including tracking of borrow sources.
-    // TODO: Figure out the rest
+    // 2. Check that borrowed values aren't moved or overwritten while the borrow is held
+    // TODO: Track borrows that are copied/reborrowed into other slots, and check the lifetime ivars
+    BorrowCheck_Loans(state, fcn);
 }
 
 void MIR_BorrowCheck_Crate(::HIR::Crate& crate)
@@ -0,0 +1,62 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * mir/dataflow.cpp
+ * - Worklist dataflow solver over dense bitsets
+ */
+#include "dataflow.hpp"
+#include "mir.hpp"
+#include <mir/helpers.hpp>
+#include <algorithm>
+
+::MIR::dataflow::Cfg::Cfg(const ::MIR::Function& fcn):
+    rpo_index(fcn.blocks.size(), ~0u),
+    successors(fcn.blocks.size()),
+    predecessors(fcn.blocks.size())
+{
+    for(size_t bb_idx = 0; bb_idx < fcn.blocks.size(); bb_idx ++)
+    {
+        auto& succ = successors[bb_idx];
+        ::MIR::visit::visit_terminator_target(fcn.blocks[bb_idx].terminator, [&](const ::MIR::BasicBlockId& tgt) {
+            succ.push_back(tgt);
+            });
+        // Dedup (e.g. a `Switch` with several arms going to the same block)
+        ::std::sort(succ.begin(), succ.end());
+        succ.erase(::std::unique(succ.begin(), succ.end()), succ.end());
+        for(auto tgt : succ)
+            predecessors.at(tgt).push_back(bb_idx);
+    }
+
+    if( fcn.blocks.empty() )
+        return ;
+
+    // Post-order DFS from BB0 (iterative, as functions can have very long chains of blocks)
+    ::std::vector<BasicBlockId> post_order;
+    post_order.reserve(fcn.blocks.size());
+    ::std::vector<bool> visited(fcn.blocks.size());
+    ::std::vector<::std::pair<BasicBlockId, size_t>>  stack;
+    stack.push_back(::std::make_pair(0, 0));
+    visited[0] = true;
+    while( !stack.empty() )
+    {
+        auto& top = stack.back();
+        const auto& succ = successors[top.first];
+        if( top.second < succ.size() )
+        {
+            auto next = succ[top.second++];
+            if( !visited[next] ) {
+                visited[next] = true;
+                stack.push_back(::std::make_pair(next, 0));
+            }
+        }
+        else
+        {
+            post_order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    rpo.assign(post_order.rbegin(), post_order.rend());
+    for(size_t i = 0; i < rpo.size(); i ++)
+        rpo_index[rpo[i]] = i;
+}
@@ -0,0 +1,338 @@
+/*
+ * MRustC - Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * mir/dataflow.hpp
+ * - Worklist dataflow solver over dense bitsets (used for liveness, validation, and borrow checking)
+ */
+#pragma once
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+
+namespace MIR {
+
+class Function;
+typedef unsigned int    BasicBlockId;
+
+/// Fixed-size dense bit set
+class BitSet
+{
+    size_t  m_size;
+    ::std::vector<uint64_t> m_words;
+
+    static size_t word_count(size_t n) { return (n + 63) / 64; }
+    /// Call `cb(word, mask)` for each word overlapping `[first, last)`, stopping early if it returns false
+    template<typename Words, typename Cb>
+    static bool for_range_words(Words& words, size_t first, size_t last, Cb cb) {
+        while( first < last )
+        {
+            size_t  wi = first / 64;
+            size_t  end = ::std::min(last, (wi + 1) * 64);
+            size_t  n = end - first;
+            uint64_t mask = (n == 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1)) << (first % 64);
+            if( !cb(words[wi], mask) )
+                return false;
+            first = end;
+        }
+        return true;
+    }
+    void clear_tail() {
+        if( m_size % 64 != 0 )
+            m_words.back() &= (uint64_t(1) << (m_size % 64)) - 1;
+    }
+public:
+    BitSet():
+        m_size(0)
+    {
+    }
+    explicit BitSet(size_t size, bool value=false):
+        m_size(size),
+        m_words(word_count(size), value ? ~uint64_t(0) : 0)
+    {
+        clear_tail();
+    }
+
+    size_t size() const { return m_size; }
+
+    bool get(size_t i) const {
+        assert(i < m_size);
+        return (m_words[i / 64] >> (i % 64)) & 1;
+    }
+    void set(size_t i, bool value=true) {
+        assert(i < m_size);
+        if( value )
+            m_words[i / 64] |= uint64_t(1) << (i % 64);
+        else
+            m_words[i / 64] &= ~(uint64_t(1) << (i % 64));
+    }
+    /// Set (or clear) all bits in `[first, last)`
+    void set_range(size_t first, size_t last, bool value=true) {
+        assert(first <= last && last <= m_size);
+        for_range_words(m_words, first, last, [&](uint64_t& w, uint64_t mask) {
+            if( value )
+                w |= mask;
+            else
+                w &= ~mask;
+            return true;
+            });
+    }
+    /// Returns true if all bits in `[first, last)` are set
+    bool all_in_range(size_t first, size_t last) const {
+        assert(first <= last && last <= m_size);
+        return for_range_words(m_words, first, last, [&](const uint64_t& w, uint64_t mask) {
+            return (w & mask) == mask;
+            });
+    }
+    /// Returns true if any bit in `[first, last)` is set
+    bool any_in_range(size_t first, size_t last) const {
+        assert(first <= last && last <= m_size);
+        return !for_range_words(m_words, first, last, [&](const uint64_t& w, uint64_t mask) {
+            return (w & mask) == 0;
+            });
+    }
+    void fill(bool value) {
+        for(auto& w : m_words)
+            w = value ? ~uint64_t(0) : 0;
+        clear_tail();
+    }
+
+    bool any() const {
+        for(auto w : m_words)
+            if( w )
+                return true;
+        return false;
+    }
+    bool overlaps(const BitSet& x) const {
+        assert(m_size == x.m_size);
+        for(size_t i = 0; i < m_words.size(); i ++)
+            if( m_words[i] & x.m_words[i] )
+                return true;
+        return false;
+    }
+
+    /// Set all bits set in `x`, returns true if this changed
+    bool union_with(const BitSet& x) {
+        assert(m_size == x.m_size);
+        uint64_t changed = 0;
+        for(size_t i = 0; i < m_words.size(); i ++) {
+            auto v = m_words[i] | x.m_words[i];
+            changed |= v ^ m_words[i];
+            m_words[i] = v;
+        }
+        return changed != 0;
+    }
+    /// Clear all bits not set in `x`, returns true if this changed
+    bool intersect_with(const BitSet& x) {
+        assert(m_size == x.m_size);
+        uint64_t changed = 0;
+        for(size_t i = 0; i < m_words.size(); i ++) {
+            auto v = m_words[i] & x.m_words[i];
+            changed |= v ^ m_words[i];
+            m_words[i] = v;
+        }
+        return changed != 0;
+    }
+    /// Clear all bits set in `x`
+    void subtract(const BitSet& x) {
+        assert(m_size == x.m_size);
+        for(size_t i = 0; i < m_words.size(); i ++)
+            m_words[i] &= ~x.m_words[i];
+    }
+
+    bool operator==(const BitSet& x) const {
+        return m_size == x.m_size && m_words == x.m_words;
+    }
+    bool operator!=(const BitSet& x) const {
+        return !(*this == x);
+    }
+
+    template<typename Cb>
+    void for_each_set(Cb cb) const {
+        for(size_t wi = 0; wi < m_words.size(); wi ++) {
+            auto w = m_words[wi];
+            for(size_t bit = 0; w; bit ++, w >>= 1) {
+                if( w & 1 )
+                    cb(wi * 64 + bit);
+            }
+        }
+    }
+};
+
+namespace dataflow {
+
+    enum class Direction {
+        Forward,
+        Backward,
+    };
+    /// How states are combined where control flow merges
+    enum class Join {
+        /// "May" problems (e.g. liveness): a bit is set if it's set on any incoming edge
+        Union,
+        /// "Must" problems (e.g. definite initialisation): a bit is set only if it's set on all incoming edges
+        Intersection,
+    };
+
+    /// Control flow graph of a function
+    struct Cfg
+    {
+        /// Blocks reachable from BB0, in reverse post-order
+        ::std::vector<BasicBlockId> rpo;
+        /// Position of each block in `rpo` (`~0u` if unreachable)
+        ::std::vector<unsigned> rpo_index;
+        ::std::vector<::std::vector<BasicBlockId>>  successors;
+        ::std::vector<::std::vector<BasicBlockId>>  predecessors;
+
+        Cfg(const ::MIR::Function& fcn);
+
+        size_t block_count() const { return successors.size(); }
+        bool is_reachable(BasicBlockId bb) const { return rpo_index[bb] != ~0u; }
+    };
+
+    /// Block-level effect for problems that can be expressed as gen/kill sets
+    struct GenKill
+    {
+        BitSet  gen;
+        BitSet  kill;
+
+        GenKill() {}
+        GenKill(size_t n):
+            gen(n),
+            kill(n)
+        {
+        }
+
+        // Add the effect of a later (in the direction of the analysis) statement
+        void add_gen(size_t i) {
+            gen.set(i);
+            kill.set(i, false);
+        }
+        void add_kill(size_t i) {
+            kill.set(i);
+            gen.set(i, false);
+        }
+
+        void apply(BitSet& state) const {
+            state.subtract(kill);
+            state.union_with(gen);
+        }
+    };
+
+    /// Solve a dataflow problem, returning the state at the start of each block (in the direction of the analysis)
+    /// - Forward: The state before the first statement (for unreachable blocks, the initial state of the join)
+    /// - Backward: The state after the terminator
+    ///
+    /// `boundary` is the state entering BB0 (forward), or leaving blocks with no successors (backward).
+    /// `transfer(bb, state)` applies the effect of an entire block (in the direction of the analysis).
+    /// `edge(src, dst, state)` applies effects specific to one edge (e.g. a call's return value is only written on the
+    /// non-panic edge).
+    ///
+    /// Blocks are visited in reverse post-order (post-order for backwards problems) from a worklist, so loops only
+    /// re-visit the blocks whose state changed.
+    template<typename Transfer, typename Edge>
+    ::std::vector<BitSet> solve(const Cfg& cfg, Direction dir, Join join, const BitSet& boundary, Transfer transfer, Edge edge)
+    {
+        const size_t n_blocks = cfg.block_count();
+        const size_t n_bits = boundary.size();
+        // Blocks are prioritised by their position in the (possibly reversed) RPO, with unreachable blocks last
+        ::std::vector<unsigned> order(n_blocks);
+        {
+            unsigned next_unreachable = cfg.rpo.size();
+            for(size_t i = 0; i < n_blocks; i ++)
+            {
+                if( cfg.is_reachable(i) )
+                    order[i] = dir == Direction::Forward ? cfg.rpo_index[i] : cfg.rpo.size() - 1 - cfg.rpo_index[i];
+                else
+                    order[i] = next_unreachable ++;
+            }
+        }
+        ::std::vector<BasicBlockId> by_order(n_blocks);
+        for(size_t i = 0; i < n_blocks; i ++)
+            by_order[order[i]] = i;
+
+        ::std::priority_queue<unsigned, ::std::vector<unsigned>, ::std::greater<unsigned>>   queue;
+        ::std::vector<bool> queued(n_blocks);
+        auto push = [&](BasicBlockId bb) {
+            if( !queued[bb] ) {
+                queued[bb] = true;
+                queue.push(order[bb]);
+            }
+            };
+
+        // Intersection problems start at "everything" (the identity of the join) until the first incoming edge is seen
+        ::std::vector<BitSet>   states(n_blocks, BitSet(n_bits, join == Join::Intersection));
+        ::std::vector<bool> have_state(n_blocks, join == Join::Union);
+        if( dir == Direction::Forward )
+        {
+            if( n_blocks > 0 ) {
+                states[0] = boundary;
+                have_state[0] = true;
+                push(0);
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < n_blocks; i ++)
+            {
+                if( cfg.successors[i].empty() ) {
+                    states[i] = boundary;
+                    have_state[i] = true;
+                }
+                push(i);
+            }
+        }
+
+        const auto& next = dir == Direction::Forward ? cfg.successors : cfg.predecessors;
+        while( !queue.empty() )
+        {
+            auto bb = by_order[queue.top()];
+            queue.pop();
+            queued[bb] = false;
+            if( !have_state[bb] )
+                continue;
+
+            BitSet  state = states[bb];
+            transfer(bb, state);
+            for(auto other : next[bb])
+            {
+                BitSet  edge_state = state;
+                if( dir == Direction::Forward )
+                    edge(bb, other, edge_state);
+                else
+                    edge(other, bb, edge_state);
+
+                auto& dst = states[other];
+                bool changed;
+                if( !have_state[other] ) {
+                    dst = ::std::move(edge_state);
+                    have_state[other] = true;
+                    changed = true;
+                }
+                else if( join == Join::Union ) {
+                    changed = dst.union_with(edge_state);
+                }
+                else {
+                    changed = dst.intersect_with(edge_state);
+                }
+                if( changed )
+                    push(other);
+            }
+        }
+        return states;
+    }
+    template<typename Transfer>
+    ::std::vector<BitSet> solve(const Cfg& cfg, Direction dir, Join join, const BitSet& boundary, Transfer transfer)
+    {
+        return solve(cfg, dir, join, boundary, transfer, [](BasicBlockId , BasicBlockId , BitSet& ){});
+    }
+    /// Solve a gen/kill problem (with one `GenKill` per block)
+    static inline ::std::vector<BitSet> solve(const Cfg& cfg, Direction dir, Join join, const BitSet& boundary, const ::std::vector<GenKill>& block_effects)
+    {
+        return solve(cfg, dir, join, boundary, [&](BasicBlockId bb, BitSet& state){ block_effects[bb].apply(state); });
+    }
+
+}   // namespace dataflow
+}   // namespace MIR
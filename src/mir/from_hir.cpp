@@ -21,6 +21,7 @@
 #include <trans/target.hpp> // Target_GetSizeAndAlignOf - for `box`
 #include <cctype>   // isdigit
 #include "helpers.hpp"
+#include <self_profile.hpp>
 
 namespace {
 
@@ -1799,7 +1800,7 @@ namespace {
                     auto panic_block = m_builder.new_bb_unlinked();
                     m_builder.end_block(::MIR::Terminator::make_Call({ ok_block, panic_block, val.clone(), mv$(method_path), mv$(args) }));
                     m_builder.set_cur_block(panic_block);
-                    m_builder.end_block(::MIR::Terminator::make_Diverge({}));
+                    m_builder.end_block_unwind(node.span());
 
                     m_builder.set_cur_block(ok_block);
                 }
@@ -2246,8 +2247,7 @@ namespace {
             }
 
             m_builder.set_cur_block(panic_block);
-            // TODO: Proper panic handling, including scope destruction
-            m_builder.end_block( ::MIR::Terminator::make_Diverge({}) );
+            m_builder.end_block_unwind(node.span());
 
             m_builder.set_cur_block( next_block );
 
@@ -2291,8 +2291,7 @@ namespace {
                 }));
 
             m_builder.set_cur_block(panic_block);
-            // TODO: Proper panic handling
-            m_builder.end_block( ::MIR::Terminator::make_Diverge({}) );
+            m_builder.end_block_unwind(node.span());
 
             m_builder.set_cur_block( next_block );
             // TODO: Support diverging value calls
@@ -2777,9 +2776,10 @@ namespace {
 }
 
 
-::MIR::FunctionPointer LowerMIR(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path, const ::HIR::ExprPtr& ptr, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args)
+::MIR::FunctionPointer LowerMIR(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path, const ::HIR::ExprPtr& ptr, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args, bool unwind_cleanup=false)
 {
     TRACE_FUNCTION_F(path);
+    PROFILE_ITEM("Lower MIR", path);
 
     ::MIR::Function fcn;
     fcn.locals.reserve(ptr.m_bindings.size());
@@ -2791,7 +2791,7 @@ namespace {
         const Span& sp = ptr->span();
 
         ::HIR::ExprNode& root_node = const_cast<::HIR::ExprNode&>(*ptr);
-        MirBuilder  builder { ptr->span(), resolve, ret_ty, args, fcn };
+        MirBuilder  builder { ptr->span(), resolve, ret_ty, args, fcn, unwind_cleanup };
         ExprVisitor_Conv    ev { builder, ptr.m_bindings, dynamic_cast<::HIR::ExprNode_GeneratorWrapper*>(&root_node) };
 
         // 1. Apply destructuring to arguments
@@ -3011,12 +3011,12 @@ void HIR_GenerateMIR_Expr(const ::HIR::Crate& crate, const ::HIR::ItemPath& path
     }
 }
 
-void HIR_GenerateMIR(::HIR::Crate& crate)
+void HIR_GenerateMIR(::HIR::Crate& crate, bool unwind_cleanup)
 {
     ::MIR::OuterVisitor    ov { crate, [&](const auto& res, const auto& p, ::HIR::ExprPtr& expr_ptr, const auto& args, const auto& ty){
             if( !expr_ptr.get_mir_opt() )
             {
-                expr_ptr.set_mir( LowerMIR(res, p, expr_ptr, ty, args) );
+                expr_ptr.set_mir( LowerMIR(res, p, expr_ptr, ty, args, unwind_cleanup) );
             }
         } };
     ov.visit_crate(crate);
@@ -192,6 +192,8 @@ class MirBuilder
     ::MIR::Function&    m_output;
 
     const ::HIR::SimplePath*    m_lang_Box;
+    /// Emit drops of live values on panic paths (for `-C unwind=tables`)
+    bool    m_unwind_cleanup;
 
     unsigned int    m_current_block;
     bool    m_block_active;
@@ -236,7 +238,7 @@ class MirBuilder
     //   the optimiser.
     ::MIR::LValue   m_if_cond_lval;
 public:
-    MirBuilder(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args, ::MIR::Function& output);
+    MirBuilder(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args, ::MIR::Function& output, bool unwind_cleanup=false);
     
     void final_cleanup();
 
@@ -329,6 +331,8 @@ public:
     ::MIR::BasicBlockId pause_cur_block();
 
     void end_block(::MIR::Terminator term);
+    /// End the current block as the panic path of a call (with cleanup of all live values, if enabled)
+    void end_block_unwind(const Span& sp);
 
     ::MIR::BasicBlockId new_bb_linked();
     ::MIR::BasicBlockId new_bb_unlinked();
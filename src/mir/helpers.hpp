@@ -10,6 +10,7 @@
 #include <functional>
 #include <hir_typeck/static.hpp>
 #include <mir/mir.hpp>
+#include <mir/dataflow.hpp>
 
 namespace HIR {
 class Crate;
@@ -150,40 +151,27 @@ public:
 // --------------------------------------------------------------------
 class ValueLifetime
 {
-    ::std::vector<bool> statements;
+    /// Bitmap of statements (numbered using `ValueLifetimes::m_block_offsets`) where the value is valid
+    BitSet  statements;
 
 public:
-    ValueLifetime(::std::vector<bool> stmts):
+    ValueLifetime(BitSet stmts):
         statements( mv$(stmts) )
     {}
 
     bool valid_at(size_t ofs) const {
-        return statements.at(ofs);
+        return statements.get(ofs);
     }
 
     // true if this value is used at any point
     bool is_used() const {
-        for(auto v : statements)
-            if( v )
-                return true;
-        return false;
+        return statements.any();
     }
     bool overlaps(const ValueLifetime& x) const {
-        assert(statements.size() == x.statements.size());
-        for(unsigned int i = 0; i < statements.size(); i ++)
-        {
-            if( statements[i] && x.statements[i] )
-                return true;
-        }
-        return false;
+        return statements.overlaps(x.statements);
     }
     void unify(const ValueLifetime& x) {
-        assert(statements.size() == x.statements.size());
-        for(unsigned int i = 0; i < statements.size(); i ++)
-        {
-            if( x.statements[i] )
-                statements[i] = true;
-        }
+        statements.union_with(x.statements);
     }
 };
 
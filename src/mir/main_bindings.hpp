@@ -11,15 +11,17 @@
 
 class TransList;
 
-extern void HIR_GenerateMIR(::HIR::Crate& crate);
+/// `unwind_cleanup` emits drops of live values on the panic paths of calls (needed for table-based unwinding)
+extern void HIR_GenerateMIR(::HIR::Crate& crate, bool unwind_cleanup=false);
 extern void MIR_Dump(::std::ostream& sink, const ::HIR::Crate& crate);
 extern void MIR_CheckCrate(/*const*/ ::HIR::Crate& crate);
 extern void MIR_CheckCrate_Full(/*const*/ ::HIR::Crate& crate);
 extern void MIR_BorrowCheck_Crate(::HIR::Crate& crate);
 
 extern void MIR_CleanupCrate(::HIR::Crate& crate);
-extern void MIR_OptimiseCrate(::HIR::Crate& crate, bool minimal_optimisations);
-extern void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool post_save);
+/// `num_threads` > 1 optimises functions in parallel (ignored when debug output is enabled)
+extern void MIR_OptimiseCrate(::HIR::Crate& crate, bool minimal_optimisations, unsigned num_threads=1);
+extern void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool post_save, unsigned num_threads=1);
 
 
 extern void HIR_GenerateMIR_Expr(const ::HIR::Crate& crate, const ::HIR::ItemPath& path, ::HIR::ExprPtr& expr_ptr, const ::HIR::Function::args_t& args, const ::HIR::TypeRef& res_ty);
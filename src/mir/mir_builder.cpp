@@ -11,13 +11,14 @@
 // --------------------------------------------------------------------
 // MirBuilder
 // --------------------------------------------------------------------
-MirBuilder::MirBuilder(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args, ::MIR::Function& output):
+MirBuilder::MirBuilder(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ret_ty, const ::HIR::Function::args_t& args, ::MIR::Function& output, bool unwind_cleanup/*=false*/):
     m_root_span(sp),
     m_resolve(resolve),
     m_ret_ty(ret_ty),
     m_args(args),
     m_output(output),
     m_lang_Box(nullptr),
+    m_unwind_cleanup(unwind_cleanup),
     m_block_active(false),
     m_result_valid(false),
     m_fcn_scope(*this, 0)
@@ -663,6 +664,24 @@ void MirBuilder::end_block(::MIR::Terminator term)
     m_block_active = false;
     m_current_block = 0;
 }
+void MirBuilder::end_block_unwind(const Span& sp)
+{
+    if( m_unwind_cleanup )
+    {
+        // Drop everything that's currently live, innermost scope first.
+        // - The state isn't updated, as this block is only reachable by unwinding (normal flow continues after the call)
+        for(auto idx : ::reverse(m_scope_stack))
+        {
+            drop_scope_values(m_scopes.at(idx));
+        }
+        for(size_t i = 0; i < m_arg_states.size(); i ++)
+        {
+            const auto& state = get_slot_state(sp, i, SlotType::Argument);
+            this->drop_value_from_state(sp, state, ::MIR::LValue::new_Argument(static_cast<unsigned>(i)));
+        }
+    }
+    end_block( ::MIR::Terminator::make_Diverge({}) );
+}
 ::MIR::BasicBlockId MirBuilder::pause_cur_block()
 {
     if( !m_block_active ) {
@@ -7,13 +7,42 @@
  */
 #include "mir_ptr.hpp"
 #include "mir.hpp"
+#include <parallel.hpp>
 
 
 void ::MIR::FunctionPointer::reset()
 {
-    if( this->ptr ) {
-        delete this->ptr;
-        this->ptr = nullptr;
-    }
+    delete this->ptr.exchange(nullptr);
+    delete this->lazy.exchange(nullptr);
 }
 
+void ::MIR::FunctionPointer::add_load_fixup(::std::function<void(::MIR::Function&)> cb)
+{
+    assert(this->is_lazy());
+    this->lazy.load()->m_load_fixups.push_back( ::std::move(cb) );
+}
+
+::MIR::Function* ::MIR::FunctionPointer::materialise() const
+{
+    // Loaded on demand, possibly from several worker threads
+    ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
+    // Another thread may have loaded it while this one waited for the lock
+    if( auto* rv = this->ptr.load(::std::memory_order_acquire) )
+        return rv;
+    auto* l = this->lazy.load(::std::memory_order_acquire);
+    if( !l )
+        throw "";
+
+    auto loaded = l->load();
+    auto* rv = loaded.ptr.exchange(nullptr);
+    assert(rv && !loaded.lazy);
+    for(auto& cb : l->m_load_fixups)
+        cb(*rv);
+
+    // Publish only once fully loaded (the fixups have run).
+    // NOTE: `ptr` is set before `lazy` is cleared, so `operator bool` never sees both as null
+    this->ptr.store(rv, ::std::memory_order_release);
+    this->lazy.store(nullptr, ::std::memory_order_release);
+    delete l;
+    return rv;
+}
@@ -6,37 +6,77 @@
  * - Pointer to a blob of MIR
  */
 #pragma once
+#include <functional>
+#include <vector>
+#include <atomic>
 
 namespace MIR {
 
 class Function;
+class FunctionPointer;
+
+/// MIR that hasn't been loaded yet (e.g. a function body stored in extern crate metadata)
+class LazyFunction
+{
+    friend class FunctionPointer;
+    /// Callbacks run on the freshly loaded MIR, in registration order (before it becomes visible)
+    ::std::vector< ::std::function<void(::MIR::Function&)> >    m_load_fixups;
+public:
+    virtual ~LazyFunction() {}
+    virtual FunctionPointer load() = 0;
+};
 
 class FunctionPointer
 {
-    ::MIR::Function*    ptr;
+    // Atomic as the MIR can be loaded (on first use) by several worker threads at once
+    // - `ptr` is only set once the MIR is fully loaded (release), and `lazy` is cleared after that
+    mutable ::std::atomic<::MIR::Function*> ptr;
+    mutable ::std::atomic<::MIR::LazyFunction*> lazy;
 public:
-    FunctionPointer(): ptr(nullptr) {}
-    FunctionPointer(::MIR::Function* p): ptr(p) {}
-    FunctionPointer(FunctionPointer&& x): ptr(x.ptr) { x.ptr = nullptr; }
+    FunctionPointer(): ptr(nullptr), lazy(nullptr) {}
+    FunctionPointer(::MIR::Function* p): ptr(p), lazy(nullptr) {}
+    FunctionPointer(FunctionPointer&& x): ptr(x.ptr.exchange(nullptr)), lazy(x.lazy.exchange(nullptr)) {}
+
+    /// Create a pointer that calls `l->load()` when first dereferenced
+    static FunctionPointer new_lazy(::MIR::LazyFunction* l) {
+        FunctionPointer rv;
+        rv.lazy.store(l, ::std::memory_order_relaxed);
+        return rv;
+    }
 
     ~FunctionPointer() {
         reset();
     }
     FunctionPointer& operator=(FunctionPointer&& x) {
         reset();
-        ptr = x.ptr;
-        x.ptr = nullptr;
+        ptr.store(x.ptr.exchange(nullptr));
+        lazy.store(x.lazy.exchange(nullptr));
         return *this;
     }
 
     void reset();
 
-          ::MIR::Function* operator->()       { if(!ptr) throw ""; return ptr; }
-    const ::MIR::Function* operator->() const { if(!ptr) throw ""; return ptr; }
-          ::MIR::Function& operator*()       { if(!ptr) throw ""; return *ptr; }
-    const ::MIR::Function& operator*() const { if(!ptr) throw ""; return *ptr; }
+    /// Returns true if the MIR is still waiting to be loaded
+    bool is_lazy() const { return lazy.load(::std::memory_order_acquire) && !ptr.load(::std::memory_order_acquire); }
+    /// Register a callback to be run on the MIR once it's loaded (must be lazy)
+    void add_load_fixup(::std::function<void(::MIR::Function&)> cb);
 
-    operator bool() const { return ptr != nullptr; }
+          ::MIR::Function* operator->()       { return get(); }
+    const ::MIR::Function* operator->() const { return get(); }
+          ::MIR::Function& operator*()       { return *get(); }
+    const ::MIR::Function& operator*() const { return *get(); }
+
+    // NOTE: `lazy` is checked first, as it's only cleared after `ptr` is set
+    operator bool() const { return lazy.load(::std::memory_order_acquire) != nullptr || ptr.load(::std::memory_order_acquire) != nullptr; }
+private:
+    ::MIR::Function* get() const {
+        auto* rv = ptr.load(::std::memory_order_acquire);
+        if(!rv) {
+            rv = materialise();
+        }
+        return rv;
+    }
+    ::MIR::Function* materialise() const;
 };
 
 }
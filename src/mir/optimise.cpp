@@ -18,6 +18,8 @@
 #include <iomanip>
 #include <trans/target.hpp>
 #include <trans/trans_list.hpp> // Note: This is included for inlining after enumeration and monomorph
+#include <parallel.hpp>
+#include <self_profile.hpp>
 
 #include <hir/expr.hpp> // HACK
 
@@ -163,6 +165,7 @@ void MIR_Optimise(const StaticTraitResolve& resolve, const ::HIR::ItemPath& path
 {
     static Span sp;
     TRACE_FUNCTION_F(path);
+    PROFILE_ITEM("MIR Optimise", path);
     ::MIR::TypeResolve   state { sp, resolve, FMT_CB(ss, ss << path;), ret_type, args, fcn };
 
     bool change_happened;
@@ -790,6 +793,149 @@ namespace
         return nullptr;
     }
 
+    /// Functions that are being optimised by parallel workers, and the read-only copies to use when inlining them
+    /// - A null copy means that the function is not a candidate for inlining this round
+    /// - Functions not in the map aren't being modified (e.g. they're from another crate), so can be read directly
+    typedef ::std::map<const ::MIR::Function*, ::std::unique_ptr<const ::MIR::Function>>    InlineSnapshot;
+    thread_local const InlineSnapshot*  tl_inline_snapshot = nullptr;
+
+    /// Parameter-independent check for if a function could ever pass `can_inline` (must accept at least everything it does)
+    bool is_inline_candidate(const ::MIR::Function& fcn)
+    {
+        if( fcn.blocks.size() <= 3 )
+            return true;
+        if( const auto* te = fcn.blocks[0].terminator.opt_Switch() )
+            return fcn.blocks.size() == te->targets.size()+3;
+        if( const auto* te = fcn.blocks[0].terminator.opt_SwitchValue() )
+            return fcn.blocks.size() == te->targets.size()+1+3;
+        return false;
+    }
+
+    ::MIR::Statement clone_statement(const ::MIR::Statement& stmt)
+    {
+        TU_MATCH_HDRA( (stmt), {)
+        TU_ARMA(Assign, se) {
+            return ::MIR::Statement::make_Assign({ se.dst.clone(), se.src.clone() });
+            }
+        TU_ARMA(Asm, se) {
+            ::MIR::Statement::Data_Asm  rv;
+            rv.tpl = se.tpl;
+            for(const auto& v : se.outputs)
+                rv.outputs.push_back(::std::make_pair(v.first, v.second.clone()));
+            for(const auto& v : se.inputs)
+                rv.inputs.push_back(::std::make_pair(v.first, v.second.clone()));
+            rv.clobbers = se.clobbers;
+            rv.flags = se.flags;
+            return ::MIR::Statement(mv$(rv));
+            }
+        TU_ARMA(Asm2, se) {
+            ::std::vector<::MIR::AsmParam>  params;
+            for(const auto& p : se.params)
+            {
+                TU_MATCH_HDRA( (p), {)
+                TU_ARMA(Const, v)
+                    params.push_back( v.clone() );
+                TU_ARMA(Sym, v)
+                    params.push_back( v.clone() );
+                TU_ARMA(Reg, v)
+                    params.push_back(::MIR::AsmParam::make_Reg({
+                        v.dir,
+                        v.spec.clone(),
+                        v.input  ? box$(v.input->clone()) : ::std::unique_ptr<::MIR::Param>(),
+                        v.output ? box$(v.output->clone()) : ::std::unique_ptr<::MIR::LValue>()
+                        }));
+                }
+            }
+            return ::MIR::Statement::make_Asm2({ se.options, se.lines, mv$(params) });
+            }
+        TU_ARMA(SetDropFlag, se) {
+            return ::MIR::Statement::make_SetDropFlag({ se.idx, se.new_val, se.other });
+            }
+        TU_ARMA(Drop, se) {
+            return ::MIR::Statement::make_Drop({ se.kind, se.slot.clone(), se.flag_idx });
+            }
+        TU_ARMA(ScopeEnd, se) {
+            return ::MIR::Statement::make_ScopeEnd({ se.slots });
+            }
+        }
+        throw "";
+    }
+    ::MIR::Terminator clone_terminator(const ::MIR::Terminator& term)
+    {
+        TU_MATCH_HDRA( (term), {)
+        TU_ARMA(Incomplete, te) {
+            return ::MIR::Terminator::make_Incomplete({});
+            }
+        TU_ARMA(Return, te) {
+            return ::MIR::Terminator::make_Return({});
+            }
+        TU_ARMA(Diverge, te) {
+            return ::MIR::Terminator::make_Diverge({});
+            }
+        TU_ARMA(Goto, te) {
+            return ::MIR::Terminator::make_Goto(te);
+            }
+        TU_ARMA(Panic, te) {
+            return ::MIR::Terminator::make_Panic({ te.dst });
+            }
+        TU_ARMA(If, te) {
+            return ::MIR::Terminator::make_If({ te.cond.clone(), te.bb_true, te.bb_false });
+            }
+        TU_ARMA(Switch, te) {
+            return ::MIR::Terminator::make_Switch({ te.val.clone(), te.targets });
+            }
+        TU_ARMA(SwitchValue, te) {
+            return ::MIR::Terminator::make_SwitchValue({ te.val.clone(), te.def_target, te.targets, te.values.clone() });
+            }
+        TU_ARMA(Call, te) {
+            ::MIR::CallTarget   fcn;
+            TU_MATCH_HDRA( (te.fcn), {)
+            TU_ARMA(Value, v)
+                fcn = v.clone();
+            TU_ARMA(Path, v)
+                fcn = v.clone();
+            TU_ARMA(Intrinsic, v)
+                fcn = ::MIR::CallTarget::make_Intrinsic({ v.name, v.params.clone() });
+            }
+            ::std::vector<::MIR::Param> args;
+            args.reserve(te.args.size());
+            for(const auto& a : te.args)
+                args.push_back(a.clone());
+            return ::MIR::Terminator::make_Call({ te.ret_block, te.panic_block, te.ret_val.clone(), mv$(fcn), mv$(args) });
+            }
+        }
+        throw "";
+    }
+    ::std::unique_ptr<const ::MIR::Function> clone_function(const ::MIR::Function& fcn)
+    {
+        auto rv = ::std::make_unique<::MIR::Function>();
+        rv->locals.reserve(fcn.locals.size());
+        for(const auto& ty : fcn.locals)
+            rv->locals.push_back(ty.clone());
+        rv->drop_flags = fcn.drop_flags;
+        rv->blocks.reserve(fcn.blocks.size());
+        for(const auto& bb : fcn.blocks)
+        {
+            ::MIR::BasicBlock   new_bb;
+            new_bb.statements.reserve(bb.statements.size());
+            for(const auto& stmt : bb.statements)
+                new_bb.statements.push_back(clone_statement(stmt));
+            new_bb.terminator = clone_terminator(bb.terminator);
+            rv->blocks.push_back(mv$(new_bb));
+        }
+        return rv;
+    }
+    /// Build the read-only inlining sources for a set of functions that are about to be optimised in parallel
+    InlineSnapshot make_inline_snapshot(const ::std::vector<const ::MIR::Function*>& fcns)
+    {
+        InlineSnapshot  rv;
+        for(const auto* fcn : fcns)
+        {
+            rv.insert(::std::make_pair( fcn, is_inline_candidate(*fcn) ? clone_function(*fcn) : nullptr ));
+        }
+        return rv;
+    }
+
 
     void visit_terminator_target_mut(::MIR::Terminator& term, ::std::function<void(::MIR::BasicBlockId&)> cb) {
         TU_MATCH_HDRA( (term), {)
@@ -1743,6 +1889,20 @@ bool MIR_Optimise_Inlining(::MIR::TypeResolve& state, ::MIR::Function& fcn, bool
                 DEBUG("Can't inline - recursion");
                 continue ;
             }
+            // When running in parallel, read from the snapshot taken before this round (the live copy may be changing)
+            if( tl_inline_snapshot )
+            {
+                auto it = tl_inline_snapshot->find(called_mir);
+                if( it != tl_inline_snapshot->end() )
+                {
+                    if( !it->second )
+                    {
+                        DEBUG("Can't inline " << path << " - not snapshotted");
+                        continue ;
+                    }
+                    called_mir = it->second.get();
+                }
+            }
 
             // Check the size of the target function.
             // Inline IF:
@@ -6481,8 +6641,130 @@ void MIR_SortBlocks(const StaticTraitResolve& resolve, const ::HIR::ItemPath& pa
 }
 
 
-void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
+namespace {
+    /// Per-function optimisation on a pool of worker threads
+    /// - Each function is only modified by one worker, inlining reads callees from a snapshot taken up-front
+    /// - NOTE: That snapshot is of the unoptimised MIR, while the serial visitor inlines the already-optimised body of
+    ///   any callee visited before the caller. So inlining decisions (and the output) can differ from `-Z threads=1`.
+    /// - Each worker has its own `StaticTraitResolve` (its caches aren't thread-safe)
+    void MIR_OptimiseCrate_Parallel(::HIR::Crate& crate, bool do_minimal_optimisation, unsigned num_threads)
+    {
+        static const ::HIR::Function::args_t    no_args;
+        struct Job {
+            ::std::string   path;
+            ::MIR::Function*    mir;
+            const ::HIR::Function::args_t*  args;
+            ::HIR::TypeRef  ret_ty;
+            StaticTraitResolve::GenericsState   generics;
+        };
+        ::std::vector<Job>  jobs;
+        ::MIR::OuterVisitor ov { crate, [&](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
+            {
+                // NOTE: `args` and `ty` can be temporaries (e.g. for array sizes), so are copied/replaced
+                jobs.push_back(Job {
+                    FMT(p),
+                    &expr.get_mir_or_error_mut(Span()),
+                    args.empty() ? &no_args : &args,
+                    ty.clone(),
+                    res.get_generics_state()
+                    });
+            }
+            };
+        ov.visit_crate(crate);
+
+        ::std::vector<const ::MIR::Function*>   fcns;
+        for(const auto& j : jobs)
+            fcns.push_back(j.mir);
+        auto snapshot = make_inline_snapshot(fcns);
+
+        ::std::vector<::std::unique_ptr<StaticTraitResolve>>    resolvers;
+        for(unsigned i = 0; i < num_threads; i ++)
+            resolvers.push_back(::std::make_unique<StaticTraitResolve>(crate));
+
+        parallel_for_each_index(num_threads, jobs.size(), [&](unsigned worker_idx, size_t job_idx) {
+            const auto& job = jobs[job_idx];
+            auto& res = *resolvers[worker_idx];
+            res.set_generics_state(job.generics);
+            tl_inline_snapshot = &snapshot;
+            ::HIR::ItemPath ip(job.path);
+            if( do_minimal_optimisation ) {
+                MIR_OptimiseMin(res, ip, *job.mir, *job.args, job.ret_ty);
+            }
+            else {
+                MIR_Optimise(res, ip, *job.mir, *job.args, job.ret_ty);
+            }
+            tl_inline_snapshot = nullptr;
+            });
+    }
+
+    /// Parallel version of the post-monomorph inlining loop, runs until no more inlining happens (like the serial loop)
+    /// - Each iteration inlines from a snapshot of the previous iteration's output, so the result doesn't depend on scheduling
+    /// - The serial loop instead sees the callees that have already been processed in the same iteration, so the
+    ///   two can make different inlining decisions (the output differs between `-Z threads=1` and `-Z threads=N`,
+    ///   but is the same for any N > 1)
+    void MIR_OptimiseCrate_Inlining_Parallel(const ::HIR::Crate& crate, TransList& list, unsigned num_threads)
+    {
+        bool did_inline_on_pass;
+        struct Job {
+            ::std::string   path;
+            ::MIR::Function*    mir;
+            const ::HIR::Function::args_t*  args;
+            const ::HIR::TypeRef*   ret_ty;
+            bool    is_mono;
+        };
+        ::std::vector<Job>  jobs;
+        ::std::vector<const ::MIR::Function*>   fcns;
+        for(auto& fcn_ent : list.m_functions)
+        {
+            auto& hir_fcn = *const_cast<::HIR::Function*>(fcn_ent.second->ptr);
+            auto& mono_fcn = fcn_ent.second->monomorphised;
+            if( mono_fcn.code )
+            {
+                jobs.push_back(Job { FMT(fcn_ent.first), &*mono_fcn.code, &mono_fcn.arg_tys, &mono_fcn.ret_ty, true });
+            }
+            else if( hir_fcn.m_code )
+            {
+                jobs.push_back(Job { FMT(fcn_ent.first), &hir_fcn.m_code.get_mir_or_error_mut(Span()), &hir_fcn.m_args, &hir_fcn.m_return, false });
+            }
+            else
+            {
+                // Extern, no optimisations
+                continue ;
+            }
+            fcns.push_back(jobs.back().mir);
+        }
+
+        ::std::vector<::std::unique_ptr<StaticTraitResolve>>    resolvers;
+        for(unsigned i = 0; i < num_threads; i ++)
+            resolvers.push_back(::std::make_unique<StaticTraitResolve>(crate));
+        ::std::vector<char> did_opt(jobs.size());
+        do
+        {
+            auto snapshot = make_inline_snapshot(fcns);
+            parallel_for_each_index(num_threads, jobs.size(), [&](unsigned worker_idx, size_t job_idx) {
+                const auto& job = jobs[job_idx];
+                const auto& res = *resolvers[worker_idx];
+                ::HIR::ItemPath ip(job.path);
+                tl_inline_snapshot = &snapshot;
+                did_opt[job_idx] = MIR_OptimiseInline(res, ip, *job.mir, *job.args, *job.ret_ty, list);
+                tl_inline_snapshot = nullptr;
+                if( !job.is_mono )
+                    job.mir->trans_enum_state = ::MIR::EnumCachePtr();   // Clear MIR enum cache
+                MIR_Cleanup(res, ip, *job.mir, *job.args, *job.ret_ty);
+                });
+            did_inline_on_pass = ::std::any_of(did_opt.begin(), did_opt.end(), [](char v){ return v != 0; });
+        } while( did_inline_on_pass );
+    }
+}
+
+void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation, unsigned num_threads)
 {
+    // NOTE: Debug output is only sensible when single-threaded
+    if( num_threads > 1 && !debug_enabled() )
+    {
+        MIR_OptimiseCrate_Parallel(crate, do_minimal_optimisation, num_threads);
+        return ;
+    }
     ::MIR::OuterVisitor ov { crate, [do_minimal_optimisation](const auto& res, const auto& p, auto& expr, const auto& args, const auto& ty)
         {
             //if( ! dynamic_cast<::HIR::ExprNode_Block*>(expr.get()) ) {
@@ -6500,7 +6782,7 @@ void MIR_OptimiseCrate(::HIR::Crate& crate, bool do_minimal_optimisation)
     ov.visit_crate(crate);
 }
 
-void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool post_save)
+void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool post_save, unsigned num_threads)
 {
     TRACE_FUNCTION;
 
@@ -6561,6 +6843,13 @@ void MIR_OptimiseCrate_Inlining(const ::HIR::Crate& crate, TransList& list, bool
     const size_t  MAX_ITERATIONS = 5; // TODO: Tune this.
     size_t  num_iterations = 0;
     bool did_inline_on_pass;
+
+    if( num_threads > 1 && !debug_enabled() )
+    {
+        MIR_OptimiseCrate_Inlining_Parallel(crate, list, num_threads);
+        return ;
+    }
+
     do
     {
         did_inline_on_pass = false;
@@ -16,53 +16,159 @@
 #include <algorithm>    // std::count
 #include <limits>       // std::numeric_limits
 #include <cctype>
+#include <sstream>
+#ifdef _WIN32
+# include <Windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
 //#define TRACE_CHARS
 //#define TRACE_RAW_TOKENS
 
+class LexerSource
+{
+#ifdef _WIN32
+    HANDLE  m_file = INVALID_HANDLE_VALUE;
+    HANDLE  m_mapping = NULL;
+#endif
+    void*   m_map_base = nullptr;
+    size_t  m_map_size = 0;
+    ::std::string   m_owned;
+public:
+    const char* data = nullptr;
+    size_t  size = 0;
+
+    /// Take ownership of an in-memory buffer
+    LexerSource(::std::string text):
+        m_owned(::std::move(text))
+    {
+        data = m_owned.data();
+        size = m_owned.size();
+    }
+    /// Map a file into memory
+    static ::std::unique_ptr<LexerSource> open_file(const ::std::string& filename)
+    {
+        ::std::unique_ptr<LexerSource>  rv { new LexerSource(::std::string()) };
+#ifdef _WIN32
+        rv->m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if( rv->m_file == INVALID_HANDLE_VALUE )
+            return nullptr;
+        LARGE_INTEGER   size;
+        if( !GetFileSizeEx(rv->m_file, &size) )
+            return nullptr;
+        rv->m_map_size = static_cast<size_t>(size.QuadPart);
+        // NOTE: Can't map an empty file, but there's nothing to read anyway
+        if( rv->m_map_size > 0 )
+        {
+            rv->m_mapping = CreateFileMappingA(rv->m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if( rv->m_mapping == NULL )
+                return nullptr;
+            rv->m_map_base = MapViewOfFile(rv->m_mapping, FILE_MAP_READ, 0, 0, 0);
+            if( !rv->m_map_base )
+                return nullptr;
+        }
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if( fd < 0 )
+            return nullptr;
+        struct stat st;
+        if( fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ) {
+            ::close(fd);
+            return nullptr;
+        }
+        rv->m_map_size = static_cast<size_t>(st.st_size);
+        if( rv->m_map_size > 0 )
+        {
+            void* base = mmap(nullptr, rv->m_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if( base == MAP_FAILED ) {
+                ::close(fd);
+                return nullptr;
+            }
+            rv->m_map_base = base;
+            // The whole file is read front-to-back
+            madvise(base, rv->m_map_size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+#endif
+        rv->data = static_cast<const char*>(rv->m_map_base);
+        rv->size = rv->m_map_size;
+        return rv;
+    }
+    ~LexerSource()
+    {
+#ifdef _WIN32
+        if( m_map_base )
+            UnmapViewOfFile(m_map_base);
+        if( m_mapping != NULL )
+            CloseHandle(m_mapping);
+        if( m_file != INVALID_HANDLE_VALUE )
+            CloseHandle(m_file);
+#else
+        if( m_map_base )
+            munmap(m_map_base, m_map_size);
+#endif
+    }
+};
+
 Lexer::Lexer(const ::std::string& filename, AST::Edition edition, ParseState ps):
     TokenStream(ps),
     m_path(filename.c_str()),
     m_line(1),
-    m_line_ofs(0),
-    m_istream_fp(filename != "-" ? new std::ifstream(filename.c_str()) : nullptr),
-    m_istream(filename != "-" ? *m_istream_fp : std::cin),
     m_last_char_valid(false),
     m_edition(edition),
     m_hygiene( Ident::Hygiene::new_scope() )
 {
-    if( m_istream_fp )
+    if( filename == "-" )
     {
-        if( !m_istream_fp->is_open() )
+        ::std::ostringstream    ss;
+        ss << ::std::cin.rdbuf();
+        m_source.reset(new LexerSource(ss.str()));
+    }
+    else
+    {
+        m_source = LexerSource::open_file(filename);
+        if( !m_source )
         {
             throw ::std::runtime_error("Unable to open file '" + filename + "'");
         }
-        // Consume the BOM
-        if( this->getc_byte() == '\xef' )
-        {
-            if( this->getc_byte() != '\xbb' ) {
-                throw ::std::runtime_error("Incomplete BOM - missing \\xBB in second position");
-            }
-            if( this->getc_byte() != '\xbf' ) {
-                throw ::std::runtime_error("Incomplete BOM - missing \\xBF in third position");
-            }
-            m_line_ofs = 0;
+    }
+    m_cur = m_source->data;
+    m_end = m_source->data + m_source->size;
+    // Consume the BOM
+    if( m_end - m_cur >= 1 && m_cur[0] == '\xef' )
+    {
+        if( m_end - m_cur < 2 || m_cur[1] != '\xbb' ) {
+            throw ::std::runtime_error("Incomplete BOM - missing \\xBB in second position");
         }
-        else
-        {
-            m_istream.unget();
+        if( m_end - m_cur < 3 || m_cur[2] != '\xbf' ) {
+            throw ::std::runtime_error("Incomplete BOM - missing \\xBF in third position");
         }
+        m_cur += 3;
     }
+    m_line_start = m_cur;
+    m_column_pos = m_cur;
+    m_column = 0;
 }
 Lexer::Lexer(::std::istringstream& ss, AST::Edition edition, ParseState ps)
     : TokenStream(ps)
     , m_path("-")
     , m_line(1)
-    , m_line_ofs(0)
-    , m_istream_fp(nullptr)
-    , m_istream(ss)
+    , m_source(new LexerSource(ss.str()))
     , m_last_char_valid(false)
     , m_edition(edition)
     , m_hygiene( Ident::Hygiene::new_scope() )
+{
+    m_cur = m_source->data;
+    m_end = m_source->data + m_source->size;
+    m_line_start = m_cur;
+    m_column_pos = m_cur;
+    m_column = 0;
+}
+Lexer::Lexer(Lexer&& x) = default;
+Lexer::~Lexer()
 {
 }
 
@@ -313,7 +419,19 @@ bool issym(Codepoint ch)
 
 Position Lexer::getPosition() const
 {
-    return Position(m_path, m_line, m_line_ofs);
+    // The column is the number of characters read since the start of the line (counting the newline itself), counted
+    // lazily from where the last call got to (reset by `getc_byte` at each newline).
+    for(; m_column_pos != m_cur; m_column_pos ++)
+    {
+        auto b = static_cast<uint8_t>(*m_column_pos);
+        // Skip UTF-8 continuation bytes, and the `\r` of a `\r\n`
+        if( (b & 0xC0) == 0x80 )
+            continue ;
+        if( b == '\r' && m_column_pos + 1 != m_cur && m_column_pos[1] == '\n' )
+            continue ;
+        m_column ++;
+    }
+    return Position(m_path, m_line, m_column);
 }
 Ident::Hygiene Lexer::realGetHygiene() const
 {
@@ -351,9 +469,10 @@ Token Lexer::getTokenInt()
     }
     try
     {
+        bool is_file_start = m_line == 1 && m_cur == m_line_start && !m_last_char_valid;
         Codepoint ch = this->getc();
 
-        if( m_line == 1 && m_line_ofs == 1 && ch == '#') {
+        if( is_file_start && ch == '#') {
             switch( (ch = this->getc()).v )
             {
             case '!':
@@ -385,6 +504,7 @@ Token Lexer::getTokenInt()
             return Token(TOK_NEWLINE);
         if( ch.isspace() )
         {
+            this->getc_ascii_run([](char c){ return c == ' ' || c == '\t'; });
             while( (ch = this->getc()).isspace() && ch != '\n' )
                 ;
             this->ungetc();
@@ -629,6 +749,8 @@ Token Lexer::getTokenInt()
                 while(ch != '\n' && ch != '\r')
                 {
                     str += ch;
+                    const char* run = this->getc_ascii_run([](char c){ return c != '\n' && c != '\r' && !(c & 0x80); });
+                    str.append(run, m_cur);
                     ch = this->getc();
                 }
                 this->ungetc();
@@ -697,6 +819,8 @@ Token Lexer::getTokenInt()
                         }
                         else {
                             str += ch;
+                            const char* run = this->getc_ascii_run([](char c){ return c != '/' && c != '*' && c != '\n' && c != '\r' && !(c & 0x80); });
+                            str.append(run, m_cur);
                         }
                     }
                     ch = this->getc();
@@ -765,6 +889,8 @@ Token Lexer::getTokenInt()
                     else
                     {
                         str += ch;
+                        const char* run = this->getc_ascii_run([](char c){ return c != '"' && c != '\\' && c != '\n' && c != '\r' && !(c & 0x80); });
+                        str.append(run, m_cur);
                     }
                 }
                 return Token(TOK_STRING, mv$(str), realGetHygiene());
@@ -866,6 +992,8 @@ Token Lexer::getTokenInt_Identifier(Codepoint leader, Codepoint leader2, bool pa
     while( issym(ch) )
     {
         str += ch;
+        const char* run = this->getc_ascii_run([](char c){ return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_'; });
+        str.append(run, m_cur);
         ch = this->getc();
     }
 
@@ -1122,25 +1250,22 @@ uint32_t Lexer::parseEscape(char enclosing)
 
 char Lexer::getc_byte()
 {
-    int rv = m_istream.get();
-    if( rv == EOF )
+    if( m_cur == m_end )
         throw Lexer::EndOfFile();
 
-    if( rv == '\r' )
+    const char* start = m_cur;
+    char rv = *m_cur++;
+    if( rv == '\r' && m_cur != m_end && *m_cur == '\n' )
     {
-        if( m_istream.get() != '\n' )
-        {
-            m_istream.unget();
-        }
-        else
-        {
-            rv = '\n';
-        }
+        m_cur ++;
+        rv = '\n';
     }
     if( rv == '\n' )
     {
         m_line ++;
-        m_line_ofs = 0;
+        m_line_start = start;
+        m_column_pos = start;
+        m_column = 0;
     }
 
     return rv;
@@ -1157,7 +1282,6 @@ Codepoint Lexer::getc()
     else
     {
         m_last_char = this->getc_cp();
-        m_line_ofs += 1;
 #ifdef TRACE_CHARS
         ::std::cout << "getc(): U+" << ::std::hex << m_last_char.v << ::std::endl;
 #endif
@@ -10,6 +10,7 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
 #include "tokenstream.hpp"
 
 struct Codepoint {
@@ -32,15 +33,26 @@ extern Token Lex_FindReservedWord(const ::std::string& s, AST::Edition edition);
 
 typedef Codepoint   uchar;
 
+/// Source text being lexed (either a memory-mapped file, or an owned buffer)
+class LexerSource;
+
 class Lexer:
     public TokenStream
 {
     RcString    m_path;
     unsigned int m_line;
-    unsigned int m_line_ofs;
 
-    ::std::unique_ptr<::std::ifstream>  m_istream_fp;
-    ::std::istream& m_istream;
+    // NOTE: Held by pointer so the buffer doesn't move when the lexer does
+    ::std::unique_ptr<LexerSource>  m_source;
+    /// Read position in the source buffer
+    const char* m_cur;
+    const char* m_end;
+    /// Start of the current line (the newline character that ended the previous line, or the start of the file)
+    const char* m_line_start;
+    /// Column cache for `getPosition`, so it doesn't have to re-scan the whole line every time
+    mutable const char* m_column_pos;
+    mutable unsigned int m_column;
+
     bool    m_last_char_valid;
     Codepoint   m_last_char;
     ::std::vector<Token>    m_next_tokens;
@@ -50,6 +62,8 @@ class Lexer:
 public:
     Lexer(::std::istringstream& ss, AST::Edition edition, ParseState ps);
     Lexer(const ::std::string& filename, AST::Edition edition, ParseState ps);
+    Lexer(Lexer&& x);
+    ~Lexer();
 
     Position getPosition() const override;
     Ident::Hygiene realGetHygiene() const override;
@@ -86,6 +100,19 @@ private:
     Codepoint getc();
     Codepoint getc_cp();
     char getc_byte();
+    /// Consume a run of ASCII characters matching `pred` directly from the buffer, returning the start of the run (the
+    /// end is the new `m_cur`)
+    /// - `pred` must not accept newlines (or non-ASCII bytes), as they need the handling in `getc_byte`
+    /// - Returns an empty run if there's a character pushed back by `ungetc` (it has to be consumed first)
+    template<typename Pred>
+    const char* getc_ascii_run(Pred pred) {
+        const char* start = m_cur;
+        if( m_last_char_valid )
+            return start;
+        while( m_cur != m_end && pred(*m_cur) )
+            m_cur ++;
+        return start;
+    }
 
     class EndOfFile {};
 };
@@ -10,6 +10,8 @@
 #include <string>
 #include <iostream>
 #include <algorithm>    // std::max
+#include <mutex>
+#include <new>  // placement new
 
 RcString::RcString(const char* s, size_t len):
     m_ptr(nullptr)
@@ -18,9 +20,9 @@ RcString::RcString(const char* s, size_t len):
     {
         size_t nwords = (len+1 + sizeof(unsigned int)-1) / sizeof(unsigned int);
         m_ptr = reinterpret_cast<Inner*>(malloc(sizeof(Inner) + (nwords - 1) * sizeof(unsigned int)));
-        m_ptr->refcount = 1;
+        new(&m_ptr->refcount) ::std::atomic<unsigned int>(1);
         m_ptr->size = static_cast<unsigned>(len);
-        m_ptr->ordering = 0;
+        new(&m_ptr->ordering) ::std::atomic<unsigned int>(0);
         char* data_mut = reinterpret_cast<char*>(m_ptr->data);
         for(unsigned int j = 0; j < len; j ++ )
             data_mut[j] = s[j];
@@ -31,9 +33,8 @@ RcString::~RcString()
 {
     if(m_ptr)
     {
-        m_ptr->refcount -= 1;
         //::std::cout << "RcString(" << m_ptr << " \"" << *this << "\") - " << *m_ptr << " refs left (drop)" << ::std::endl;
-        if( m_ptr->refcount == 0 )
+        if( m_ptr->refcount.fetch_sub(1) == 1 )
         {
             free(m_ptr);
         }
@@ -238,11 +239,14 @@ namespace {
 }
 TieredSet   RcString_interned_strings;
 bool    RcString_interned_ordering_valid;
+// Protects the above (interning can happen from MIR optimisation worker threads)
+::std::mutex    RcString_interned_lock;
 
 RcString RcString::new_interned(const char* s, size_t len)
 {
     if(len == 0)
         return RcString();
+    ::std::lock_guard<::std::mutex> lh { RcString_interned_lock };
     auto ret = RcString_interned_strings.lookup_or_add(StringView { s, len });
     // Set interned and invalidate the cache if an insert happened
     if(ret.second)
@@ -256,15 +260,16 @@ RcString RcString::new_interned(const char* s, size_t len)
 Ordering RcString::ord_interned(const RcString& s) const
 {
     assert(s.is_interned() && this->is_interned());
+    // Locked for the whole comparison, as another thread could intern a string (and renumber) between the two reads
+    ::std::lock_guard<::std::mutex> lh { RcString_interned_lock };
     if(!RcString_interned_ordering_valid)
     {
-        // Populate cache
         unsigned i = 1;
         for(auto& e : RcString_interned_strings)
-            e.m_ptr->ordering = i++;
+            e.m_ptr->ordering.store(i++, ::std::memory_order_relaxed);
         RcString_interned_ordering_valid = true;
     }
-    return ::ord(this->m_ptr->ordering, s.m_ptr->ordering);
+    return ::ord(this->m_ptr->ordering.load(::std::memory_order_relaxed), s.m_ptr->ordering.load(::std::memory_order_relaxed));
 }
 
 size_t std::hash<RcString>::operator()(const RcString& s) const noexcept
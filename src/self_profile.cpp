@@ -0,0 +1,376 @@
+/*
+ * MRustC - Mutabah's Rust Compiler
+ * - By John Hodge (Mutabah/thePowersGang)
+ *
+ * self_profile.cpp
+ * - Opt-in compile-time profiler (`--self-profile <file>`)
+ *
+ * Records wall/CPU time and allocation counts for each compiler phase and for items (functions) within
+ * phases, and writes them out as a Chrome trace-event JSON file (loadable by `chrome://tracing` or Perfetto)
+ *
+ * Allocations are only counted in builds with `MRUSTC_COUNT_ALLOCS` defined (`make COUNT_ALLOCS=1`), as that
+ * replaces the global `operator new`/`operator delete` for the whole process.
+ */
+#include <self_profile.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# define NOGDI
+# include <Windows.h>
+# include <Psapi.h>
+# pragma comment(lib, "psapi.lib")
+#else
+# include <sys/resource.h>
+# include <time.h>
+#endif
+
+bool g_self_profile_enabled = false;
+
+namespace {
+    const size_t TOP_N_ITEMS = 20;
+#ifdef MRUSTC_COUNT_ALLOCS
+    const bool COUNT_ALLOCS = true;
+#else
+    const bool COUNT_ALLOCS = false;
+#endif
+
+    /// Allocations made by all threads (used for phases)
+    ::std::atomic<uint64_t> s_total_allocs { 0 };
+    /// Allocations made by this thread (used for items, which run on a single thread)
+    thread_local uint64_t   t_thread_allocs = 0;
+
+    struct Event
+    {
+        const char* category;
+        ::std::string   name;
+        bool    is_phase;
+        unsigned    tid;
+        uint64_t    start_us;
+        uint64_t    dur_us;
+        uint64_t    cpu_us;
+        uint64_t    allocs;
+        uint64_t    peak_rss_kb;
+    };
+    struct State
+    {
+        ::std::string   outfile;
+        ::std::chrono::steady_clock::time_point start_time;
+        ::std::mutex    lock;
+        ::std::vector<Event>    events;
+        ::std::atomic<unsigned> next_tid { 0 };
+        bool    finished = false;
+    };
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    unsigned cur_tid() {
+        thread_local unsigned tid = state().next_tid ++;
+        return tid;
+    }
+    uint64_t wall_us() {
+        auto d = ::std::chrono::steady_clock::now() - state().start_time;
+        return ::std::chrono::duration_cast<::std::chrono::microseconds>(d).count();
+    }
+#ifdef _WIN32
+    uint64_t filetime_us(const FILETIME& ft) {
+        return ((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10;
+    }
+    uint64_t thread_cpu_us() {
+        FILETIME    c, e, k, u;
+        GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u);
+        return filetime_us(k) + filetime_us(u);
+    }
+    uint64_t process_cpu_us() {
+        FILETIME    c, e, k, u;
+        GetProcessTimes(GetCurrentProcess(), &c, &e, &k, &u);
+        return filetime_us(k) + filetime_us(u);
+    }
+    uint64_t peak_rss_kb() {
+        PROCESS_MEMORY_COUNTERS pmc;
+        if( !GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) )
+            return 0;
+        return pmc.PeakWorkingSetSize / 1024;
+    }
+#else
+    uint64_t thread_cpu_us() {
+        struct timespec ts;
+        if( clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0 )
+            return 0;
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    }
+    uint64_t process_cpu_us() {
+        return static_cast<uint64_t>(clock()) * 1000000 / CLOCKS_PER_SEC;
+    }
+    uint64_t peak_rss_kb() {
+        struct rusage   ru;
+        if( getrusage(RUSAGE_SELF, &ru) != 0 )
+            return 0;
+# ifdef __APPLE__
+        return ru.ru_maxrss / 1024; // Bytes on macOS
+# else
+        return ru.ru_maxrss;
+# endif
+    }
+#endif
+
+    struct JsonStr {
+        const ::std::string& s;
+        friend ::std::ostream& operator<<(::std::ostream& os, const JsonStr& x) {
+            os << '"';
+            for(char c : x.s)
+            {
+                switch(c)
+                {
+                case '"':   os << "\\\"";   break;
+                case '\\':  os << "\\\\";   break;
+                case '\n':  os << "\\n";    break;
+                case '\t':  os << "\\t";    break;
+                default:
+                    if( static_cast<unsigned char>(c) < 0x20 )
+                        os << "\\u" << ::std::hex << ::std::setw(4) << ::std::setfill('0') << static_cast<unsigned>(c) << ::std::dec << ::std::setfill(' ');
+                    else
+                        os << c;
+                    break;
+                }
+            }
+            return os << '"';
+        }
+    };
+    struct Secs {
+        uint64_t    us;
+        friend ::std::ostream& operator<<(::std::ostream& os, const Secs& x) {
+            return os << ::std::fixed << ::std::setprecision(3) << ::std::setw(9) << static_cast<double>(x.us) / 1e6;
+        }
+    };
+    struct Allocs {
+        uint64_t    n;
+        friend ::std::ostream& operator<<(::std::ostream& os, const Allocs& x) {
+            if( COUNT_ALLOCS )
+                return os << ::std::setw(10) << x.n;
+            else
+                return os << ::std::setw(10) << "-";
+        }
+    };
+
+#ifdef MRUSTC_COUNT_ALLOCS
+    void count_allocation() {
+        s_total_allocs.fetch_add(1, ::std::memory_order_relaxed);
+        t_thread_allocs += 1;
+    }
+    void* counted_alloc(size_t size, size_t align) {
+        if( g_self_profile_enabled ) {
+            count_allocation();
+        }
+        if( size == 0 )
+            size = 1;
+        for(;;)
+        {
+            void* rv;
+            if( align == 0 )
+                rv = ::std::malloc(size);
+# ifdef _WIN32
+            else
+                rv = _aligned_malloc(size, align);
+# else
+            else if( posix_memalign(&rv, align, size) != 0 )
+                rv = nullptr;
+# endif
+            if( rv )
+                return rv;
+            auto handler = ::std::get_new_handler();
+            if( !handler )
+                return nullptr;
+            handler();
+        }
+    }
+    void* counted_alloc_throw(size_t size, size_t align) {
+        if( void* rv = counted_alloc(size, align) )
+            return rv;
+        throw ::std::bad_alloc();
+    }
+    void* counted_alloc_nothrow(size_t size, size_t align) noexcept {
+        try {
+            return counted_alloc(size, align);
+        }
+        catch(...) {
+            return nullptr;
+        }
+    }
+    void counted_free(void* p, bool is_aligned) noexcept {
+# ifdef _WIN32
+        if( is_aligned ) {
+            _aligned_free(p);
+            return ;
+        }
+# else
+        (void)is_aligned;
+# endif
+        ::std::free(p);
+    }
+#endif
+}
+
+#ifdef MRUSTC_COUNT_ALLOCS
+// Replacement global allocation functions, so allocations can be counted
+// - These are the whole set of (non-placement) replaceable functions, so `new` and `delete` always pair up
+# if defined(__GNUC__) && __GNUC__ >= 11
+// The replacement `operator delete` frees memory from the replacement `operator new`, which GCC can't see
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+# endif
+void* operator new(size_t size) { return counted_alloc_throw(size, 0); }
+void* operator new[](size_t size) { return counted_alloc_throw(size, 0); }
+void* operator new(size_t size, const ::std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, 0); }
+void* operator new[](size_t size, const ::std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, 0); }
+void operator delete(void* p) noexcept { counted_free(p, false); }
+void operator delete[](void* p) noexcept { counted_free(p, false); }
+void operator delete(void* p, size_t) noexcept { counted_free(p, false); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p, false); }
+void operator delete(void* p, const ::std::nothrow_t&) noexcept { counted_free(p, false); }
+void operator delete[](void* p, const ::std::nothrow_t&) noexcept { counted_free(p, false); }
+# ifdef __cpp_aligned_new
+void* operator new(size_t size, ::std::align_val_t al) { return counted_alloc_throw(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, ::std::align_val_t al) { return counted_alloc_throw(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, ::std::align_val_t al, const ::std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, ::std::align_val_t al, const ::std::nothrow_t&) noexcept { return counted_alloc_nothrow(size, static_cast<size_t>(al)); }
+void operator delete(void* p, ::std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, ::std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete(void* p, size_t, ::std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete[](void* p, size_t, ::std::align_val_t) noexcept { counted_free(p, true); }
+void operator delete(void* p, ::std::align_val_t, const ::std::nothrow_t&) noexcept { counted_free(p, true); }
+void operator delete[](void* p, ::std::align_val_t, const ::std::nothrow_t&) noexcept { counted_free(p, true); }
+# endif
+#endif
+
+
+void SelfProfile_Start(const ::std::string& outfile)
+{
+    auto& s = state();
+    s.outfile = outfile;
+    s.start_time = ::std::chrono::steady_clock::now();
+    g_self_profile_enabled = true;
+    // Also write out the results if compilation stops early (e.g. due to an error)
+    ::std::atexit(SelfProfile_Finish);
+}
+
+void SelfProfile_Finish()
+{
+    auto& s = state();
+    if( !g_self_profile_enabled || s.finished )
+        return ;
+    g_self_profile_enabled = false;
+    ::std::lock_guard<::std::mutex>   lh { s.lock };
+    s.finished = true;
+
+    ::std::ofstream os(s.outfile);
+    if( !os.good() )
+    {
+        ::std::cerr << "Unable to open self-profile output '" << s.outfile << "'" << ::std::endl;
+        return ;
+    }
+    os << "{\"traceEvents\":[\n";
+    for(size_t i = 0; i < s.events.size(); i ++)
+    {
+        const auto& e = s.events[i];
+        os << "{\"name\":" << JsonStr { e.name } << ",\"cat\":\"" << e.category << "\",\"ph\":\"X\""
+            << ",\"ts\":" << e.start_us << ",\"dur\":" << e.dur_us << ",\"pid\":1,\"tid\":" << e.tid
+            << ",\"args\":{\"cpu_us\":" << e.cpu_us;
+        if( COUNT_ALLOCS ) {
+            os << ",\"allocs\":" << e.allocs;
+        }
+        if( e.is_phase ) {
+            os << ",\"peak_rss_kb\":" << e.peak_rss_kb;
+        }
+        os << "}}" << (i+1 < s.events.size() ? ",\n" : "\n");
+    }
+    os << "],\"displayTimeUnit\":\"ms\"}\n";
+    os.close();
+
+    // Summary: phases (in order), then the most expensive items
+    ::std::cout << "Self-profile written to " << s.outfile << ::std::endl;
+    ::std::cout << "      Wall       CPU     Allocs  Peak RSS  Phase" << ::std::endl;
+    ::std::vector<const Event*> items;
+    ::std::map<::std::string, ::std::pair<uint64_t,size_t>>  category_totals;
+    for(const auto& e : s.events)
+    {
+        if( e.is_phase ) {
+            ::std::cout << Secs { e.dur_us } << " " << Secs { e.cpu_us } << " " << Allocs { e.allocs }
+                << " " << ::std::setw(6) << e.peak_rss_kb / 1024 << " MB  " << e.name << ::std::endl;
+        }
+        else {
+            items.push_back(&e);
+            auto& t = category_totals[e.category];
+            t.first += e.dur_us;
+            t.second += 1;
+        }
+    }
+    if( !items.empty() )
+    {
+        auto n = ::std::min(TOP_N_ITEMS, items.size());
+        ::std::partial_sort(items.begin(), items.begin() + n, items.end(), [](const Event* a, const Event* b){ return a->dur_us > b->dur_us; });
+        ::std::cout << "Top " << n << " items by wall time:" << ::std::endl;
+        ::std::cout << "      Wall       CPU     Allocs  Item" << ::std::endl;
+        for(size_t i = 0; i < n; i ++)
+        {
+            const auto& e = *items[i];
+            ::std::cout << Secs { e.dur_us } << " " << Secs { e.cpu_us } << " " << Allocs { e.allocs }
+                << "  [" << e.category << "] " << e.name << ::std::endl;
+        }
+        ::std::cout << "Item totals (inclusive of nested items):" << ::std::endl;
+        for(const auto& t : category_totals)
+        {
+            ::std::cout << Secs { t.second.first } << "  " << t.first << " (" << t.second.second << " items)" << ::std::endl;
+        }
+    }
+}
+
+ProfileScope::ProfileScope(const char* phase_name):
+    m_active(false)
+{
+    if( g_self_profile_enabled ) {
+        start("phase", phase_name, true);
+    }
+}
+void ProfileScope::start(const char* category, ::std::string name, bool is_phase)
+{
+    m_active = true;
+    m_is_phase = is_phase;
+    m_category = category;
+    m_name = ::std::move(name);
+    m_start_cpu_us = is_phase ? process_cpu_us() : thread_cpu_us();
+    m_start_allocs = is_phase ? s_total_allocs.load() : t_thread_allocs;
+    m_start_wall_us = wall_us();
+}
+ProfileScope::~ProfileScope()
+{
+    if( !m_active || !g_self_profile_enabled )
+        return ;
+    Event   e;
+    e.dur_us = wall_us() - m_start_wall_us;
+    e.cpu_us = (m_is_phase ? process_cpu_us() : thread_cpu_us()) - m_start_cpu_us;
+    e.allocs = (m_is_phase ? s_total_allocs.load() : t_thread_allocs) - m_start_allocs;
+    e.peak_rss_kb = m_is_phase ? peak_rss_kb() : 0;
+    e.category = m_category;
+    e.name = ::std::move(m_name);
+    e.is_phase = m_is_phase;
+    e.tid = cur_tid();
+    e.start_us = m_start_wall_us;
+
+    auto& s = state();
+    ::std::lock_guard<::std::mutex>   lh { s.lock };
+    if( !s.finished ) {
+        s.events.push_back(::std::move(e));
+    }
+}
@@ -206,6 +206,7 @@ void Trans_AutoImpl_Clone(State& state, ::HIR::TypeRef ty)
     auto& list = state.crate.m_trait_impls[state.lang_Clone].get_list_for_type_mut(impl.m_type);
     list.push_back( box$(impl) );
     state.crate.m_all_trait_impls[state.lang_Clone].get_list_for_type_mut(list.back()->m_type).push_back( list.back().get() );
+    state.crate.m_impl_generation ++;
 }
 
 namespace {
@@ -431,6 +432,7 @@ void Trans_AutoImpls(::HIR::Crate& crate, TransList& trans_list)
             auto& list = state.crate.m_trait_impls[lang_FnPtr].get_list_for_type_mut(impl.m_type);
             list.push_back( box$(impl) );
             state.crate.m_all_trait_impls[lang_FnPtr].get_list_for_type_mut(list.back()->m_type).push_back( list.back().get() );
+            state.crate.m_impl_generation ++;
 
 
             // - Add this function to the TransList
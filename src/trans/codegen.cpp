@@ -12,6 +12,7 @@
 #include <mir/operations.hpp>
 #include <algorithm>
 #include "target.hpp"
+#include <self_profile.hpp>
 
 #include "codegen.hpp"
 #include "monomorphise.hpp"
@@ -21,13 +22,13 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
     static Span sp;
 
     ::std::unique_ptr<CodeGenerator>    codegen;
-    if( opt.mode == "monomir" )
+    if( opt.mode == "monomir" || opt.mode == "monomir-bin" )
     {
-        codegen = Trans_Codegen_GetGenerator_MonoMir(crate, outfile);
+        codegen = Trans_Codegen_GetGenerator_MonoMir(crate, outfile, opt.mode == "monomir-bin");
     }
     else if( opt.mode == "c" )
     {
-        codegen = Trans_Codegen_GetGeneratorC(crate, outfile);
+        codegen = Trans_Codegen_GetGeneratorC(crate, outfile, opt);
     }
     else
     {
@@ -151,52 +152,121 @@ void Trans_Codegen(const ::std::string& outfile, CodegenOutput out_ty, const Tra
             codegen->emit_static_ext(ent.first, stat, ent.second->pp);
         }
     }
-    for(const auto& ent : list.m_statics)
-    {
-        DEBUG("STATIC " << ent.first);
-        assert(ent.second->ptr);
-        const auto& stat = *ent.second->ptr;
+    auto emit_static_value = [&](const ::HIR::Path& path, const TransList_Static& ent) {
+        DEBUG("STATIC " << path);
+        assert(ent.ptr);
+        const auto& stat = *ent.ptr;
 
         if( stat.m_params.is_generic() )
         {
-            codegen->emit_static_local(ent.first, stat, ent.second->pp, stat.m_monomorph_cache.at(ent.first));
+            codegen->emit_static_local(path, stat, ent.pp, stat.m_monomorph_cache.at(path));
         }
         else if( stat.m_value_generated && !stat.m_no_emit_value )
         {
-            codegen->emit_static_local(ent.first, stat, ent.second->pp, stat.m_value_res);
+            codegen->emit_static_local(path, stat, ent.pp, stat.m_value_res);
         }
         else
         {
         }
-    }
-    list.m_statics.clear();
+        };
+    auto has_code = [](const TransList_Function& ent) {
+        return ent.ptr && ent.ptr->m_code.m_mir && !ent.force_prototype;
+        };
+    auto emit_function_code = [&](const ::HIR::Path& path, const TransList_Function& ent) {
+        const auto& fcn = *ent.ptr;
+        const auto& pp = ent.pp;
+        TRACE_FUNCTION_F(path);
+        PROFILE_ITEM("Codegen", path);
+        DEBUG("FUNCTION CODE " << path);
+        // `is_extern` is set if there's no HIR (i.e. this function is from an external crate)
+        bool is_extern = ! static_cast<bool>(fcn.m_code);
+        // If this is a provided trait method, it needs to be monomorphised too.
+        bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef::new_self();}) );
 
-    // 4. Emit function code
-    for(const auto& ent : list.m_functions)
+        bool is_monomorph = pp.has_types() || is_method;
+        if( ent.monomorphised.code ) {
+            // TODO: Flag that this should be a weak (or weak-er) symbol?
+            // - If it's from an external crate, it should be weak, but what about local ones?
+            codegen->emit_function_code(path, fcn, pp, is_extern,  ent.monomorphised.code);
+        }
+        else {
+            ASSERT_BUG(sp, !is_monomorph, "Function that required monomorphisation wasn't monomorphised");
+            codegen->emit_function_code(path, fcn, pp, is_extern,  fcn.m_code.m_mir);
+        }
+        };
+
+    if( opt.codegen_units <= 1 )
     {
-        if( ent.second->ptr && ent.second->ptr->m_code.m_mir && !ent.second->force_prototype )
+        for(const auto& ent : list.m_statics)
         {
-            const auto& path = ent.first;
-            const auto& fcn = *ent.second->ptr;
-            const auto& pp = ent.second->pp;
-            TRACE_FUNCTION_F(path);
-            DEBUG("FUNCTION CODE " << path);
-            // `is_extern` is set if there's no HIR (i.e. this function is from an external crate)
-            bool is_extern = ! static_cast<bool>(fcn.m_code);
-            // If this is a provided trait method, it needs to be monomorphised too.
-            bool is_method = ( fcn.m_args.size() > 0 && visit_ty_with(fcn.m_args[0].second, [&](const auto& x){return x == ::HIR::TypeRef::new_self();}) );
+            emit_static_value(ent.first, *ent.second);
+        }
+        list.m_statics.clear();
 
-            bool is_monomorph = pp.has_types() || is_method;
-            if( ent.second->monomorphised.code ) {
-                // TODO: Flag that this should be a weak (or weak-er) symbol?
-                // - If it's from an external crate, it should be weak, but what about local ones?
-                codegen->emit_function_code(path, fcn, pp, is_extern,  ent.second->monomorphised.code);
+        // 4. Emit function code
+        for(const auto& ent : list.m_functions)
+        {
+            if( has_code(*ent.second) )
+            {
+                emit_function_code(ent.first, *ent.second);
             }
-            else {
-                ASSERT_BUG(sp, !is_monomorph, "Function that required monomorphisation wasn't monomorphised");
-                codegen->emit_function_code(path, fcn, pp, is_extern,  fcn.m_code.m_mir);
+        }
+    }
+    else
+    {
+        // Split the statics and function bodies into `codegen_units` groups of roughly equal size
+        // - Greedy: each item goes into the currently smallest unit (in list order, so the split is deterministic)
+        ::std::vector<size_t>   unit_weights(opt.codegen_units);
+        auto pick_unit = [&](size_t weight)->unsigned {
+            unsigned rv = 0;
+            for(unsigned i = 1; i < unit_weights.size(); i ++)
+            {
+                if( unit_weights[i] < unit_weights[rv] )
+                    rv = i;
+            }
+            unit_weights[rv] += weight;
+            return rv;
+            };
+        ::std::vector<unsigned> static_units;
+        for(size_t i = 0; i < list.m_statics.size(); i ++)
+        {
+            static_units.push_back( pick_unit(1) );
+        }
+        ::std::vector<unsigned> function_units;
+        for(const auto& ent : list.m_functions)
+        {
+            if( has_code(*ent.second) )
+            {
+                const auto& code = ent.second->monomorphised.code ? ent.second->monomorphised.code : ent.second->ptr->m_code.m_mir;
+                size_t weight = 1;
+                for(const auto& bb : code->blocks)
+                    weight += bb.statements.size() + 1;
+                function_units.push_back( pick_unit(weight) );
+            }
+            else
+            {
+                function_units.push_back( ~0u );
+            }
+        }
+        DEBUG("Codegen unit weights: " << unit_weights);
+
+        for(unsigned unit = 0; unit < opt.codegen_units; unit ++)
+        {
+            codegen->begin_codegen_unit(unit);
+            size_t i = 0;
+            for(const auto& ent : list.m_statics)
+            {
+                if( static_units[i++] == unit )
+                    emit_static_value(ent.first, *ent.second);
+            }
+            i = 0;
+            for(const auto& ent : list.m_functions)
+            {
+                if( function_units[i++] == unit )
+                    emit_function_code(ent.first, *ent.second);
             }
         }
+        list.m_statics.clear();
     }
     list.m_functions.clear();
 
@@ -30,6 +30,10 @@ public:
     virtual ~CodeGenerator() {}
     virtual void finalise(const TransOptions& opt, CodegenOutput out_ty, const ::std::string& hir_file) {}
 
+    // Called (when `codegen_units` is above one) before the statics/functions of each unit are emitted
+    // - Everything emitted before the first call is shared by all units (types, prototypes)
+    virtual void begin_codegen_unit(size_t idx) {}
+
     // Called on all types directly mentioned (e.g. variables, arguments, and fields)
     // - Inner-most types are visited first.
     virtual void emit_type_proto(const ::HIR::TypeRef& ) {}
@@ -55,6 +59,6 @@ public:
     virtual void emit_global_asm(const ::HIR::GlobalAssembly& ) = 0;
 };
 
-extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile);
-extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile);
+extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt);
+extern ::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile, bool binary);
 
@@ -20,6 +20,14 @@
 #include "allocator.hpp"
 #include <iomanip>
 #include "target_version.hpp"
+#include <thread>
+#include <mutex>
+#include <jobserver.h>
+#ifdef _WIN32
+# include <direct.h>    // _getcwd
+#else
+# include <unistd.h>    // getcwd
+#endif
 
 namespace {
     struct FmtShell
@@ -200,6 +208,154 @@ namespace {
         return rv;
     }
 
+    /// Build the shell command for a compiler invocation (using an argument file for the arguments from `arg_file_start`)
+    ::std::string make_command(const StringList& args, size_t arg_file_start, const ::std::string& command_file, bool is_windows)
+    {
+        ::std::stringstream cmd_ss;
+        if (is_windows)
+        {
+            cmd_ss << "echo \"\" & ";
+        }
+        std::ofstream   command_file_stream;
+        if( getenv("MRUSTC_CCACHE") ) {
+            cmd_ss << "ccache ";
+        }
+        bool use_arg_file = arg_file_start > 0;
+        if(use_arg_file) {
+            command_file_stream.open(command_file);
+            ASSERT_BUG(Span(), command_file_stream.is_open(), "Failed to open command file `" << command_file << "` for writing");
+        }
+        size_t i = -1;
+        for(const auto& arg : args.get_vec())
+        {
+            i ++;
+            auto& out_ss = (use_arg_file && i >= arg_file_start ? static_cast<::std::ostream&>(command_file_stream) : cmd_ss);
+            if(strcmp(arg, "&") == 0 && is_windows) {
+                out_ss << "&";
+            }
+            else {
+                if( is_windows && strchr(arg, ' ') == nullptr ) {
+                    out_ss << arg << " ";
+                }
+                else {
+                    out_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
+                }
+            }
+        }
+        if(use_arg_file) {
+            cmd_ss << "@\"" << FmtShell(command_file, is_windows) << "\"";
+            command_file_stream.close();
+            ASSERT_BUG(Span(), !command_file_stream.bad(), "Error set on output stream for: " << command_file);
+        }
+        return cmd_ss.str();
+    }
+    /// Absolute path of the directory containing `path`
+    ::std::string get_absolute_dir(const ::std::string& path)
+    {
+        auto slash_pos = path.find_last_of("/\\");
+        if( slash_pos == 0 )
+            return path.substr(0, 1);
+        auto dir = (slash_pos == ::std::string::npos ? ::std::string() : path.substr(0, slash_pos));
+        if( dir != "" && (dir[0] == '/' || dir[0] == '\\' || (dir.size() > 1 && dir[1] == ':')) )
+            return dir;
+        char cwd[4096];
+#ifdef _WIN32
+        bool ok = _getcwd(cwd, sizeof(cwd)) != nullptr;
+#else
+        bool ok = getcwd(cwd, sizeof(cwd)) != nullptr;
+#endif
+        ASSERT_BUG(Span(), ok, "Unable to get the current directory");
+        return dir == "" ? ::std::string(cwd) : ::std::string(cwd) + "/" + dir;
+    }
+    /// Run a compiler command, returning `false` (after printing a message) if it failed
+    bool run_command(const ::std::string& cmd)
+    {
+        static ::std::mutex output_lock;
+        {
+            ::std::lock_guard<::std::mutex> lh(output_lock);
+            //DEBUG("- " << cmd);
+            ::std::cout << "Running command - " << cmd << ::std::endl;
+        }
+        int ec = system(cmd.c_str());
+        if( ec == -1 )
+        {
+            ::std::lock_guard<::std::mutex> lh(output_lock);
+            ::std::cerr << "C Compiler failed to execute (system returned -1)" << ::std::endl;
+            perror("system");
+            return false;
+        }
+        else if( ec != 0 )
+        {
+            ::std::lock_guard<::std::mutex> lh(output_lock);
+            ::std::cerr << "C Compiler failed to execute - error code " << ec << ::std::endl;
+            return false;
+        }
+        return true;
+    }
+    /// Run independent commands (codegen unit compilation) concurrently
+    /// - If there's a make jobserver, each worker past the first holds a token from it
+    bool run_commands_parallel(const ::std::vector<::std::string>& commands)
+    {
+        auto jobserver = JobServer::create(0);
+        ::std::mutex    lock;
+        size_t  next_command = 0;
+        bool    failed = false;
+
+        auto worker = [&](bool needs_token) {
+            if( needs_token )
+            {
+                // Wait for a token, giving up if there's nothing left to run
+                for(;;)
+                {
+                    ::std::lock_guard<::std::mutex> lh(lock);
+                    if( failed || next_command == commands.size() )
+                        return ;
+                    if( jobserver->take_one(50) )
+                        break;
+                }
+            }
+            for(;;)
+            {
+                size_t idx;
+                {
+                    ::std::lock_guard<::std::mutex> lh(lock);
+                    if( failed || next_command == commands.size() )
+                        break;
+                    idx = next_command ++;
+                }
+                if( !run_command(commands[idx]) )
+                {
+                    ::std::lock_guard<::std::mutex> lh(lock);
+                    failed = true;
+                }
+            }
+            if( needs_token )
+            {
+                ::std::lock_guard<::std::mutex> lh(lock);
+                jobserver->return_one();
+            }
+            };
+
+        size_t n_workers = commands.size();
+        if( !jobserver )
+        {
+            // No jobserver, limit to the number of host threads
+            n_workers = ::std::min(n_workers, static_cast<size_t>(::std::max(1u, ::std::thread::hardware_concurrency())));
+        }
+        ::std::vector<::std::thread>    workers;
+        for(size_t i = 1; i < n_workers; i ++)
+        {
+            workers.push_back(::std::thread(worker, static_cast<bool>(jobserver)));
+        }
+        // This thread uses the token implicitly held by this process
+        worker(false);
+        for(auto& t : workers)
+        {
+            t.join();
+        }
+        return !failed;
+    }
+
     enum class AtomicOp
     {
         Add,
@@ -229,34 +385,178 @@ namespace {
         ::StaticTraitResolve    m_resolve;
 
         ::std::string   m_outfile_path;
+        /// Number of codegen units, if above one then `m_outfile_path_c` is a header shared by the units
+        unsigned        m_codegen_unit_count;
         ::std::string   m_outfile_path_c;
+        /// Output paths (without extension) of the codegen units emitted so far
+        ::std::vector<::std::string>    m_codegen_unit_paths;
 
         ::std::ofstream m_of;
         const ::MIR::TypeResolve* m_mir_res = nullptr;
 
         Compiler    m_compiler = Compiler::Gcc;
+        /// The GNU C compiler is actually clang (e.g. `cc` on macOS and FreeBSD), which lacks some GCC extensions
+        bool    m_compiler_is_clang = false;
         struct {
             bool emulated_i128 = false;
             bool disallow_empty_structs = false;
+            /// Emit landing pads and unwind with `_Unwind_ForcedUnwind` (`-C unwind=tables`)
+            bool unwind_tables = false;
+            /// Emit branch hints, `restrict` and function attributes (`-Z c-annotations`)
+            bool annotations = false;
+            /// Compile to LTO objects, and optimise across crates when linking (`-C lto`)
+            bool lto = false;
+            /// Name profiles after the object instead of its full path (`-fprofile-prefix-path`, GCC 11+)
+            bool profile_prefix_path = false;
         } m_options;
 
 
         ::std::set< ::HIR::TypeRef> m_emitted_fn_types;
         ::std::set< const TypeRepr*>    m_embedded_tags;
+        /// GCC vector typedefs emitted so far (see `SimdInfo::emit_vector_typedefs`)
+        ::std::set< ::std::string>  m_emitted_vector_types;
+        /// Cache of if a called function is `#[cold]` and never returns (see `get_cold_blocks`)
+        mutable ::std::map< ::HIR::Path, bool>  m_cold_noreturn_fcns;
+
+        /// Element layout of a `repr(simd)` type
+        struct SimdInfo {
+            unsigned count;
+            unsigned item_size;
+            unsigned align;
+            enum Ty {
+                Float,
+                Signed,
+                Unsigned,
+            } ty;
+            /// The struct has a GCC vector member (`VEC`, overlapping the fields) that the intrinsics operate on
+            bool is_vector;
+
+            static SimdInfo for_ty(const CodeGenerator_C& self, const HIR::TypeRef& ty) {
+                const auto* ty_repr = Target_GetTypeRepr(self.sp, self.m_mir_res->m_resolve, ty);
+                MIR_ASSERT(*self.m_mir_res, ty_repr, "No repr for " << ty);
+                size_t size_slot = ty_repr->size;
+                const auto& ity = ty_repr->fields[0].ty;
+                DEBUG("SimdInfo Type: " << ity);
+                const auto& ty_val = ity.data().is_Primitive()
+                        ? ity
+                        : ty_repr->fields[0].ty.data().as_Array().inner
+                        ;
+                DEBUG("ty_val = " << ty_val);
+                size_t size_val = 0;
+                MIR_ASSERT(*self.m_mir_res, Target_GetSizeOf(self.sp, self.m_resolve, ty_val, size_val), ty_val);
+
+                MIR_ASSERT(*self.m_mir_res, size_slot >= size_val, size_slot << " < " << size_val);
+                MIR_ASSERT(*self.m_mir_res, size_val > 0, "SimdInfo::for_ty - Value type " << ty_val << " was a ZST");
+                MIR_ASSERT(*self.m_mir_res, size_slot / size_val * size_val == size_slot, size_slot << " not a multiple of " << size_val);
+
+                SimdInfo    rv;
+                rv.item_size = size_val;
+                rv.align = ty_repr->align;
+                rv.count = size_slot == 0 ? 0 : size_slot / size_val;
+                switch(ty_val.data().as_Primitive())
+                {
+                case ::HIR::CoreType::I8:   rv.ty = Signed; break;
+                case ::HIR::CoreType::I16:  rv.ty = Signed; break;
+                case ::HIR::CoreType::I32:  rv.ty = Signed; break;
+                case ::HIR::CoreType::I64:  rv.ty = Signed; break;
+                //case ::HIR::CoreType::I128: rv.ty = Signed; break;
+                case ::HIR::CoreType::U8:   rv.ty = Unsigned; break;
+                case ::HIR::CoreType::U16:  rv.ty = Unsigned; break;
+                case ::HIR::CoreType::U32:  rv.ty = Unsigned; break;
+                case ::HIR::CoreType::U64:  rv.ty = Unsigned; break;
+                //case ::HIR::CoreType::U128: rv.ty = Unsigned; break;
+                case ::HIR::CoreType::F32:  rv.ty = Float;  break;
+                case ::HIR::CoreType::F64:  rv.ty = Float;  break;
+                default:
+                    MIR_BUG(*self.m_mir_res, "Invalid SIMD type inner - " << ty_val);
+                }
+                rv.is_vector = is_vector_type(self, ty) && rv.count >= 2 && (rv.count & (rv.count - 1)) == 0;
+                return rv;
+            }
+            /// Check if the type can be emitted as a vector (before calling `for_ty`, which fails on unsupported elements)
+            static bool is_vector_type(const CodeGenerator_C& self, const HIR::TypeRef& ty) {
+                // Needs GCC's vector extensions (clang has no `__builtin_shuffle`)
+                if( self.m_compiler != Compiler::Gcc || self.m_compiler_is_clang )
+                    return false;
+                if( !ty.data().is_Path() || !ty.data().as_Path().binding.is_Struct() )
+                    return false;
+                if( ty.data().as_Path().binding.as_Struct()->m_repr != ::HIR::Struct::Repr::Simd )
+                    return false;
+                const auto* ty_repr = Target_GetTypeRepr(self.sp, self.m_resolve, ty);
+                if( !ty_repr || ty_repr->fields.empty() )
+                    return false;
+                const auto& ity = ty_repr->fields[0].ty;
+                const auto& ty_val = ity.data().is_Array() ? ity.data().as_Array().inner : ity;
+                if( !ty_val.data().is_Primitive() )
+                    return false;
+                switch(ty_val.data().as_Primitive())
+                {
+                case ::HIR::CoreType::I8: case ::HIR::CoreType::I16: case ::HIR::CoreType::I32: case ::HIR::CoreType::I64:
+                case ::HIR::CoreType::U8: case ::HIR::CoreType::U16: case ::HIR::CoreType::U32: case ::HIR::CoreType::U64:
+                case ::HIR::CoreType::F32: case ::HIR::CoreType::F64:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+            void emit_val_ty(CodeGenerator_C& self) const {
+                switch(ty)
+                {
+                case Float: self.m_of << (item_size == 4 ? "float" : "double"); break;
+                case Signed:    self.m_of << "int" << (item_size*8) << "_t";    break;
+                case Unsigned:  self.m_of << "uint" << (item_size*8) << "_t";   break;
+                }
+            }
+            /// Name of the vector typedef for a lane type (e.g. `VEC_f32x4_a4`)
+            /// - The alignment is part of the name, as it's set on the typedef
+            ::std::string vec_ty_name(Ty lane_ty) const {
+                return FMT("VEC_" << (lane_ty == Float ? "f" : lane_ty == Signed ? "i" : "u") << (item_size*8) << "x" << count << "_a" << align);
+            }
+            void emit_vec_ty(CodeGenerator_C& self) const {
+                self.m_of << vec_ty_name(ty);
+            }
+            /// Name of the signed integer vector with the same lane layout (the result of a vector comparison)
+            void emit_mask_ty(CodeGenerator_C& self) const {
+                self.m_of << vec_ty_name(Signed);
+            }
+            /// Emit the typedefs for the vector and mask types (only once per layout)
+            /// - Alignment is reduced to the struct's (i.e. the element's), so the layout is unchanged
+            void emit_vector_typedefs(CodeGenerator_C& self) const {
+                assert(is_vector);
+                SimdInfo    mask = *this;
+                mask.ty = Signed;
+                for(const SimdInfo* i : { this, static_cast<const SimdInfo*>(&mask) })
+                {
+                    auto name = i->vec_ty_name(i->ty);
+                    if( !self.m_emitted_vector_types.insert(name).second )
+                        continue ;
+                    self.m_of << "typedef "; i->emit_val_ty(self);
+                    self.m_of << " " << name << " __attribute__((vector_size(" << (i->item_size * i->count) << "), aligned(" << i->align << ")));\n";
+                }
+            }
+        };
     public:
-        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile):
+        CodeGenerator_C(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt):
             m_crate(crate),
             m_resolve(crate),
             m_outfile_path(outfile),
-            m_outfile_path_c(outfile + ".c"),
+            // NOTE: Codegen units need the GCC-only `ld -r` and hidden symbols
+            // - Not used with LTO, as `ld -r` and `objcopy` only see the non-LTO code (and gcc partitions the LTO unit itself)
+            m_codegen_unit_count(Target_GetCurSpec().m_backend_c.m_codegen_mode == CodegenMode::Gnu11 && !opt.lto ? ::std::max(1u, opt.codegen_units) : 1),
+            m_outfile_path_c(outfile + (m_codegen_unit_count > 1 ? ".h" : ".c")),
             m_of(m_outfile_path_c)
         {
             ASSERT_BUG(Span(), m_of.is_open(), "Failed to open `" << m_outfile_path_c << "` for writing");
+            if( opt.codegen_units > 1 && m_codegen_unit_count == 1 && !opt.lto )
+            {
+                WARNING(Span(), W0000, "Codegen units are not supported for this target, emitting a single C file");
+            }
             m_options.emulated_i128 = Target_GetCurSpec().m_backend_c.m_emulated_i128;
             switch(Target_GetCurSpec().m_backend_c.m_codegen_mode)
             {
             case CodegenMode::Gnu11:
                 m_compiler = Compiler::Gcc;
+                m_compiler_is_clang = (system((get_compiler_exe() + " -dM -E -x c /dev/null 2>/dev/null | grep -q __clang__").c_str()) == 0);
                 if( Target_GetCurSpec().m_arch.m_pointer_bits < 64 && !m_options.emulated_i128 )
                 {
                     WARNING(Span(), W0000, "Potentially misconfigured target, 32-bit targets require i128 emulation");
@@ -272,6 +572,47 @@ namespace {
                 m_options.disallow_empty_structs = true;
                 break;
             }
+            if( opt.unwind_tables )
+            {
+                // Landing pads are GCC nested functions run via `__attribute__((cleanup))` (which clang doesn't support)
+                if( m_compiler == Compiler::Gcc && !m_compiler_is_clang )
+                {
+                    m_options.unwind_tables = true;
+                }
+                else
+                {
+                    WARNING(Span(), W0000, "Table-based unwinding is only supported when compiling with GCC, using setjmp/longjmp");
+                }
+            }
+            if( opt.lto )
+            {
+                if( m_compiler == Compiler::Gcc )
+                {
+                    m_options.lto = true;
+                }
+                else
+                {
+                    WARNING(Span(), W0000, "LTO is only supported by the GCC backend");
+                }
+            }
+            if( opt.profile_generate != "" || opt.profile_use != "" )
+            {
+                if( m_compiler != Compiler::Gcc )
+                {
+                    WARNING(Span(), W0000, "Profile-guided optimisation is only supported by the GCC backend");
+                }
+                else
+                {
+                    // Older GCCs (and clang) reject the option instead of ignoring it, so check for it first
+                    m_options.profile_prefix_path = (system((get_compiler_exe() + " -fprofile-prefix-path=/ -E -x c /dev/null >/dev/null 2>&1").c_str()) == 0);
+                    if( !m_options.profile_prefix_path )
+                    {
+                        WARNING(Span(), W0000, "C compiler doesn't support -fprofile-prefix-path (needs GCC 11), profiles will be named after the full output path");
+                    }
+                }
+            }
+            // NOTE: Silently ignored for MSVC, as it's enabled by default when optimising
+            m_options.annotations = opt.c_annotations && m_compiler == Compiler::Gcc;
 
             m_of
                 << "/*\n"
@@ -353,8 +694,17 @@ namespace {
             case Compiler::Gcc:
                 m_of
                     << "extern __thread jmp_buf*    mrustc_panic_target;\n"
+                    << "extern __thread void* mrustc_panic_target_frame;\n"
                     << "extern __thread void* mrustc_panic_value;\n"
                     ;
+                if( m_options.unwind_tables )
+                {
+                    // NOTE: Not using `unwind.h`, as `_Unwind_Resume` is declared above without arguments
+                    m_of
+                        << "extern int _Unwind_ForcedUnwind(void*, int (*)(int, int, uint64_t, void*, void*, void*), void*);\n"
+                        << "extern uintptr_t _Unwind_GetCFA(void*);\n"
+                        ;
+                }
                 // 64-bit bit ops (gcc intrinsics)
                 m_of
                     << "static inline uint64_t __builtin_clz64(uint64_t v) {\n"
@@ -829,6 +1179,95 @@ namespace {
 
         ~CodeGenerator_C() {}
 
+        /// Pick the GNU C compiler
+        /// - from `CC_${TRIPLE}` environment variable, with all '-' in TRIPLE replaced by '_'
+        /// - from the `CC` environment variable
+        /// - `${TRIPLE}-gcc` (if available)
+        /// - `gcc` as fallback
+        static ::std::string get_compiler_exe()
+        {
+            std::string varname = "CC_" +  Target_GetCurSpec().m_backend_c.m_c_compiler;
+            std::replace(varname.begin(), varname.end(), '-', '_');
+
+            if( getenv(varname.c_str()) ) {
+                return getenv(varname.c_str());
+            }
+            else if( getenv("CC") ) {
+                return getenv("CC");
+            }
+            else if (system(("command -v " + Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc" + " >/dev/null 2>&1").c_str()) == 0) {
+                return Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc";
+            }
+            else {
+                return "gcc";
+            }
+        }
+        /// Push the compiler and the options shared by all GCC invocations (returns the start of the argument-file arguments)
+        size_t push_gcc_compile_args(StringList& args, const TransOptions& opt) const
+        {
+            args.push_back( get_compiler_exe() );
+            size_t arg_file_start = args.get_vec().size();
+            for( const auto& a : Target_GetCurSpec().m_backend_c.m_compiler_opts )
+            {
+                args.push_back( a.c_str() );
+            }
+            args.push_back("-Wno-psabi");   // Suppress "note: the ABI for passing parameters with 128-byte alignment has changed in GCC 4.6"
+            switch(opt.opt_level)
+            {
+            case 0: break;
+            case 1:
+                args.push_back("-O1");
+                break;
+            case 2:
+                //args.push_back("-O2");
+                args.push_back("-O1");  // HACK: Work around mrustc #347 by reducing the optimisation level
+                break;
+            }
+            // HACK: Work around [https://gcc.gnu.org/bugzilla/show_bug.cgi?id=117423] by disabling an optimisation stage
+            if( opt.opt_level > 0 )
+            {
+                args.push_back("-fno-tree-sra");
+            }
+            if( opt.emit_debug_info )
+            {
+                args.push_back("-g");
+            }
+            if( m_options.unwind_tables )
+            {
+                // Needed for `__attribute__((cleanup))` to run while unwinding
+                args.push_back("-fexceptions");
+            }
+            if( m_options.lto )
+            {
+                // Objects carry both LTO bytecode and normal code, so they can still be linked into non-LTO builds
+                args.push_back("-flto=auto");
+                args.push_back("-ffat-lto-objects");
+            }
+            if( opt.profile_generate != "" || opt.profile_use != "" )
+            {
+                if( opt.profile_generate != "" )
+                {
+                    args.push_back("-fprofile-generate=" + opt.profile_generate);
+                    // Instrumented programs may be multi-threaded
+                    args.push_back("-fprofile-update=prefer-atomic");
+                }
+                else
+                {
+                    args.push_back("-fprofile-use=" + opt.profile_use);
+                }
+                // Name the profile files after the objects (e.g. `liba-0_1_0.rlib.gcda`) instead of their full path
+                // NOTE: The generated C still has to be at the same path when the profiles are used (the source location is
+                // part of the checksum)
+                if( m_options.profile_prefix_path )
+                {
+                    args.push_back("-fprofile-prefix-path=" + get_absolute_dir(m_outfile_path));
+                }
+            }
+            // TODO: Why?
+            args.push_back("-fPIC");
+            return arg_file_start;
+        }
+
         void finalise(const TransOptions& opt, CodegenOutput out_ty, const ::std::string& hir_file) override
         {
             const bool create_shims = (out_ty == CodegenOutput::Executable);
@@ -874,6 +1313,7 @@ namespace {
                 {
                     m_of
                         << "__thread jmp_buf* mrustc_panic_target;\n"
+                        << "__thread void* mrustc_panic_target_frame;\n"
                         << "__thread void* mrustc_panic_value;\n"
                         ;
                 }
@@ -1016,7 +1456,7 @@ namespace {
 
             m_of.flush();
             m_of.close();
-            ASSERT_BUG(Span(), !m_of.bad(), "Error set on output stream for: " << m_outfile_path_c);
+            ASSERT_BUG(Span(), !m_of.bad(), "Error set on output stream for: " << (m_codegen_unit_paths.empty() ? m_outfile_path_c : m_codegen_unit_paths.back() + ".c"));
 
             class LinkList: private StringList
             {
@@ -1255,56 +1695,7 @@ namespace {
             switch( m_compiler )
             {
             case Compiler::Gcc:
-                // Pick the compiler
-                // - from `CC_${TRIPLE}` environment variable, with all '-' in TRIPLE replaced by '_'
-                // - from the `CC` environment variable
-                // - `${TRIPLE}-gcc` (if available)
-                // - `gcc` as fallback
-                {
-                    std::string varname = "CC_" +  Target_GetCurSpec().m_backend_c.m_c_compiler;
-                    std::replace(varname.begin(), varname.end(), '-', '_');
-
-                    if( getenv(varname.c_str()) ) {
-                        args.push_back( getenv(varname.c_str()) );
-                    }
-                    else if( getenv("CC") ) {
-                            args.push_back( getenv("CC") );
-                    }
-                    else if (system(("command -v " + Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc" + " >/dev/null 2>&1").c_str()) == 0) {
-                        args.push_back( Target_GetCurSpec().m_backend_c.m_c_compiler + "-gcc" );
-                    }
-                    else {
-                        args.push_back("gcc");
-                    }
-                }
-                arg_file_start = args.get_vec().size();
-                for( const auto& a : Target_GetCurSpec().m_backend_c.m_compiler_opts )
-                {
-                    args.push_back( a.c_str() );
-                }
-                args.push_back("-Wno-psabi");   // Suppress "note: the ABI for passing parameters with 128-byte alignment has changed in GCC 4.6"
-                switch(opt.opt_level)
-                {
-                case 0: break;
-                case 1:
-                    args.push_back("-O1");
-                    break;
-                case 2:
-                    //args.push_back("-O2");
-                    args.push_back("-O1");  // HACK: Work around mrustc #347 by reducing the optimisation level
-                    break;
-                }
-                // HACK: Work around [https://gcc.gnu.org/bugzilla/show_bug.cgi?id=117423] by disabling an optimisation stage
-                if( opt.opt_level > 0 )
-                {
-                    args.push_back("-fno-tree-sra");
-                }
-                if( opt.emit_debug_info )
-                {
-                    args.push_back("-g");
-                }
-                // TODO: Why?
-                args.push_back("-fPIC");
+                arg_file_start = push_gcc_compile_args(args, opt);
                 args.push_back("-o");
                 switch(out_ty)
                 {
@@ -1317,7 +1708,17 @@ namespace {
                     args.push_back(m_outfile_path+".o");
                     break;
                 }
-                args.push_back(m_outfile_path_c.c_str());
+                if( m_codegen_unit_paths.empty() )
+                {
+                    args.push_back(m_outfile_path_c.c_str());
+                }
+                else
+                {
+                    for(const auto& p : m_codegen_unit_paths)
+                    {
+                        args.push_back(p + ".o");
+                    }
+                }
                 switch(out_ty)
                 {
                 case CodegenOutput::DynamicLibrary:
@@ -1366,7 +1767,16 @@ namespace {
                     break;
                 case CodegenOutput::StaticLibrary:
                 case CodegenOutput::Object:
-                    args.push_back("-c");
+                    if( m_codegen_unit_paths.empty() )
+                    {
+                        args.push_back("-c");
+                    }
+                    else
+                    {
+                        // Merge the unit objects into one relocatable object
+                        args.push_back("-r");
+                        args.push_back("-nostdlib");
+                    }
                     break;
                 }
                 break;
@@ -1461,62 +1871,73 @@ namespace {
                 break;
             }
 
-            ::std::stringstream cmd_ss;
-            if (is_windows)
-            {
-                cmd_ss << "echo \"\" & ";
-            }
-            std::string command_file = m_outfile_path + "_cmd.txt";
-            std::ofstream   command_file_stream;
-            if( getenv("MRUSTC_CCACHE") ) {
-                cmd_ss << "ccache ";
-            }
-            bool use_arg_file = arg_file_start > 0;
-            if(use_arg_file) {
-                command_file_stream.open(command_file);
-                ASSERT_BUG(Span(), command_file_stream.is_open(), "Failed to open command file `" << command_file << "` for writing");
-            }
-            size_t i = -1;
-            for(const auto& arg : args.get_vec())
+            auto cmd = make_command(args, arg_file_start, m_outfile_path + "_cmd.txt", is_windows);
+
+            // Codegen units are compiled separately before the above command merges/links their objects
+            ::std::vector<::std::string>    unit_commands;
+            ::std::string   localise_cmd;
+            if( !m_codegen_unit_paths.empty() )
             {
-                i ++;
-                auto& out_ss = (use_arg_file && i >= arg_file_start ? static_cast<::std::ostream&>(command_file_stream) : cmd_ss);
-                if(strcmp(arg, "&") == 0 && is_windows) {
-                    out_ss << "&";
+                for(const auto& p : m_codegen_unit_paths)
+                {
+                    StringList  unit_args;
+                    size_t unit_arg_file_start = push_gcc_compile_args(unit_args, opt);
+                    unit_args.push_back("-c");
+                    unit_args.push_back("-o");
+                    unit_args.push_back(p + ".o");
+                    unit_args.push_back(p + ".c");
+                    unit_commands.push_back( make_command(unit_args, unit_arg_file_start, p + "_cmd.txt", is_windows) );
                 }
-                else {
-                    if( is_windows && strchr(arg, ' ') == nullptr ) {
-                        out_ss << arg << " ";
+                // Crate-internal symbols were only hidden so they'd resolve between units, make them local once merged
+                if( out_ty == CodegenOutput::Object || out_ty == CodegenOutput::StaticLibrary )
+                {
+                    StringList  objcopy_args;
+                    // Pick objcopy
+                    // - from the `OBJCOPY` environment variable
+                    // - `${TRIPLE}-objcopy` (if available)
+                    // - `objcopy` as fallback
+                    if( getenv("OBJCOPY") ) {
+                        objcopy_args.push_back( getenv("OBJCOPY") );
+                    }
+                    else if (system(("command -v " + Target_GetCurSpec().m_backend_c.m_c_compiler + "-objcopy" + " >/dev/null 2>&1").c_str()) == 0) {
+                        objcopy_args.push_back( Target_GetCurSpec().m_backend_c.m_c_compiler + "-objcopy" );
                     }
                     else {
-                        out_ss << "\"" << FmtShell(arg, is_windows) << "\" ";
+                        objcopy_args.push_back("objcopy");
                     }
+                    objcopy_args.push_back("--localize-hidden");
+                    objcopy_args.push_back(out_ty == CodegenOutput::Object ? m_outfile_path : m_outfile_path + ".o");
+                    localise_cmd = make_command(objcopy_args, 0, "", is_windows);
                 }
             }
-            if(use_arg_file) {
-                cmd_ss << "@\"" << FmtShell(command_file, is_windows) << "\"";
-                command_file_stream.close();
-                ASSERT_BUG(Span(), !command_file_stream.bad(), "Error set on output stream for: " << m_outfile_path_c);
-            }
-            //DEBUG("- " << cmd_ss.str());
-            ::std::cout << "Running command - " << cmd_ss.str() << ::std::endl;
+
             if( opt.build_command_file != "" )
             {
-                ::std::cerr << "INVOKE CC: " << cmd_ss.str() << ::std::endl;
-                ::std::ofstream(opt.build_command_file) << cmd_ss.str() << ::std::endl;
+                ::std::ofstream build_command_os(opt.build_command_file);
+                for(const auto& c : unit_commands)
+                {
+                    ::std::cerr << "INVOKE CC: " << c << ::std::endl;
+                    build_command_os << c << ::std::endl;
+                }
+                ::std::cerr << "INVOKE CC: " << cmd << ::std::endl;
+                build_command_os << cmd << ::std::endl;
+                if( localise_cmd != "" )
+                {
+                    build_command_os << localise_cmd << ::std::endl;
+                }
             }
             else
             {
-                int ec = system(cmd_ss.str().c_str());
-                if( ec == -1 )
+                if( !run_commands_parallel(unit_commands) )
                 {
-                    ::std::cerr << "C Compiler failed to execute (system returned -1)" << ::std::endl;
-                    perror("system");
                     exit(1);
                 }
-                else if( ec != 0 )
+                if( !run_command(cmd) )
+                {
+                    exit(1);
+                }
+                if( localise_cmd != "" && !run_command(localise_cmd) )
                 {
-                    ::std::cerr << "C Compiler failed to execute - error code " << ec << ::std::endl;
                     exit(1);
                 }
             }
@@ -1532,6 +1953,52 @@ namespace {
             }
         }
 
+        void begin_codegen_unit(size_t idx) override
+        {
+            // Codegen units not supported (warned in the constructor), keep writing to the single file
+            if( m_codegen_unit_count <= 1 )
+                return ;
+            const auto& cur_path = m_codegen_unit_paths.empty() ? m_outfile_path_c : m_codegen_unit_paths.back() + ".c";
+            m_of.flush();
+            m_of.close();
+            ASSERT_BUG(Span(), !m_of.bad(), "Error set on output stream for: " << cur_path);
+
+            m_codegen_unit_paths.push_back( FMT(m_outfile_path << ".cgu" << idx) );
+            const auto& path = m_codegen_unit_paths.back() + ".c";
+            m_of.open(path);
+            ASSERT_BUG(Span(), m_of.is_open(), "Failed to open `" << path << "` for writing");
+
+            auto slash_pos = m_outfile_path_c.find_last_of("/\\");
+            m_of
+                << "/*\n"
+                << " * AUTOGENERATED by mrustc (codegen unit " << idx << ")\n"
+                << " */\n"
+                << "#include \"" << (slash_pos == ::std::string::npos ? m_outfile_path_c : m_outfile_path_c.substr(slash_pos+1)) << "\"\n"
+                ;
+        }
+        // Linkage for items private to this crate (functions from other crates, monomorphised statics)
+        // - With codegen units these must be visible to the other units, so are hidden until the objects are merged
+        void emit_private_linkage()
+        {
+            if( m_codegen_unit_count > 1 ) {
+                m_of << "__attribute__((visibility(\"hidden\"))) ";
+            }
+            else {
+                m_of << "static ";
+            }
+        }
+        // Linkage for a function from another crate
+        // - Instances listed in the metadata are used by downstream crates, so are weak (sibling crates may emit the same one)
+        void emit_instance_linkage(const ::HIR::Path& p)
+        {
+            if( m_crate.m_shared_instances.count(p) != 0 ) {
+                m_of << "__attribute__((weak)) ";
+            }
+            else {
+                emit_private_linkage();
+            }
+        }
+
         void emit_box_drop(unsigned indent_level, const ::HIR::TypeRef& inner_type, const ::HIR::TypeRef& box_type, const ::MIR::LValue& slot, bool run_destructor)
         {
             auto indent = RepeatLitStr { "\t", static_cast<int>(indent_level) };
@@ -1727,7 +2194,7 @@ namespace {
         }
 
         // Shared logic between `emit_struct` and `emit_type` (w/ Tuple)
-        void emit_struct_inner(const ::HIR::TypeRef& ty, const TypeRepr* repr, unsigned packing_max_align)
+        void emit_struct_inner(const ::HIR::TypeRef& ty, const TypeRepr* repr, unsigned packing_max_align, const SimdInfo* simd_info=nullptr)
         {
             // Fill `fields` with ascending indexes (for sorting)
             // AND: Determine if the type has a a zero-sized item that has an alignment equal to the structure's alignment
@@ -1781,6 +2248,11 @@ namespace {
                 m_of << "struct ";
             }
             emit_ctype(ty); m_of << " {\n";
+            if( simd_info )
+            {
+                m_of << "\tunion {\n";
+                m_of << "\tstruct {\n";
+            }
 
             bool has_unsized = false;
             size_t sized_fields = 0;
@@ -1870,6 +2342,12 @@ namespace {
             {
                 m_of << "\tchar _d;\n";
             }
+            if( simd_info )
+            {
+                m_of << "\t};\n";
+                m_of << "\t"; simd_info->emit_vec_ty(*this); m_of << " VEC;\n";
+                m_of << "\t};\n";
+            }
             m_of << "}";
             if(has_manual_align)
             {
@@ -2026,7 +2504,20 @@ namespace {
 
             m_of << "// struct " << p << "\n";
 
-            emit_struct_inner(item_ty, repr, item.m_max_field_alignment);
+            // `repr(simd)` types get a GCC vector member overlapping the fields
+            SimdInfo    simd_info;
+            bool is_vector = false;
+            if( SimdInfo::is_vector_type(*this, item_ty) )
+            {
+                simd_info = SimdInfo::for_ty(*this, item_ty);
+                if( simd_info.is_vector )
+                {
+                    simd_info.emit_vector_typedefs(*this);
+                    is_vector = true;
+                }
+            }
+
+            emit_struct_inner(item_ty, repr, item.m_max_field_alignment, is_vector ? &simd_info : nullptr);
 
             if(repr->size > 0 && repr->size != SIZE_MAX )
             {
@@ -2403,6 +2894,10 @@ namespace {
             if(item.m_linkage.type == HIR::Linkage::Type::ExternWeak) {
                 ASSERT_BUG(sp, linkage_name != "", "");
                 m_of << "extern char " << linkage_name << "[0];\n";
+                if( m_codegen_unit_count > 1 ) {
+                    // This is in the shared header, so give each unit its own copy
+                    m_of << "static ";
+                }
                 emit_static_ty(type, p, /*is_proto=*/true);
                 m_of << " = { .raw = { (uintptr_t)" << linkage_name << " } };";
                 m_of << "\t// static " << p << " : " << type;
@@ -2482,8 +2977,12 @@ namespace {
                     break;
                 }
             }
+            if( m_codegen_unit_count > 1 ) {
+                // The definition is in one of the units
+                m_of << "extern ";
+            }
             if( item.m_params.is_generic() ) {
-                m_of << "static ";
+                emit_private_linkage();
             }
             emit_static_ty(type, p, /*is_proto=*/true);
             m_of << ";";
@@ -2504,7 +3003,7 @@ namespace {
             // statics that are zero do not require initializers, since they will be initialized to zero on program startup.
             if( !is_zero_literal(type, encoded, params)) {
                 if( item.m_params.is_generic() ) {
-                    m_of << "static ";
+                    emit_private_linkage();
                 }
                 bool is_packed = emit_static_ty(type, p, /*is_proto=*/false);
                 m_of << " = ";
@@ -2577,6 +3076,14 @@ namespace {
                 m_of << "\t// static " << p << " : " << type << " = " << encoded;
                 m_of << "\n";
             }
+            else if( m_codegen_unit_count > 1 ) {
+                // The prototype was `extern`, so zero statics need a definition too
+                if( item.m_params.is_generic() ) {
+                    emit_private_linkage();
+                }
+                emit_static_ty(type, p, /*is_proto=*/false);
+                m_of << ";\t// Zero init static " << p << " : " << type << "\n";
+            }
             //else {
             //    m_of << "//";
             //    emit_static_ty(type, p, /*is_proto=*/false);
@@ -2800,11 +3307,30 @@ namespace {
             {
                 MIR_ASSERT(*m_mir_res, m_compiler == Compiler::Gcc, item.m_linkage.name << " in non-GCC mode");
                 m_of << "// - Magic compiler impl\n";
+                if( m_options.unwind_tables )
+                {
+                    // Forced unwind stop function: Run landing pads until the frame of the innermost `try` is reached
+                    // (or the unwinder runs out of frames), then jump back into it.
+                    // NOTE: Only used when the `try` has a frame, so it was set with `__builtin_setjmp`
+                    m_of << "static int " << Trans_Mangle(p) << "_stop(int version, int actions, uint64_t class, void* exc, void* ctx, void* param) {\n";
+                    m_of << "\tif( (actions & 16 /*_UA_END_OF_STACK*/) || _Unwind_GetCFA(ctx) > (uintptr_t)mrustc_panic_target_frame )\n";
+                    m_of << "\t\t__builtin_longjmp((void**)*mrustc_panic_target, 1);\n";
+                    m_of << "\treturn 0;\n";
+                    m_of << "}\n";
+                }
                 m_of << "static ";
                 emit_function_header(p, item, params);
                 m_of << " {\n";
                 m_of << "\tif( !mrustc_panic_target ) abort();\n";
                 m_of << "\tmrustc_panic_value = arg0;\n";
+                if( m_options.unwind_tables )
+                {
+                    // Only returns if the unwind failed
+                    m_of << "\tif( mrustc_panic_target_frame ) _Unwind_ForcedUnwind(arg0, " << Trans_Mangle(p) << "_stop, 0);\n";
+                }
+                // A `try` from a `-C unwind=tables` crate (which records its frame) uses the lighter `__builtin_setjmp`
+                // - Checked in both modes, as crates built in either mode can be mixed
+                m_of << "\tif( mrustc_panic_target_frame ) __builtin_longjmp((void**)*mrustc_panic_target, 1);\n";
                 m_of << "\tlongjmp(*mrustc_panic_target, 1);\n";
                 m_of << "}\n";
                 return;
@@ -2855,7 +3381,7 @@ namespace {
             }
             if( is_extern_def )
             {
-                m_of << "static ";
+                emit_instance_linkage(p);
             }
             switch(item.m_linkage.type)
             {
@@ -2882,6 +3408,194 @@ namespace {
 
             m_mir_res = nullptr;
         }
+        /// Determine the blocks that always end in a panic/unwind (i.e. calling a `#[cold]` function, or diverging)
+        /// Mark all blocks reachable from `start`, ignoring the panic arm of calls
+        static void mark_reachable(const ::MIR::Function& fcn, ::std::vector<bool>& visited, ::MIR::BasicBlockId start)
+        {
+            ::std::vector<::MIR::BasicBlockId>  stack;
+            stack.push_back(start);
+            while( !stack.empty() )
+            {
+                auto bb = stack.back();
+                stack.pop_back();
+                if( visited[bb] )
+                    continue ;
+                visited[bb] = true;
+                if( const auto* te = fcn.blocks[bb].terminator.opt_Call() ) {
+                    stack.push_back(te->ret_block);
+                }
+                else {
+                    MIR::visit::visit_terminator_target(fcn.blocks[bb].terminator, [&](const auto& tgt){ stack.push_back(tgt); });
+                }
+            }
+        }
+        bool is_cold_noreturn_fcn(const ::HIR::Path& p) const
+        {
+            auto it = m_cold_noreturn_fcns.find(p);
+            if( it == m_cold_noreturn_fcns.end() )
+            {
+                MonomorphState  ms_tmp;
+                auto v = m_resolve.get_value(sp, p, ms_tmp, /*signature_only=*/true);
+                bool is_cold = v.is_Function() && v.as_Function()->m_markings.is_cold && v.as_Function()->m_return.data().is_Diverge();
+                it = m_cold_noreturn_fcns.insert(::std::make_pair(p.clone(), is_cold)).first;
+            }
+            return it->second;
+        }
+        /// Check if a type is `Unpin` (i.e. can't point into itself while borrowed)
+        bool type_is_unpin(const ::HIR::TypeRef& ty) const
+        {
+            // Generator state (e.g. an `async fn`) can hold pointers into itself, but is `Unpin` by its fields
+            if( type_contains_generator(ty) )
+                return false;
+            // Explicit `!Unpin` impls (e.g. `PhantomPinned`)
+            const auto& lang_Unpin = m_crate.get_lang_item_path_opt("unpin");
+            if( lang_Unpin == ::HIR::SimplePath() )
+                return true;
+            ::HIR::PathParams   pp;
+            return m_resolve.find_impl(sp, lang_Unpin, &pp, ty, [](auto , bool ){ return true; }, true);
+        }
+        bool type_contains_generator(const ::HIR::TypeRef& ty) const
+        {
+            TU_MATCH_HDRA( (ty.data()), {)
+            default:
+                return false;
+            TU_ARMA(Array, te) {
+                return type_contains_generator(te.inner);
+                }
+            TU_ARMA(Tuple, te) {
+                for(const auto& t : te)
+                    if( type_contains_generator(t) )
+                        return true;
+                return false;
+                }
+            TU_ARMA(Path, te) {
+                if( te.is_generator() )
+                    return true;
+                if( te.binding.is_Opaque() || te.binding.is_ExternType() )
+                    return false;
+                const auto* repr = Target_GetTypeRepr(sp, m_resolve, ty);
+                if( !repr )
+                    return false;
+                for(const auto& f : repr->fields)
+                    if( type_contains_generator(f.ty) )
+                        return true;
+                return false;
+                }
+            }
+            throw "";
+        }
+        ::std::vector<bool> get_cold_blocks(const ::MIR::TypeResolve& mir_res) const
+        {
+            const auto& fcn = mir_res.m_fcn;
+            // Cleanup code that is shared with the normal path isn't cold
+            ::std::vector<bool> is_normal_block(fcn.blocks.size());
+            mark_reachable(fcn, is_normal_block, 0);
+
+            ::std::vector<bool> rv(fcn.blocks.size());
+            for(size_t bb = 0; bb < fcn.blocks.size(); bb ++)
+            {
+                const auto& term = fcn.blocks[bb].terminator;
+                if( term.is_Diverge() ) {
+                    rv[bb] = !is_normal_block[bb];
+                }
+                else if( const auto* te = term.opt_Call() ) {
+                    // Only calls that can't return (so panicking is the only way out), e.g. `panic_fmt`
+                    // - A `#[cold]` function that returns (e.g. a slow path) doesn't make the code after it cold
+                    if( const auto* p = te->fcn.opt_Path() ) {
+                        rv[bb] = is_cold_noreturn_fcn(*p);
+                    }
+                    else if( const auto* name = te->fcn.opt_Intrinsic() ) {
+                        rv[bb] = (name->name == "abort");
+                    }
+                }
+            }
+            // Propagate backwards: a block is cold if all of its (non-panic) successors are cold
+            bool changed = true;
+            while(changed)
+            {
+                changed = false;
+                for(size_t bb = fcn.blocks.size(); bb --; )
+                {
+                    if( rv[bb] )
+                        continue ;
+                    const auto& term = fcn.blocks[bb].terminator;
+                    bool all_cold = true;
+                    bool any_succ = false;
+                    if( const auto* te = term.opt_Call() ) {
+                        any_succ = true;
+                        all_cold = rv[te->ret_block];
+                    }
+                    else if( !term.is_Return() && !term.is_Incomplete() ) {
+                        ::MIR::visit::visit_terminator_target(term, [&](const ::MIR::BasicBlockId& tgt) {
+                            any_succ = true;
+                            all_cold &= rv[tgt];
+                            });
+                    }
+                    if( any_succ && all_cold ) {
+                        rv[bb] = true;
+                        changed = true;
+                    }
+                }
+            }
+            return rv;
+        }
+        /// Cleanup code run when unwinding through a function (`-C unwind=tables`)
+        struct LandingPads
+        {
+            /// First block of each pad (selected by `lp` = index + 1)
+            ::std::vector<::MIR::BasicBlockId>  entries;
+            /// Pad used by the call terminating each block (0 for none)
+            ::std::vector<unsigned> call_pad;
+            /// Blocks reachable without unwinding
+            ::std::vector<bool> is_normal_block;
+            /// Blocks reachable from a pad entry
+            ::std::vector<bool> is_pad_block;
+
+            bool has_pads() const { return !entries.empty(); }
+        };
+        LandingPads get_landing_pads(const ::MIR::TypeResolve& mir_res) const
+        {
+            const auto& fcn = mir_res.m_fcn;
+            // A block that just continues unwinding doesn't need a pad
+            auto is_trivial = [&](::MIR::BasicBlockId bb) {
+                return fcn.blocks[bb].statements.empty() && fcn.blocks[bb].terminator.is_Diverge();
+                };
+
+            LandingPads rv;
+            rv.call_pad.resize(fcn.blocks.size());
+            rv.is_normal_block.resize(fcn.blocks.size());
+            rv.is_pad_block.resize(fcn.blocks.size());
+            mark_reachable(fcn, rv.is_normal_block, 0);
+
+            ::std::map<::MIR::BasicBlockId, unsigned>   entry_indexes;
+            for(size_t bb = 0; bb < fcn.blocks.size(); bb ++)
+            {
+                const auto* te = fcn.blocks[bb].terminator.opt_Call();
+                if( !rv.is_normal_block[bb] || !te || is_trivial(te->panic_block) )
+                    continue ;
+                auto ins = entry_indexes.insert(::std::make_pair(te->panic_block, static_cast<unsigned>(rv.entries.size() + 1)));
+                if( ins.second )
+                {
+                    rv.entries.push_back(te->panic_block);
+                    mark_reachable(fcn, rv.is_pad_block, te->panic_block);
+                }
+                rv.call_pad[bb] = ins.first->second;
+            }
+
+            // Pads must be self-contained: no code shared with the normal path (apart from `diverge`), and no returns
+            for(size_t bb = 0; bb < fcn.blocks.size(); bb ++)
+            {
+                if( !rv.is_pad_block[bb] )
+                    continue ;
+                if( (rv.is_normal_block[bb] && !is_trivial(bb)) || fcn.blocks[bb].terminator.is_Return() )
+                {
+                    DEBUG(mir_res << "bb" << bb << " can't be in a landing pad, no cleanup on unwind");
+                    return LandingPads();
+                }
+            }
+            return rv;
+        }
+
         void emit_function_code(const ::HIR::Path& p, const ::HIR::Function& item, const Trans_Params& params, bool is_extern_def, const ::MIR::FunctionPointer& code) override
         {
             TRACE_FUNCTION_F(p);
@@ -2898,7 +3612,7 @@ namespace {
 
             m_of << "// " << p << "\n";
             if( is_extern_def ) {
-                m_of << "static ";
+                emit_instance_linkage(p);
             }
             emit_function_header(p, item, params);
             m_of << "\n";
@@ -3027,6 +3741,15 @@ namespace {
 
             const bool EMIT_STRUCTURED = (nullptr != getenv("MRUSTC_STRUCTURED_C")); // Saves time.
             const bool USE_STRUCTURED = EMIT_STRUCTURED && (0 == strcmp("1", getenv("MRUSTC_STRUCTURED_C")));  // Still not correct.
+            // TODO: Support landing pads in structured output
+            const auto pads = (m_options.unwind_tables && !EMIT_STRUCTURED ? get_landing_pads(mir_res) : LandingPads());
+            // Panic paths are marked as cold, and branches to them as unlikely
+            const auto cold_blocks = (m_options.annotations ? get_cold_blocks(mir_res) : ::std::vector<bool>());
+            auto emit_label = [&](unsigned int i) {
+                m_of << "bb" << i << ":";
+                if( !cold_blocks.empty() && cold_blocks[i] )
+                    m_of << " __attribute__((cold));";
+                };
             if( EMIT_STRUCTURED )
             {
                 m_of << "#if " << USE_STRUCTURED << "\n";
@@ -3135,48 +3858,9 @@ namespace {
                 m_of << "#else\n";
             }
 
-            for(unsigned int i = 0; i < code->blocks.size(); i ++)
-            {
-                TRACE_FUNCTION_F(p << " bb" << i);
-
-                // HACK: Ignore any blocks that only contain `diverge;`
-                if( code->blocks[i].statements.size() == 0 && code->blocks[i].terminator.is_Diverge() ) {
-                    DEBUG("- Diverge only, omitting");
-                    m_of << "bb" << i << ": _Unwind_Resume(); // Diverge\n";
-                    continue ;
-                }
-
-                // If the previous block is a goto/function call to this
-                // block, AND this block only has a single reference, omit the
-                // label.
-                if( bb_use_counts.at(i) == 0 )
-                {
-                    if( i == 0 )
-                    {
-                        // First BB, don't print label
-                    }
-                    else
-                    {
-                        // Unused BB (likely part of unsupported panic path)
-                        continue ;
-                    }
-                }
-                else if( bb_use_counts.at(i) == 1 )
-                {
-                    if( i > 0 && (TU_TEST1(code->blocks[i-1].terminator, Goto, == i) || TU_TEST1(code->blocks[i-1].terminator, Call, .ret_block == i)) )
-                    {
-                        // Don't print the label, only use is previous block
-                    }
-                    else
-                    {
-                        m_of << "bb" << i << ":\n";
-                    }
-                }
-                else
-                {
-                    m_of << "bb" << i << ":\n";
-                }
-
+            // Emit the statements and terminator of a block
+            // - `in_pad` is set when emitting into the landing pad function (which has no fall-through between blocks)
+            auto emit_block_body = [&](unsigned int i, bool in_pad) {
                 for(const auto& stmt : code->blocks[i].statements)
                 {
                     mir_res.set_cur_stmt(i, (&stmt - &code->blocks[i].statements.front()));
@@ -3190,6 +3874,7 @@ namespace {
                     m_of << "\tfor(;;);\n";
                     }
                 TU_ARMA(Return, e) {
+                    MIR_ASSERT(mir_res, !in_pad, "Return in landing pad");
                     // If the return type is (), don't return a value.
                     if( ret_type == ::HIR::TypeRef::new_unit() )
                         m_of << "\treturn ;\n";
@@ -3197,10 +3882,13 @@ namespace {
                         m_of << "\treturn rv;\n";
                     }
                 TU_ARMA(Diverge, e) {
-                    m_of << "\t_Unwind_Resume();\n";
+                    if( in_pad )
+                        m_of << "\treturn;\n";
+                    else
+                        m_of << "\t_Unwind_Resume();\n";
                     }
                 TU_ARMA(Goto, e) {
-                    if( e == i+1 )
+                    if( e == i+1 && !in_pad )
                     {
                         // Let it flow on to the next block
                     }
@@ -3213,7 +3901,15 @@ namespace {
                     m_of << "\tgoto bb" << e << "; /* panic */\n";
                     }
                 TU_ARMA(If, e) {
-                    m_of << "\tif("; emit_lvalue(e.cond); m_of << ") goto bb" << e.bb_true << "; else goto bb" << e.bb_false << ";\n";
+                    if( !cold_blocks.empty() && cold_blocks[e.bb_true] != cold_blocks[e.bb_false] )
+                    {
+                        m_of << "\tif(__builtin_expect("; emit_lvalue(e.cond); m_of << ", " << (cold_blocks[e.bb_true] ? 0 : 1) << "))";
+                    }
+                    else
+                    {
+                        m_of << "\tif("; emit_lvalue(e.cond); m_of << ")";
+                    }
+                    m_of << " goto bb" << e.bb_true << "; else goto bb" << e.bb_false << ";\n";
                     }
                 TU_ARMA(Switch, e) {
 
@@ -3260,8 +3956,14 @@ namespace {
                         });
                     }
                 TU_ARMA(Call, e) {
+                    // Select the landing pad for the duration of the call
+                    unsigned pad = (in_pad || !pads.has_pads() ? 0 : pads.call_pad[i]);
+                    if( pad != 0 )
+                        m_of << "\tlp = " << pad << ";\n";
                     emit_term_call(mir_res, e, 1);
-                    if( e.ret_block == i+1 )
+                    if( pad != 0 )
+                        m_of << "\tlp = 0;\n";
+                    if( e.ret_block == i+1 && !in_pad )
                     {
                         // Let it flow on to the next block
                     }
@@ -3272,6 +3974,92 @@ namespace {
                     }
                 }
                 m_of << "\t// ^ " << code->blocks[i].terminator << "\n";
+                };
+
+            // With `-C unwind=tables`, the cleanup blocks are emitted into a nested function that runs (via the cleanup
+            // attribute on `lp`) when a forced unwind passes through this frame. `lp` selects the pad for the active call.
+            // - The nested function is only ever called directly (by the cleanup), so GCC needs no trampoline (and no
+            //   executable stack), it just passes the frame in the static chain register.
+            // - Locals used by the pads have to live in memory. That's already the case for values being dropped (drop
+            //   glue takes their address), but drop flags also get spilled.
+            // - Normal-path cost (x86-64, -O1): the static chain setup on entry, and the inlined pads being laid out
+            //   between the normal blocks. Measured at ~2ns (~14%) extra for a call to a function with three droppable
+            //   locals and three calls, so functions with nothing to clean up get no pads.
+            if( pads.has_pads() )
+            {
+                m_of << "\tvoid mrustc_landing_pad(int* lp) {\n";
+                m_of << "\tswitch(*lp) {\n";
+                m_of << "\tcase 0: return;\n";
+                for(size_t pad_idx = 0; pad_idx < pads.entries.size(); pad_idx ++)
+                {
+                    m_of << "\tcase " << (pad_idx+1) << ": goto bb" << pads.entries[pad_idx] << ";\n";
+                }
+                m_of << "\t}\n";
+                m_of << "\tabort();\n";
+                for(unsigned int i = 0; i < code->blocks.size(); i ++)
+                {
+                    if( !pads.is_pad_block[i] )
+                        continue ;
+                    TRACE_FUNCTION_F(p << " pad bb" << i);
+                    m_of << "bb" << i << ":\n";
+                    emit_block_body(i, true);
+                }
+                m_of << "\t}\n";
+                m_of << "\tint lp __attribute__((cleanup(mrustc_landing_pad))) = 0;\n";
+            }
+
+            for(unsigned int i = 0; i < code->blocks.size(); i ++)
+            {
+                TRACE_FUNCTION_F(p << " bb" << i);
+
+                // HACK: Ignore any blocks that only contain `diverge;`
+                if( code->blocks[i].statements.size() == 0 && code->blocks[i].terminator.is_Diverge() ) {
+                    DEBUG("- Diverge only, omitting");
+                    emit_label(i);
+                    m_of << " _Unwind_Resume(); // Diverge\n";
+                    continue ;
+                }
+
+                // Cleanup code is only run from the landing pad
+                if( pads.has_pads() && !pads.is_normal_block[i] )
+                {
+                    continue ;
+                }
+
+                // If the previous block is a goto/function call to this
+                // block, AND this block only has a single reference, omit the
+                // label.
+                if( bb_use_counts.at(i) == 0 )
+                {
+                    if( i == 0 )
+                    {
+                        // First BB, don't print label
+                    }
+                    else
+                    {
+                        // Unused BB (likely part of unsupported panic path)
+                        continue ;
+                    }
+                }
+                else if( bb_use_counts.at(i) == 1 )
+                {
+                    if( i > 0 && (TU_TEST1(code->blocks[i-1].terminator, Goto, == i) || TU_TEST1(code->blocks[i-1].terminator, Call, .ret_block == i)) )
+                    {
+                        // Don't print the label, only use is previous block
+                    }
+                    else
+                    {
+                        emit_label(i);
+                        m_of << "\n";
+                    }
+                }
+                else
+                {
+                    emit_label(i);
+                    m_of << "\n";
+                }
+
+                emit_block_body(i, false);
             }
 
             if( EMIT_STRUCTURED )
@@ -5618,6 +6406,15 @@ namespace {
         {
             ::HIR::TypeRef  tmp;
             const auto& ret_ty = monomorphise_fcn_return(tmp, item, params);
+            if( m_options.annotations )
+            {
+                if( item.m_markings.is_cold )
+                    m_of << "__attribute__((cold)) ";
+                // NOTE: `#[inline]`/`#[inline(always)]` are left to gcc's heuristics - `always_inline` is a hard error
+                // if gcc can't inline (e.g. recursion, weak symbols), and C99 `inline` changes the linkage.
+                if( item.m_markings.inline_type == ::HIR::Function::Markings::Inline::Never )
+                    m_of << "__attribute__((noinline)) ";
+            }
             auto cb = FMT_CB(ss,
                 // TODO: Cleaner ABI handling
                 if( item.m_abi == "system" && m_compiler == Compiler::Msvc )
@@ -5636,7 +6433,13 @@ namespace {
                         ss << "\n\t\t";
                         // TODO: If the type has a high alignment, emit as a pointer? Might have FFI issues
                         auto ty = params.monomorph(m_resolve, item.m_args[i].second);
-                        this->emit_ctype( ty, FMT_CB(os, os << (this->type_is_high_align(ty) ? "*":"") << "arg" << i;) );
+                        // `&mut` to a sized type can't alias anything else visible to the function
+                        // - Except for `!Unpin` types (like rustc's `noalias`), which can be self-referential
+                        bool is_restrict = m_options.annotations
+                            && TU_TEST1(ty.data(), Borrow, .type == ::HIR::BorrowType::Unique)
+                            && !this->is_dst(ty.data().as_Borrow().inner)
+                            && this->type_is_unpin(ty.data().as_Borrow().inner);
+                        this->emit_ctype( ty, FMT_CB(os, os << (this->type_is_high_align(ty) ? "*":"") << (is_restrict ? "restrict ":"") << "arg" << i;) );
                         if( item.m_variadic || i+1 < item.m_args.size() )    m_of << ",";
                         m_of << " // " << ty;
                     }
@@ -6232,7 +7035,11 @@ namespace {
                 case Compiler::Gcc:
                     m_of << "{ ";
                     m_of << " jmp_buf jmpbuf, *old = mrustc_panic_target; mrustc_panic_target = &jmpbuf;";
-                    m_of << " if(setjmp(jmpbuf)) {";
+                    // Unwinding (with `-C unwind=tables`) stops at this frame, a NULL frame skips straight to the `longjmp`
+                    m_of << " void* old_frame = mrustc_panic_target_frame; mrustc_panic_target_frame = " << (m_options.unwind_tables ? "__builtin_frame_address(0)" : "NULL") << ";";
+                    // With a frame, the catch uses `__builtin_setjmp` (expanded inline instead of calling into libc)
+                    // - It only needs five words, so fits in a `jmp_buf`
+                    m_of << " if(" << (m_options.unwind_tables ? "__builtin_setjmp((void**)jmpbuf)" : "setjmp(jmpbuf)") << ") {";
                     // NOTE: gcc unwind has a pointer as its `local_ptr` parameter
                     if(TARGETVER_MOST_1_39) {
                         m_of << " *(void**)("; emit_param(e.args.at(2)); m_of << ") = mrustc_panic_value;";
@@ -6255,7 +7062,7 @@ namespace {
                     m_of << ";";
                     m_of << " }";
                     m_of << " if(mrustc_panic_target != &jmpbuf) { abort(); }";
-                    m_of << " mrustc_panic_target = old;";
+                    m_of << " mrustc_panic_target = old; mrustc_panic_target_frame = old_frame;";
                     m_of << " }";
                     break;
                 default:
@@ -6425,10 +7232,18 @@ namespace {
                 }
             }
             else if( name == "assume" ) {
-                // I don't assume :)
+                if( m_options.annotations ) {
+                    m_of << "if( !("; emit_param(e.args.at(0)); m_of << ") ) __builtin_unreachable()";
+                }
+                // Otherwise, I don't assume :)
             }
             else if( name == "likely" || name == "unlikely" ) {
-                emit_lvalue(e.ret_val); m_of << "= ("; emit_param(e.args.at(0)); m_of << ")";
+                if( m_options.annotations ) {
+                    emit_lvalue(e.ret_val); m_of << "= __builtin_expect("; emit_param(e.args.at(0)); m_of << ", " << (name == "likely" ? 1 : 0) << ")";
+                }
+                else {
+                    emit_lvalue(e.ret_val); m_of << "= ("; emit_param(e.args.at(0)); m_of << ")";
+                }
             }
             else if( name == "black_box" ) {
                 if( !lvalue_is_bad_zst(e.ret_val) ) {
@@ -7264,69 +8079,35 @@ namespace {
             }
             // -- Platform Intrinsics --
             else if( name.compare(0, 9, "platform:") == 0 ) {
-                struct SimdInfo {
-                    unsigned count;
-                    unsigned item_size;
-                    enum Ty {
-                        Float,
-                        Signed,
-                        Unsigned,
-                    } ty;
-
-                    static SimdInfo for_ty(const CodeGenerator_C& self, const HIR::TypeRef& ty) {
-                        const auto* ty_repr = Target_GetTypeRepr(self.sp, self.m_mir_res->m_resolve, ty);
-                        MIR_ASSERT(*self.m_mir_res, ty_repr, "No repr for " << ty);
-                        size_t size_slot = ty_repr->size;
-                        const auto& ity = ty_repr->fields[0].ty;
-                        DEBUG("SimdInfo Type: " << ity);
-                        const auto& ty_val = ity.data().is_Primitive()
-                                ? ity
-                                : ty_repr->fields[0].ty.data().as_Array().inner
-                                ;
-                        DEBUG("ty_val = " << ty_val);
-                        size_t size_val = 0;
-                        MIR_ASSERT(*self.m_mir_res, Target_GetSizeOf(self.sp, self.m_resolve, ty_val, size_val), ty_val);
-
-                        MIR_ASSERT(*self.m_mir_res, size_slot >= size_val, size_slot << " < " << size_val);
-                        MIR_ASSERT(*self.m_mir_res, size_val > 0, "SimdInfo::for_ty - Value type " << ty_val << " was a ZST");
-                        MIR_ASSERT(*self.m_mir_res, size_slot / size_val * size_val == size_slot, size_slot << " not a multiple of " << size_val);
-
-                        SimdInfo    rv;
-                        rv.item_size = size_val;
-                        rv.count = size_slot == 0 ? 0 : size_slot / size_val;
-                        switch(ty_val.data().as_Primitive())
-                        {
-                        case ::HIR::CoreType::I8:   rv.ty = Signed; break;
-                        case ::HIR::CoreType::I16:  rv.ty = Signed; break;
-                        case ::HIR::CoreType::I32:  rv.ty = Signed; break;
-                        case ::HIR::CoreType::I64:  rv.ty = Signed; break;
-                        //case ::HIR::CoreType::I128: rv.ty = Signed; break;
-                        case ::HIR::CoreType::U8:   rv.ty = Unsigned; break;
-                        case ::HIR::CoreType::U16:  rv.ty = Unsigned; break;
-                        case ::HIR::CoreType::U32:  rv.ty = Unsigned; break;
-                        case ::HIR::CoreType::U64:  rv.ty = Unsigned; break;
-                        //case ::HIR::CoreType::U128: rv.ty = Unsigned; break;
-                        case ::HIR::CoreType::F32:  rv.ty = Float;  break;
-                        case ::HIR::CoreType::F64:  rv.ty = Float;  break;
-                        default:
-                            MIR_BUG(*self.m_mir_res, "Invalid SIMD type inner - " << ty_val);
-                        }
-                        return rv;
+                // Access lane `i` of a SIMD value
+                auto emit_lane = [&](const SimdInfo& info, const ::MIR::Param& val, size_t i) {
+                    if( info.is_vector ) {
+                        emit_param(val); m_of << ".VEC[" << i << "]";
                     }
-                    void emit_val_ty(CodeGenerator_C& self) {
-                        switch(ty)
-                        {
-                        case Float: self.m_of << (item_size == 4 ? "float" : "double"); break;
-                        case Signed:    self.m_of << "int" << (item_size*8) << "_t";    break;
-                        case Unsigned:  self.m_of << "uint" << (item_size*8) << "_t";   break;
-                        }
+                    else {
+                        m_of << "(("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(val); m_of << ")[" << i << "]";
                     }
-                };
-
+                    };
                 auto simd_cmp = [&](const char* op) {
                     auto src_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto dst_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, src_info.count == dst_info.count, "Element counts must match for " << name);
+                    if( src_info.is_vector && dst_info.is_vector ) {
+                        // Vector comparisons produce 0/-1 in a signed vector with the same lane size as the inputs
+                        emit_lvalue(e.ret_val); m_of << ".VEC = ";
+                        if( src_info.item_size == dst_info.item_size ) {
+                            m_of << "("; dst_info.emit_vec_ty(*this); m_of << ")(";
+                        }
+                        else {
+                            m_of << "__builtin_convertvector(";
+                        }
+                        emit_param(e.args.at(0)); m_of << ".VEC " << op << " "; emit_param(e.args.at(1)); m_of << ".VEC";
+                        if( src_info.item_size != dst_info.item_size ) {
+                            m_of << ", "; dst_info.emit_vec_ty(*this);
+                        }
+                        m_of << ")";
+                        return ;
+                    }
                     m_of << "for(int i = 0; i < " << dst_info.count << "; i++)";
                     m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
                     m_of << "= (";
@@ -7337,6 +8118,10 @@ namespace {
                     };
                 auto simd_arith = [&](const char* op) {
                     auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    if( info.is_vector ) {
+                        emit_lvalue(e.ret_val); m_of << ".VEC = "; emit_param(e.args.at(0)); m_of << ".VEC " << op << " "; emit_param(e.args.at(1)); m_of << ".VEC";
+                        return ;
+                    }
                     // Emulate!
                     emit_lvalue(e.ret_val); m_of << " = "; emit_param(e.args.at(0)); m_of << "; ";
                     m_of << "for(int i = 0; i < " << info.count << "; i++)";
@@ -7347,9 +8132,42 @@ namespace {
                 auto simd_call = [&](const char* op) {
                     auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     // Emulate!
+                    // - Pick the `float` version of the libm function for f32
+                    const char* sfx = (info.ty == SimdInfo::Float && info.item_size == 4 ? "f" : "");
                     m_of << "for(int i = 0; i < " << info.count << "; i++)";
                     m_of << "(("; info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
-                    m_of << "= " << op << "( (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i] )";
+                    m_of << "= " << op << sfx << "( (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i] )";
+                    };
+                // Horizontal reduction, unrolled
+                // - `init` is an extra initial value (for the ordered reductions)
+                auto simd_reduce = [&](const char* op, const ::MIR::Param* init) {
+                    auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    emit_lvalue(e.ret_val); m_of << " = ";
+                    if( init ) {
+                        emit_param(*init); m_of << " " << op << " ";
+                    }
+                    for(size_t i = 0; i < info.count; i ++) {
+                        if( i != 0 )
+                            m_of << " " << op << " ";
+                        emit_lane(info, e.args.at(0), i);
+                    }
+                    };
+                auto simd_reduce_minmax = [&](const char* op) {
+                    auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    m_of << "{ "; info.emit_val_ty(*this); m_of << " v = "; emit_lane(info, e.args.at(0), 0); m_of << "; ";
+                    for(size_t i = 1; i < info.count; i ++) {
+                        m_of << "if( "; emit_lane(info, e.args.at(0), i); m_of << " " << op << " v ) v = "; emit_lane(info, e.args.at(0), i); m_of << "; ";
+                    }
+                    emit_lvalue(e.ret_val); m_of << " = v; }";
+                    };
+                auto simd_reduce_bool = [&](const char* op) {
+                    auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    emit_lvalue(e.ret_val); m_of << " = ";
+                    for(size_t i = 0; i < info.count; i ++) {
+                        if( i != 0 )
+                            m_of << " " << op << " ";
+                        m_of << "("; emit_lane(info, e.args.at(0), i); m_of << " != 0)";
+                    }
                     };
 
                 // dst: T, index: usize, val: U
@@ -7382,7 +8200,7 @@ namespace {
                     Target_GetSizeOf(sp, m_resolve, params.m_types.at(1), size_out);
                     m_of << "{ uint8_t* out = (uint8_t*)&("; emit_lvalue(e.ret_val); m_of << "); memset(out, 0, " << size_out << "); ";
                     for(size_t i = 0; i < src_info.count; i ++) {
-                        m_of << "out[" << (i / 8) << "] |= (("; src_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[" << i << "] == 0 ? 0 : (1 << " << (i % 8) << "); ";
+                        m_of << "out[" << (i / 8) << "] |= "; emit_lane(src_info, e.args.at(0), i); m_of << " == 0 ? 0 : (1 << " << (i % 8) << "); ";
                     }
                     m_of << "}";
                 }
@@ -7418,36 +8236,70 @@ namespace {
                     m_of << "}";
                 }
                 else if( name == "platform:simd_shuffle" ) {
-                    //const auto& vec_ty = params.m_types.at(0);
+                    const auto& vec_ty = params.m_types.at(0);
                     const auto& map_ty = params.m_types.at(1);
                     const auto& ret_ty = params.m_types.at(2);
-                    //size_t size_vec = 0;
+                    size_t size_vec = 0;
                     size_t size_map = 0;
                     size_t size_ret = 0;
-                    //Target_GetSizeOf(sp, m_resolve, vec_ty, size_vec);
+                    Target_GetSizeOf(sp, m_resolve, vec_ty, size_vec);
                     Target_GetSizeOf(sp, m_resolve, map_ty, size_map);
                     Target_GetSizeOf(sp, m_resolve, ret_ty, size_ret);
                     size_t div = size_map / 4;  // map must be u32s
                     size_t size_val = size_ret / div;
+                    size_t n_in = size_vec / size_val;  // Lane count of each input
+                    if( SimdInfo::is_vector_type(*this, params.m_types.at(0)) && SimdInfo::is_vector_type(*this, ret_ty) )
+                    {
+                        auto src_info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                        auto dst_info = SimdInfo::for_ty(*this, ret_ty);
+                        // `__builtin_shuffle` requires the output to have the same lane count as the inputs
+                        if( src_info.is_vector && dst_info.is_vector && src_info.count == dst_info.count && src_info.count == div )
+                        {
+                            emit_lvalue(e.ret_val); m_of << ".VEC = __builtin_shuffle(";
+                            emit_param(e.args.at(0)); m_of << ".VEC, "; emit_param(e.args.at(1)); m_of << ".VEC, ";
+                            m_of << "("; src_info.emit_mask_ty(*this); m_of << "){";
+                            for(size_t i = 0; i < div; i ++) {
+                                m_of << " "; emit_param(e.args.at(2)); m_of << ".DATA[" << i << "],";
+                            }
+                            m_of << " })";
+                            m_of << ";\n";
+                            return ;
+                        }
+                    }
                     m_of << "for(int i = 0; i < " << div << "; i++) {";
                     m_of << " int j = "; emit_param(e.args.at(2)); m_of << ".DATA[i];";
                     m_of << " ((uint" << (size_val*8) << "_t*)&"; emit_lvalue(e.ret_val); m_of << ")[i]";
-                    m_of << " = ((uint" << (size_val*8) << "_t*)(j < " << div << " ? &"; emit_param(e.args.at(1)); m_of << " : &"; emit_param(e.args.at(1)); m_of << "))[j % " << div << "];";
+                    m_of << " = ((uint" << (size_val*8) << "_t*)(j < " << n_in << " ? &"; emit_param(e.args.at(0)); m_of << " : &"; emit_param(e.args.at(1)); m_of << "))[j % " << n_in << "];";
                     m_of << "}";
                 }
                 else if( name == "platform:simd_cast" ) {
                     auto src_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto dst_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, src_info.count == dst_info.count, "Element counts must match for " << name);
-                    m_of << "for(int i = 0; i < " << dst_info.count << "; i++) ";
-                    m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
-                    m_of << "= (("; src_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i];";
+                    if( src_info.is_vector && dst_info.is_vector ) {
+                        emit_lvalue(e.ret_val); m_of << ".VEC = __builtin_convertvector("; emit_param(e.args.at(0)); m_of << ".VEC, "; dst_info.emit_vec_ty(*this); m_of << ")";
+                    }
+                    else {
+                        m_of << "for(int i = 0; i < " << dst_info.count << "; i++) ";
+                        m_of << "(("; dst_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
+                        m_of << "= (("; src_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i];";
+                    }
                 }
                 // Select between two values
                 else if(name == "platform:simd_select") {
                     auto mask_info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     auto val_info = SimdInfo::for_ty(*this, params.m_types.at(1));
                     MIR_ASSERT(mir_res, mask_info.count == val_info.count, "Element counts must match for " << name);
+                    if( mask_info.is_vector && val_info.is_vector ) {
+                        // No vector `?:` in C, so blend using the mask (widened/narrowed to the value lane size)
+                        m_of << "{ "; val_info.emit_mask_ty(*this); m_of << " m = __builtin_convertvector("; emit_param(e.args.at(0)); m_of << ".VEC != 0, "; val_info.emit_mask_ty(*this); m_of << "); ";
+                        emit_lvalue(e.ret_val); m_of << ".VEC = ("; val_info.emit_vec_ty(*this); m_of << ")(";
+                        m_of << "(("; val_info.emit_mask_ty(*this); m_of << ")"; emit_param(e.args.at(1)); m_of << ".VEC & m)";
+                        m_of << " | (("; val_info.emit_mask_ty(*this); m_of << ")"; emit_param(e.args.at(2)); m_of << ".VEC & ~m)";
+                        m_of << "); }";
+                        m_of << ";\n";
+                        return ;
+                    }
                     m_of << "for(int i = 0; i < " << val_info.count << "; i++) ";
                     m_of << "(("; val_info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
                     m_of << "= (("; mask_info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i]";
@@ -7482,24 +8334,42 @@ namespace {
                 else if(name == "platform:simd_xor")    simd_arith("^");
                 else if(name == "platform:simd_shr")    simd_arith(">>");
                 else if(name == "platform:simd_shl")    simd_arith("<<");
-                // platform:simd_reduce_and
-                // platform:simd_reduce_max
-                // platform:simd_reduce_min
-                // platform:simd_reduce_mul_unordered
-                // platform:simd_reduce_add_unordered
-                // platform:simd_reduce_or
+                else if(name == "platform:simd_rem")    simd_arith("%");
+                else if(name == "platform:simd_neg") {
+                    auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
+                    if( info.is_vector ) {
+                        emit_lvalue(e.ret_val); m_of << ".VEC = -"; emit_param(e.args.at(0)); m_of << ".VEC";
+                    }
+                    else {
+                        m_of << "for(int i = 0; i < " << info.count << "; i++)";
+                        m_of << "(("; info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
+                        m_of << "= - (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i]";
+                    }
+                }
+                // Reductions
+                else if(name == "platform:simd_reduce_add_unordered")   simd_reduce("+", nullptr);
+                else if(name == "platform:simd_reduce_mul_unordered")   simd_reduce("*", nullptr);
+                else if(name == "platform:simd_reduce_add_ordered")     simd_reduce("+", &e.args.at(1));
+                else if(name == "platform:simd_reduce_mul_ordered")     simd_reduce("*", &e.args.at(1));
+                else if(name == "platform:simd_reduce_and") simd_reduce("&", nullptr);
+                else if(name == "platform:simd_reduce_or" ) simd_reduce("|", nullptr);
+                else if(name == "platform:simd_reduce_xor") simd_reduce("^", nullptr);
+                else if(name == "platform:simd_reduce_min") simd_reduce_minmax("<");
+                else if(name == "platform:simd_reduce_max") simd_reduce_minmax(">");
+                else if(name == "platform:simd_reduce_all") simd_reduce_bool("&&");
+                else if(name == "platform:simd_reduce_any") simd_reduce_bool("||");
                 // platform:simd_saturating_add
                 // platform:simd_saturating_sub
                 else if(name == "platform:simd_ceil")    simd_call("ceil");
                 else if(name == "platform:simd_floor")    simd_call("floor");
                 else if(name == "platform:simd_fsqrt")    simd_call("sqrt");
                 // platform:simd_fma
-                else if(name == "platform::simd_fma") {
+                else if(name == "platform:simd_fma") {
                     auto info = SimdInfo::for_ty(*this, params.m_types.at(0));
                     // Emulate!
                     m_of << "for(int i = 0; i < " << info.count << "; i++)";
                     m_of << "(("; info.emit_val_ty(*this); m_of << "*)&"; emit_lvalue(e.ret_val); m_of << ")[i] ";
-                    m_of << "= fma(";
+                    m_of << "= fma" << (info.item_size == 4 ? "f" : "") << "(";
                     m_of << " (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(0)); m_of << ")[i],";
                     m_of << " (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(1)); m_of << ")[i],";
                     m_of << " (("; info.emit_val_ty(*this); m_of << "*)&"; emit_param(e.args.at(2)); m_of << ")[i]";
@@ -8186,7 +9056,7 @@ namespace {
     Span CodeGenerator_C::sp;
 }
 
-::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile)
+::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGeneratorC(const ::HIR::Crate& crate, const ::std::string& outfile, const TransOptions& opt)
 {
-    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile));
+    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_C(crate, outfile, opt));
 }
@@ -12,9 +12,12 @@
 #include <mir/helpers.hpp>
 #include "mangling.hpp"
 #include "target.hpp"
+#include <mmir_binary.hpp>
 
 #include <iomanip>
 #include <fstream>
+#include <map>
+#include <unordered_map>
 
 namespace
 {
@@ -233,6 +236,616 @@ namespace
         return os;
     }
 
+    /// Writer for the binary form of monomorphised MIR (see `include/mmir_binary.hpp`)
+    class BinaryWriter
+    {
+        ::std::ostream& m_os;
+
+        ::std::unordered_map<::std::string, unsigned>   m_string_ids;
+        ::std::vector<const ::std::string*> m_strings;
+        ::std::map<::HIR::TypeRef, unsigned>    m_type_ids;
+        ::std::string   m_types;
+        ::std::vector<unsigned> m_crates;
+        ::std::vector<::std::pair<MmirBinary::ItemType, uint64_t>>  m_items;
+
+        /// Record currently being built (written out by `end_item`)
+        ::std::string   m_buf;
+    public:
+        BinaryWriter(::std::ostream& os):
+            m_os(os)
+        {
+            // Header, the trailer offset is filled by `finish`
+            m_os.write(MmirBinary::MAGIC, sizeof(MmirBinary::MAGIC));
+            for(size_t i = 0; i < 8; i ++)
+                m_os.put(0);
+        }
+
+        void add_crate(const ::std::string& path)
+        {
+            m_crates.push_back(string_id(path));
+        }
+        void end_item(MmirBinary::ItemType ty)
+        {
+            m_items.push_back(::std::make_pair( ty, static_cast<uint64_t>(m_os.tellp()) ));
+            m_os.write(m_buf.data(), m_buf.size());
+            m_buf.clear();
+        }
+        void finish()
+        {
+            ::std::string   trailer;
+            MmirBinary::write_uint(trailer, m_strings.size());
+            for(const auto* s : m_strings)
+            {
+                MmirBinary::write_uint(trailer, s->size());
+                trailer += *s;
+            }
+            MmirBinary::write_uint(trailer, m_type_ids.size());
+            trailer += m_types;
+            MmirBinary::write_uint(trailer, m_crates.size());
+            for(auto c : m_crates)
+                MmirBinary::write_uint(trailer, c);
+            MmirBinary::write_uint(trailer, m_items.size());
+            for(const auto& i : m_items)
+            {
+                trailer.push_back(static_cast<char>(i.first));
+                MmirBinary::write_uint(trailer, i.second);
+            }
+
+            uint64_t trailer_ofs = m_os.tellp();
+            m_os.write(trailer.data(), trailer.size());
+            m_os.seekp(sizeof(MmirBinary::MAGIC));
+            for(size_t i = 0; i < 8; i ++)
+                m_os.put(static_cast<char>(trailer_ofs >> (i*8)));
+        }
+
+        void put_uint(uint64_t v) {
+            MmirBinary::write_uint(m_buf, v);
+        }
+        void put_sint(int64_t v) {
+            MmirBinary::write_sint(m_buf, v);
+        }
+        void put_u8(uint8_t v) {
+            m_buf.push_back(static_cast<char>(v));
+        }
+        void put_bytes(const void* data, size_t len) {
+            put_uint(len);
+            m_buf.append(static_cast<const char*>(data), len);
+        }
+        void put_str(const ::std::string& s) {
+            put_bytes(s.data(), s.size());
+        }
+        /// Interned string (used for paths)
+        void put_istr(const ::std::string& s) {
+            put_uint(string_id(s));
+        }
+        template<typename T>
+        void put_path(const T& p) {
+            put_istr(FMT(Trans_Mangle(p)));
+        }
+        void put_type(const ::HIR::TypeRef& ty) {
+            put_uint(type_id(ty));
+        }
+
+        void put_lvalue(const ::MIR::LValue& lv)
+        {
+            put_u8(static_cast<uint8_t>(lv.m_root.tag()));
+            switch(lv.m_root.tag())
+            {
+            case ::MIR::LValue::Storage::TAGDEAD:   throw "";
+            case ::MIR::LValue::Storage::TAG_Return:    break;
+            case ::MIR::LValue::Storage::TAG_Argument:  put_uint(lv.m_root.as_Argument()); break;
+            case ::MIR::LValue::Storage::TAG_Local:     put_uint(lv.m_root.as_Local());    break;
+            case ::MIR::LValue::Storage::TAG_Static:    put_path(lv.m_root.as_Static());   break;
+            }
+            put_uint(lv.m_wrappers.size());
+            for(const auto& w : lv.m_wrappers)
+                put_uint(w.get_inner());
+        }
+        void put_constant(const ::MIR::Constant& c)
+        {
+            put_u8(static_cast<uint8_t>(c.tag()));
+            TU_MATCH_HDRA( (c), {)
+            TU_ARMA(Int, e) {
+                put_sint(static_cast<int64_t>(e.v.get_inner().get_lo()));
+                put_sint(static_cast<int64_t>(e.v.get_inner().get_hi()));
+                put_u8(static_cast<uint8_t>(e.t));
+                }
+            TU_ARMA(Uint, e) {
+                put_uint(e.v.get_lo());
+                put_uint(e.v.get_hi());
+                put_u8(static_cast<uint8_t>(e.t));
+                }
+            TU_ARMA(Float, e) {
+                uint64_t    bits;
+                ::std::memcpy(&bits, &e.v, sizeof(double));
+                put_uint(bits);
+                put_u8(static_cast<uint8_t>(e.t));
+                }
+            TU_ARMA(Bool, e) {
+                put_u8(e.v ? 1 : 0);
+                }
+            TU_ARMA(Bytes, e) {
+                put_bytes(e.data(), e.size());
+                }
+            TU_ARMA(StaticString, e) {
+                put_str(e);
+                }
+            TU_ARMA(ItemAddr, e) {
+                ASSERT_BUG(Span(), e, "Unresolved `ItemAddr` in MIR after cleanup");
+                put_path(*e);
+                }
+            TU_ARMA(Const, e) {
+                BUG(Span(), "Stray named constant in MIR after cleanup - " << c);
+                }
+            TU_ARMA(Generic, e) {
+                BUG(Span(), "Generic constant in monomorphised MIR - " << c);
+                }
+            TU_ARMA(Function, e) {
+                BUG(Span(), "Function constant in MIR after cleanup - " << c);
+                }
+            }
+        }
+        void put_param(const ::MIR::Param& p)
+        {
+            put_u8(static_cast<uint8_t>(p.tag()));
+            TU_MATCH_HDRA( (p), {)
+            TU_ARMA(LValue, e) {
+                put_lvalue(e);
+                }
+            TU_ARMA(Borrow, e) {
+                put_u8(static_cast<uint8_t>(e.type));
+                put_lvalue(e.val);
+                }
+            TU_ARMA(Constant, e) {
+                put_constant(e);
+                }
+            }
+        }
+        void put_params(const ::std::vector<::MIR::Param>& ps)
+        {
+            put_uint(ps.size());
+            for(const auto& p : ps)
+                put_param(p);
+        }
+        void put_rvalue(const ::MIR::RValue& rv)
+        {
+            put_u8(static_cast<uint8_t>(rv.tag()));
+            TU_MATCH_HDRA( (rv), {)
+            TU_ARMA(Use, e) {
+                put_lvalue(e);
+                }
+            TU_ARMA(Borrow, e) {
+                put_u8(static_cast<uint8_t>(e.type));
+                put_lvalue(e.val);
+                }
+            TU_ARMA(Constant, e) {
+                put_constant(e);
+                }
+            TU_ARMA(SizedArray, e) {
+                put_param(e.val);
+                put_uint(e.count.as_Known());
+                }
+            TU_ARMA(Cast, e) {
+                put_lvalue(e.val);
+                put_type(e.type);
+                }
+            TU_ARMA(BinOp, e) {
+                put_param(e.val_l);
+                put_u8(static_cast<uint8_t>(e.op));
+                put_param(e.val_r);
+                }
+            TU_ARMA(UniOp, e) {
+                put_lvalue(e.val);
+                put_u8(static_cast<uint8_t>(e.op));
+                }
+            TU_ARMA(DstMeta, e) {
+                put_lvalue(e.val);
+                }
+            TU_ARMA(DstPtr, e) {
+                put_lvalue(e.val);
+                }
+            TU_ARMA(MakeDst, e) {
+                put_param(e.ptr_val);
+                put_param(e.meta_val);
+                }
+            TU_ARMA(Tuple, e) {
+                put_params(e.vals);
+                }
+            TU_ARMA(Array, e) {
+                put_params(e.vals);
+                }
+            TU_ARMA(UnionVariant, e) {
+                put_path(e.path);
+                put_uint(e.index);
+                put_param(e.val);
+                }
+            TU_ARMA(EnumVariant, e) {
+                put_path(e.path);
+                put_uint(e.index);
+                put_params(e.vals);
+                }
+            TU_ARMA(Struct, e) {
+                put_path(e.path);
+                put_params(e.vals);
+                }
+            }
+        }
+        void put_statement(const ::MIR::Statement& stmt)
+        {
+            put_u8(static_cast<uint8_t>(stmt.tag()));
+            TU_MATCH_HDRA( (stmt), {)
+            TU_ARMA(Assign, se) {
+                put_lvalue(se.dst);
+                put_rvalue(se.src);
+                }
+            TU_ARMA(Asm, se) {
+                put_str(se.tpl);
+                put_uint(se.outputs.size());
+                for(const auto& v : se.outputs) {
+                    put_str(v.first);
+                    put_lvalue(v.second);
+                }
+                put_uint(se.inputs.size());
+                for(const auto& v : se.inputs) {
+                    put_str(v.first);
+                    put_lvalue(v.second);
+                }
+                put_uint(se.clobbers.size());
+                for(const auto& v : se.clobbers)
+                    put_str(v);
+                put_uint(se.flags.size());
+                for(const auto& v : se.flags)
+                    put_str(v);
+                }
+            TU_ARMA(Asm2, se) {
+                uint8_t options = 0;
+                #define _(n,i)    if(se.options.n) options |= (1 << i)
+                _(pure, 0);
+                _(nomem, 1);
+                _(readonly, 2);
+                _(preserves_flags, 3);
+                _(noreturn, 4);
+                _(nostack, 5);
+                _(att_syntax, 6);
+                #undef _
+                put_u8(options);
+                put_uint(se.lines.size());
+                for(const auto& l : se.lines)
+                {
+                    put_uint(l.frags.size());
+                    for(const auto& f : l.frags)
+                    {
+                        put_str(f.before);
+                        put_uint(f.index);
+                        put_u8(static_cast<uint8_t>(f.modifier));
+                    }
+                    put_str(l.trailing);
+                }
+                put_uint(se.params.size());
+                for(const auto& p : se.params)
+                {
+                    put_u8(static_cast<uint8_t>(p.tag()));
+                    TU_MATCH_HDRA( (p), {)
+                    TU_ARMA(Const, v) {
+                        put_constant(v);
+                        }
+                    TU_ARMA(Sym, v) {
+                        put_path(v);
+                        }
+                    TU_ARMA(Reg, v) {
+                        put_u8(static_cast<uint8_t>(v.dir));
+                        put_u8(static_cast<uint8_t>(v.spec.tag()));
+                        TU_MATCH_HDRA( (v.spec), {)
+                        TU_ARMA(Class, c)       put_u8(static_cast<uint8_t>(c));
+                        TU_ARMA(Explicit, name) put_str(name);
+                        }
+                        put_u8(v.input ? 1 : 0);
+                        if( v.input )
+                            put_param(*v.input);
+                        put_u8(v.output ? 1 : 0);
+                        if( v.output )
+                            put_lvalue(*v.output);
+                        }
+                    }
+                }
+                }
+            TU_ARMA(SetDropFlag, se) {
+                put_uint(se.idx);
+                put_u8(se.new_val ? 1 : 0);
+                // `other` is ~0u when unused, stored offset by one to keep it small
+                put_uint(se.other == ~0u ? 0 : se.other + 1);
+                }
+            TU_ARMA(Drop, se) {
+                put_u8(static_cast<uint8_t>(se.kind));
+                put_lvalue(se.slot);
+                put_uint(se.flag_idx == ~0u ? 0 : se.flag_idx + 1);
+                }
+            TU_ARMA(ScopeEnd, se) {
+                BUG(Span(), "ScopeEnd should be filtered by the caller");
+                }
+            }
+        }
+        void put_terminator(const ::MIR::Terminator& term)
+        {
+            put_u8(static_cast<uint8_t>(term.tag()));
+            TU_MATCH_HDRA( (term), {)
+            TU_ARMA(Incomplete, e) {}
+            TU_ARMA(Return, e) {}
+            TU_ARMA(Diverge, e) {}
+            TU_ARMA(Goto, e) {
+                put_uint(e);
+                }
+            TU_ARMA(Panic, e) {
+                put_uint(e.dst);
+                }
+            TU_ARMA(If, e) {
+                put_lvalue(e.cond);
+                put_uint(e.bb_true);
+                put_uint(e.bb_false);
+                }
+            TU_ARMA(Switch, e) {
+                put_lvalue(e.val);
+                put_uint(e.targets.size());
+                for(auto t : e.targets)
+                    put_uint(t);
+                }
+            TU_ARMA(SwitchValue, e) {
+                put_lvalue(e.val);
+                put_uint(e.def_target);
+                put_uint(e.targets.size());
+                for(auto t : e.targets)
+                    put_uint(t);
+                put_u8(static_cast<uint8_t>(e.values.tag()));
+                TU_MATCH_HDRA( (e.values), {)
+                TU_ARMA(Unsigned, ve) {
+                    for(auto v : ve)
+                        put_uint(v);
+                    }
+                TU_ARMA(Signed, ve) {
+                    for(auto v : ve)
+                        put_sint(v);
+                    }
+                TU_ARMA(String, ve) {
+                    for(const auto& v : ve)
+                        put_str(v);
+                    }
+                TU_ARMA(ByteString, ve) {
+                    for(const auto& v : ve)
+                        put_bytes(v.data(), v.size());
+                    }
+                }
+                }
+            TU_ARMA(Call, e) {
+                put_uint(e.ret_block);
+                put_uint(e.panic_block);
+                put_lvalue(e.ret_val);
+                put_u8(static_cast<uint8_t>(e.fcn.tag()));
+                TU_MATCH_HDRA( (e.fcn), {)
+                TU_ARMA(Value, f) {
+                    put_lvalue(f);
+                    }
+                TU_ARMA(Path, f) {
+                    put_path(f);
+                    }
+                TU_ARMA(Intrinsic, f) {
+                    put_istr(f.name.c_str());
+                    put_uint(f.params.m_types.size());
+                    for(const auto& t : f.params.m_types)
+                        put_type(t);
+                    }
+                }
+                put_params(e.args);
+                }
+            }
+        }
+
+        /// Type record, `variants` holds the tag bytes of each variant (empty for the wildcard variant) and its data field (or SIZE_MAX)
+        void put_type_def(const ::std::string& name, const TypeRepr& repr, const ::HIR::Path* drop_glue, const ::HIR::TypeRef* dst_meta,
+            const TypeRepr::FieldPath* tag_path, const ::std::vector<::std::pair<::std::string, size_t>>& variants)
+        {
+            put_istr(name);
+            put_uint(repr.size);
+            put_uint(repr.align);
+            if( drop_glue ) {
+                put_uint(string_id(FMT(Trans_Mangle(*drop_glue))) + 1);
+            }
+            else {
+                put_uint(0);
+            }
+            put_uint(dst_meta ? type_id(*dst_meta) + 1 : 0);
+            put_uint(repr.fields.size());
+            for(const auto& f : repr.fields)
+            {
+                put_uint(f.offset);
+                put_type(f.ty);
+            }
+            put_uint(variants.size());
+            if( !variants.empty() )
+            {
+                assert(tag_path);
+                put_uint(tag_path->index);
+                put_uint(tag_path->sub_fields.size());
+                for(auto i : tag_path->sub_fields)
+                    put_uint(i);
+                for(const auto& v : variants)
+                {
+                    put_str(v.first);
+                    put_uint(v.second == SIZE_MAX ? 0 : v.second + 1);
+                }
+            }
+            end_item(MmirBinary::ItemType::Type);
+        }
+        void put_static(const ::HIR::Path& p, const ::HIR::TypeRef& ty, const EncodedLiteral& encoded)
+        {
+            put_path(p);
+            put_type(ty);
+            put_bytes(encoded.bytes.data(), encoded.bytes.size());
+            put_uint(encoded.relocations.size());
+            for(const auto& r : encoded.relocations)
+            {
+                put_uint(r.ofs);
+                put_uint(r.len);
+                if( r.p ) {
+                    put_u8(1);
+                    put_path(*r.p);
+                }
+                else {
+                    put_u8(0);
+                    put_str(r.bytes);
+                }
+            }
+            end_item(MmirBinary::ItemType::Static);
+        }
+
+        /// Function record: signature (then the body, if `body` is non-null)
+        void put_function(const ::std::string& name, const ::std::vector<::HIR::TypeRef>& args, const ::HIR::TypeRef& ret_ty, bool is_variadic,
+            const ::std::string& link_name, const ::std::string& abi, const ::MIR::Function* body)
+        {
+            put_istr(name);
+            put_function_sig(args, ret_ty, is_variadic, link_name, abi, body != nullptr);
+            if( body )
+                put_function_body(*body);
+            end_item(MmirBinary::ItemType::Function);
+        }
+        void put_function_sig(const ::std::vector<::HIR::TypeRef>& args, const ::HIR::TypeRef& ret_ty, bool is_variadic,
+            const ::std::string& link_name, const ::std::string& abi, bool has_body)
+        {
+            put_uint(args.size());
+            for(const auto& t : args)
+                put_type(t);
+            put_type(ret_ty);
+            uint8_t flags = 0;
+            if( has_body )  flags |= MmirBinary::FUNCTION_HAS_BODY;
+            if( link_name != "" )   flags |= MmirBinary::FUNCTION_IS_EXTERN;
+            if( is_variadic )   flags |= MmirBinary::FUNCTION_IS_VARIADIC;
+            put_u8(flags);
+            if( link_name != "" )
+            {
+                put_str(link_name);
+                put_str(abi);
+            }
+        }
+        void put_function_body(const ::MIR::Function& fcn)
+        {
+            put_uint(fcn.locals.size());
+            for(const auto& t : fcn.locals)
+                put_type(t);
+            put_uint(fcn.drop_flags.size());
+            for(bool v : fcn.drop_flags)
+                put_u8(v ? 1 : 0);
+            put_uint(fcn.blocks.size());
+            for(const auto& bb : fcn.blocks)
+            {
+                size_t n_stmts = 0;
+                for(const auto& stmt : bb.statements)
+                    n_stmts += (stmt.is_ScopeEnd() ? 0 : 1);
+                put_uint(n_stmts);
+                for(const auto& stmt : bb.statements)
+                {
+                    if( !stmt.is_ScopeEnd() )
+                        put_statement(stmt);
+                }
+                put_terminator(bb.terminator);
+            }
+        }
+
+    private:
+        unsigned string_id(const ::std::string& s)
+        {
+            auto it = m_string_ids.find(s);
+            if( it == m_string_ids.end() )
+            {
+                it = m_string_ids.insert(::std::make_pair(s, static_cast<unsigned>(m_strings.size()))).first;
+                m_strings.push_back(&it->first);
+            }
+            return it->second;
+        }
+        unsigned type_id(const ::HIR::TypeRef& ty)
+        {
+            auto it = m_type_ids.find(ty);
+            if( it != m_type_ids.end() )
+                return it->second;
+
+            // Inner types are added first, so a type only refers to earlier entries
+            ::std::string   enc;
+            auto put_tag = [&](MmirBinary::TypeTag t) { enc.push_back(static_cast<char>(t)); };
+            auto put_inner = [&](const ::HIR::TypeRef& t) { MmirBinary::write_uint(enc, type_id(t)); };
+            auto put_name = [&](const ::std::string& s) { MmirBinary::write_uint(enc, string_id(s)); };
+            TU_MATCH_HDRA( (ty.data()), {)
+            TU_ARMA(Diverge, te) {
+                put_tag(MmirBinary::TypeTag::Diverge);
+                }
+            TU_ARMA(Primitive, te) {
+                put_tag(MmirBinary::TypeTag::Primitive);
+                enc.push_back(static_cast<char>(te));
+                }
+            TU_ARMA(Path, te) {
+                put_tag(MmirBinary::TypeTag::Composite);
+                put_name(FMT(Trans_Mangle(te.path)));
+                }
+            TU_ARMA(Tuple, te) {
+                if( te.empty() ) {
+                    put_tag(MmirBinary::TypeTag::Unit);
+                }
+                else {
+                    put_tag(MmirBinary::TypeTag::Composite);
+                    put_name(FMT(Trans_Mangle(ty)));
+                }
+                }
+            TU_ARMA(TraitObject, te) {
+                put_tag(MmirBinary::TypeTag::TraitObject);
+                put_name(FMT(Trans_Mangle(te.m_trait.m_path)));
+                }
+            TU_ARMA(Array, te) {
+                type_id(te.inner);
+                put_tag(MmirBinary::TypeTag::Array);
+                MmirBinary::write_uint(enc, te.size.as_Known());
+                put_inner(te.inner);
+                }
+            TU_ARMA(Slice, te) {
+                type_id(te.inner);
+                put_tag(MmirBinary::TypeTag::Slice);
+                put_inner(te.inner);
+                }
+            TU_ARMA(Borrow, te) {
+                type_id(te.inner);
+                put_tag(MmirBinary::TypeTag::Borrow);
+                enc.push_back(static_cast<char>(te.type));
+                put_inner(te.inner);
+                }
+            TU_ARMA(Pointer, te) {
+                type_id(te.inner);
+                put_tag(MmirBinary::TypeTag::Pointer);
+                enc.push_back(static_cast<char>(te.type));
+                put_inner(te.inner);
+                }
+            TU_ARMA(Function, te) {
+                for(const auto& t : te.m_arg_types)
+                    type_id(t);
+                type_id(te.m_rettype);
+                put_tag(MmirBinary::TypeTag::Function);
+                enc.push_back(static_cast<char>( (te.is_unsafe ? 1 : 0) | (te.is_variadic ? 2 : 0) ));
+                put_name(te.m_abi.c_str());
+                MmirBinary::write_uint(enc, te.m_arg_types.size());
+                for(const auto& t : te.m_arg_types)
+                    put_inner(t);
+                put_inner(te.m_rettype);
+                }
+            TU_ARMA(Infer, te)  BUG(Span(), "Unexpected type in trans: " << ty);
+            TU_ARMA(Generic, te)    BUG(Span(), "Unexpected type in trans: " << ty);
+            TU_ARMA(ErasedType, te) BUG(Span(), "Unexpected type in trans: " << ty);
+            TU_ARMA(NamedFunction, te)  BUG(Span(), "Unexpected type in trans: " << ty);
+            TU_ARMA(Closure, te)    BUG(Span(), "Unexpected type in trans: " << ty);
+            TU_ARMA(Generator, te)  BUG(Span(), "Unexpected type in trans: " << ty);
+            }
+
+            auto id = static_cast<unsigned>(m_type_ids.size());
+            m_type_ids.insert(::std::make_pair(ty.clone(), id));
+            m_types += enc;
+            return id;
+        }
+    };
+
     class CodeGenerator_MonoMir:
         public CodeGenerator
     {
@@ -250,24 +863,38 @@ namespace
 
         ::std::string   m_outfile_path;
         ::std::ofstream m_of;
+        /// Set when writing the binary format (all items are written through this instead of as text)
+        ::std::unique_ptr<BinaryWriter> m_bin;
         const ::MIR::TypeResolve* m_mir_res;
 
     public:
-        CodeGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile):
+        CodeGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile, bool binary):
             m_crate(crate),
             m_resolve(crate),
             m_outfile_path(outfile),
-            m_of(m_outfile_path + ".mir")
+            m_of(m_outfile_path + ".mir", binary ? ::std::ios_base::out | ::std::ios_base::binary : ::std::ios_base::out)
         {
+            if( binary )
+            {
+                m_bin.reset(new BinaryWriter(m_of));
+            }
             for( const auto& crate_name : m_crate.m_ext_crates_ordered )
             {
-                m_of << "crate \"" << FmtEscaped(m_crate.m_ext_crates.at(crate_name).m_path) << ".mir\";\n";
+                const auto& path = m_crate.m_ext_crates.at(crate_name).m_path;
+                if( m_bin )
+                    m_bin->add_crate(path + ".mir");
+                else
+                    m_of << "crate \"" << FmtEscaped(path) << ".mir\";\n";
             }
         }
 
         void finalise(const TransOptions& opt, CodegenOutput out_ty, const ::std::string& hir_file) override
         {
-            if( out_ty == CodegenOutput::Executable )
+            if( out_ty == CodegenOutput::Executable && m_bin )
+            {
+                emit_entrypoints_bin();
+            }
+            else if( out_ty == CodegenOutput::Executable )
             {
                 m_of << "fn main#(isize, *const *const i8): isize {\n";
                 auto c_start_path = m_resolve.m_crate.get_lang_item_path_opt("mrustc-start");
@@ -276,7 +903,7 @@ namespace
                     m_of << "\tlet m: fn();\n";
                     m_of << "\t0: {\n";
                     m_of << "\t\tASSIGN m = ADDROF " << fmt(::HIR::GenericPath(m_resolve.m_crate.get_lang_item_path(Span(), "mrustc-main"))) << ";\n";
-                    m_of << "\t\tCALL RETURN = " << fmt(::HIR::GenericPath(m_resolve.m_crate.get_lang_item_path(Span(), "start"))) << "(m, arg0, arg1) goto 1 else 1\n";
+                    m_of << "\t\tCALL RETURN = " << fmt(get_start_path()) << "(m, arg0, arg1) goto 1 else 1\n";
                 }
                 else
                 {
@@ -305,6 +932,10 @@ namespace
                 }
             }
 
+            if( m_bin )
+            {
+                m_bin->finish();
+            }
             m_of.flush();
             m_of.close();
 
@@ -336,6 +967,12 @@ namespace
                     bool has_drop_glue = m_resolve.type_needs_drop_glue(sp, ty);
                     auto drop_glue_path = ::HIR::Path(ty.clone(), "#drop_glue");
 
+                    if( m_bin )
+                    {
+                        m_bin->put_type_def(FMT(fmt(ty)), *repr, has_drop_glue ? &drop_glue_path : nullptr, nullptr, nullptr, {});
+                        m_mir_res = nullptr;
+                        return ;
+                    }
                     m_of << "type " << fmt(ty) << " {\n";
                     m_of << "\tSIZE " << repr->size << ", ALIGN " << repr->align << ";\n";
                     if( has_drop_glue )
@@ -460,6 +1097,15 @@ namespace
 
             const auto* repr = Target_GetTypeRepr(sp, m_resolve, ty);
             MIR_ASSERT(*m_mir_res, repr, "No repr for struct " << ty);
+            if( m_bin )
+            {
+                ::HIR::TypeRef  dst_meta;
+                if( repr->size == SIZE_MAX )
+                    dst_meta = H::get_metadata_type(sp, m_resolve, *repr);
+                m_bin->put_type_def(FMT(Trans_Mangle(p)), *repr, has_drop_glue ? &drop_glue_path : nullptr, repr->size == SIZE_MAX ? &dst_meta : nullptr, nullptr, {});
+                m_mir_res = nullptr;
+                return ;
+            }
             m_of << "type " << Trans_Mangle(p) << " {\n";
             m_of << "\tSIZE " << repr->size << ", ALIGN " << repr->align << ";\n";
             if( repr->size == SIZE_MAX )
@@ -492,6 +1138,23 @@ namespace
             // Create constructor function
             const auto& var_ty = item.m_data.as_Data().at(var_idx).type;
             const auto& e = var_ty.data().as_Path().binding.as_Struct()->m_data.as_Tuple();
+            if( m_bin )
+            {
+                ::std::vector<::HIR::TypeRef>   arg_tys;
+                ::std::vector<::MIR::Param> vals;
+                for(unsigned int i = 0; i < e.size(); i ++)
+                {
+                    arg_tys.push_back(monomorph(e[i].ent).clone());
+                    vals.push_back(::MIR::LValue::new_Argument(i));
+                }
+                ::MIR::Function body;
+                body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Return({}) });
+                body.blocks.back().statements.push_back(::MIR::Statement::make_Assign({
+                    ::MIR::LValue::new_Return(), ::MIR::RValue::make_EnumVariant({ enum_path.clone(), static_cast<unsigned>(var_idx), mv$(vals) })
+                    }));
+                m_bin->put_function(FMT(fmt(var_path)), arg_tys, ::HIR::TypeRef::new_path(mv$(enum_path), &item), false, "", "", &body);
+                return ;
+            }
             m_of << "/* " << var_path << " */\n";
             m_of << "fn " << fmt(var_path) << "(";
             for(unsigned int i = 0; i < e.size(); i ++)
@@ -522,6 +1185,23 @@ namespace
             auto monomorph = [&](const auto& x)->const auto& { return m_resolve.monomorph_expand_opt(sp, tmp, x, ms); };
             // Create constructor function
             const auto& e = item.m_data.as_Tuple();
+            if( m_bin )
+            {
+                ::std::vector<::HIR::TypeRef>   arg_tys;
+                ::std::vector<::MIR::Param> vals;
+                for(unsigned int i = 0; i < e.size(); i ++)
+                {
+                    arg_tys.push_back(monomorph(e[i].ent).clone());
+                    vals.push_back(::MIR::LValue::new_Argument(i));
+                }
+                ::MIR::Function body;
+                body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Return({}) });
+                body.blocks.back().statements.push_back(::MIR::Statement::make_Assign({
+                    ::MIR::LValue::new_Return(), ::MIR::RValue::make_Struct({ p.clone(), mv$(vals) })
+                    }));
+                m_bin->put_function(FMT(fmt(p)), arg_tys, ::HIR::TypeRef::new_path(p.clone(), &item), false, "", "", &body);
+                return ;
+            }
             m_of << "/* " << p << " */\n";
             m_of << "fn " << fmt(p) << "(";
             for(unsigned int i = 0; i < e.size(); i ++)
@@ -558,6 +1238,12 @@ namespace
 
             const auto* repr = Target_GetTypeRepr(sp, m_resolve, ty);
             MIR_ASSERT(*m_mir_res, repr, "No repr for union " << ty);
+            if( m_bin )
+            {
+                m_bin->put_type_def(FMT(fmt(p)), *repr, has_drop_glue ? &drop_glue_path : nullptr, nullptr, nullptr, {});
+                m_mir_res = nullptr;
+                return ;
+            }
             m_of << "type " << fmt(p) << " {\n";
             m_of << "\tSIZE " << repr->size << ", ALIGN " << repr->align << ";\n";
             if( has_drop_glue )
@@ -587,6 +1273,45 @@ namespace
 
             const auto* repr = Target_GetTypeRepr(sp, m_resolve, ty);
             MIR_ASSERT(*m_mir_res, repr, "No repr for enum " << ty);
+            if( m_bin )
+            {
+                // Same variant list as the textual form below (tag bytes, or empty for the niche/wildcard variant)
+                auto tag_bytes = [&](const TypeRepr::FieldPath& path, uint64_t v) {
+                    ::std::string   rv;
+                    for(size_t i = 0; i < path.size; i ++)
+                        rv.push_back(static_cast<char>( (v >> (i*8)) & 0xFF ));
+                    return rv;
+                    };
+                const TypeRepr::FieldPath*  tag_path = nullptr;
+                ::std::vector<::std::pair<::std::string, size_t>>   variants;
+                TU_MATCH_HDRA( (repr->variants), {)
+                TU_ARMA(None, e) {
+                    }
+                TU_ARMA(Linear, e) {
+                    tag_path = &e.field;
+                    for(size_t i = 0; i < e.num_variants; i ++)
+                        variants.push_back(::std::make_pair( e.is_niche(i) ? "" : tag_bytes(e.field, e.offset + i), item.is_value() ? SIZE_MAX : i ));
+                    }
+                TU_ARMA(Values, e) {
+                    tag_path = &e.field;
+                    for(size_t i = 0; i < e.values.size(); i ++)
+                        variants.push_back(::std::make_pair( tag_bytes(e.field, e.values[i]), item.is_value() ? SIZE_MAX : i ));
+                    }
+                TU_ARMA(NonZero, e) {
+                    tag_path = &e.field;
+                    for(size_t i = 0; i < 2; i ++)
+                    {
+                        if( e.zero_variant == i )
+                            variants.push_back(::std::make_pair( ::std::string(e.field.size, '\0'), SIZE_MAX ));
+                        else
+                            variants.push_back(::std::make_pair( ::std::string(), i ));
+                    }
+                    }
+                }
+                m_bin->put_type_def(FMT(fmt(p)), *repr, has_drop_glue ? &drop_glue_path : nullptr, nullptr, tag_path, variants);
+                m_mir_res = nullptr;
+                return ;
+            }
             m_of << "type " << fmt(p) << " {\n";
             m_of << "\tSIZE " << repr->size << ", ALIGN " << repr->align << ";\n";
             if( has_drop_glue )
@@ -711,6 +1436,12 @@ namespace
 
             auto type = params.monomorph(m_resolve, item.m_type);
 
+            if( m_bin )
+            {
+                m_bin->put_static(p, type, encoded);
+                m_mir_res = nullptr;
+                return ;
+            }
             m_of << "static " << fmt(p) << ": " << fmt(type) << " = \"";
             for(auto b : encoded.bytes)
                 emit_str_byte(b);
@@ -744,6 +1475,15 @@ namespace
                 ::HIR::TypeRef  ret_type_tmp;
                 const auto& ret_type = monomorphise_fcn_return(ret_type_tmp, item, params);
 
+                if( m_bin )
+                {
+                    ::std::vector<::HIR::TypeRef>   arg_tys;
+                    for(const auto& a : item.m_args)
+                        arg_tys.push_back(params.monomorph(m_resolve, a.second));
+                    m_bin->put_function(FMT(fmt(p)), arg_tys, ret_type, item.m_variadic, item.m_linkage.name, item.m_abi.c_str(), nullptr);
+                    m_mir_res = nullptr;
+                    return ;
+                }
                 m_of << "/* " << p << " */\n";
                 m_of << "fn " << fmt(p) << "(";
                 for(unsigned int i = 0; i < item.m_args.size(); i ++)
@@ -770,6 +1510,16 @@ namespace
             ::MIR::TypeResolve  mir_res { sp, m_resolve, FMT_CB(ss, ss << p;), ret_type, arg_types, *code };
             m_mir_res = &mir_res;
 
+            if( m_bin )
+            {
+                ::std::vector<::HIR::TypeRef>   arg_tys;
+                for(const auto& a : arg_types)
+                    arg_tys.push_back(a.second.clone());
+                m_bin->put_function(FMT(fmt(p)), arg_tys, ret_type, item.m_variadic, item.m_linkage.name, item.m_abi.c_str(), &*code);
+                m_mir_res = nullptr;
+                return ;
+            }
+
             // - Signature
             m_of << "/* " << p << " */\n";
             m_of << "fn " << fmt(p) << "(";
@@ -925,7 +1675,7 @@ namespace
                         }
                         else
                         {
-                            m_of << (se.new_val ? "" : "!") << "df" << se.other;
+                            m_of << (se.new_val ? "!" : "") << "df" << se.other;
                         }
                         } break;
                     TU_ARM(stmt, Asm, se) {
@@ -1121,6 +1871,71 @@ namespace
 
 
     private:
+        /// Path to the `start` lang item, as instantiated by `Trans_Enumerate_Main`
+        ::HIR::GenericPath get_start_path() const
+        {
+            const auto& crate = m_resolve.m_crate;
+            auto start_gpath = ::HIR::GenericPath(crate.get_lang_item_path(Span(), "start"));
+            if( TARGETVER_LEAST_1_29 ) {
+                // With 1.29, this now takes main's return type as a type parameter
+                const auto& main_fcn = crate.get_function_by_path(Span(), crate.get_lang_item_path(Span(), "mrustc-main"));
+                start_gpath.m_params.m_types.push_back( main_fcn.m_return.clone() );
+            }
+            return start_gpath;
+        }
+        /// Binary equivalents of the `main#` and `panic_impl#` shims written by `finalise`
+        void emit_entrypoints_bin()
+        {
+            const auto& crate = m_resolve.m_crate;
+            ::std::vector<::HIR::TypeRef>   main_args;
+            main_args.push_back(::HIR::CoreType::Isize);
+            main_args.push_back(::HIR::TypeRef::new_pointer(::HIR::BorrowType::Shared, ::HIR::TypeRef::new_pointer(::HIR::BorrowType::Shared, ::HIR::CoreType::I8)));
+
+            ::MIR::Function main_body;
+            ::std::vector<::MIR::Param> call_args;
+            auto c_start_path = crate.get_lang_item_path_opt("mrustc-start");
+            ::MIR::CallTarget   call_target;
+            if( c_start_path == ::HIR::SimplePath() )
+            {
+                ::HIR::TypeData_FunctionPointer ft { {}, false, false, RcString::new_interned(ABI_RUST), ::HIR::TypeRef::new_unit(), {} };
+                main_body.locals.push_back(::HIR::TypeRef(mv$(ft)));
+                main_body.blocks.push_back(::MIR::BasicBlock { {}, {} });
+                main_body.blocks.back().statements.push_back(::MIR::Statement::make_Assign({
+                    ::MIR::LValue::new_Local(0),
+                    ::MIR::RValue::make_Constant(::MIR::Constant::make_ItemAddr(box$(::HIR::Path(::HIR::GenericPath(crate.get_lang_item_path(Span(), "mrustc-main"))))))
+                    }));
+                call_target = ::HIR::Path(get_start_path());
+                call_args.push_back(::MIR::LValue::new_Local(0));
+            }
+            else
+            {
+                main_body.blocks.push_back(::MIR::BasicBlock { {}, {} });
+                call_target = ::HIR::Path(::HIR::GenericPath(c_start_path));
+            }
+            call_args.push_back(::MIR::LValue::new_Argument(0));
+            call_args.push_back(::MIR::LValue::new_Argument(1));
+            main_body.blocks.back().terminator = ::MIR::Terminator::make_Call({ 1, 1, ::MIR::LValue::new_Return(), mv$(call_target), mv$(call_args) });
+            main_body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Return({}) });
+            m_bin->put_function("main#", main_args, ::HIR::CoreType::Isize, false, "", "", &main_body);
+
+            if(TARGETVER_LEAST_1_29)
+            {
+                // Bind `panic_impl` lang item to the item tagged with `panic_implementation`
+                const auto& panic_impl_path = crate.get_lang_item_path(Span(), "mrustc-panic_implementation");
+                ::std::vector<::HIR::TypeRef>   args;
+                args.push_back(::HIR::CoreType::Usize);
+                ::std::vector<::MIR::Param> call_args;
+                call_args.push_back(::MIR::LValue::new_Argument(0));
+                ::MIR::Function body;
+                body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Call({
+                    1, 2, ::MIR::LValue::new_Return(), ::HIR::Path(::HIR::GenericPath(panic_impl_path)), mv$(call_args)
+                    }) });
+                body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Return({}) });
+                body.blocks.push_back(::MIR::BasicBlock { {}, ::MIR::Terminator::make_Diverge({}) });
+                m_bin->put_function("panic_impl#", args, ::HIR::CoreType::U32, false, "panic_impl", "Rust", &body);
+            }
+        }
+
         const ::HIR::TypeRef& monomorphise_fcn_return(::HIR::TypeRef& tmp, const ::HIR::Function& item, const Trans_Params& params)
         {
             bool has_erased = visit_ty_with(item.m_return, [&](const auto& x) { return x.data().is_ErasedType(); });
@@ -1157,7 +1972,7 @@ namespace
     Span CodeGenerator_MonoMir::sp;
 }
 
-::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile)
+::std::unique_ptr<CodeGenerator> Trans_Codegen_GetGenerator_MonoMir(const ::HIR::Crate& crate, const ::std::string& outfile, bool binary)
 {
-    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_MonoMir(crate, outfile));
+    return ::std::unique_ptr<CodeGenerator>(new CodeGenerator_MonoMir(crate, outfile, binary));
 }
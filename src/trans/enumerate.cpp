@@ -59,10 +59,27 @@ namespace {
                 e->ptr = &fcn;
                 e->pp = mv$(pp);
                 DEBUG( *e->path << " w/ " << e->pp.pp_impl << " and " << e->pp.pp_method);
+                // An upstream crate already emitted this instance, so just reference its symbol
+                // - The body is still enumerated (and monomorphised) so it can be inlined
+                if( e->pp.has_types() && is_shared_upstream(*e->path) )
+                {
+                    DEBUG("- Shared from upstream");
+                    e->force_prototype = true;
+                }
                 fcn_queue.push_back(e);
             }
         }
 
+        bool is_shared_upstream(const ::HIR::Path& p) const
+        {
+            for(const auto& e_crate : crate.m_ext_crates)
+            {
+                if( e_crate.second.m_data->m_shared_instances.count(p) != 0 )
+                    return true;
+            }
+            return false;
+        }
+
     private:
         void enumerate_link_functions()
         {
@@ -484,9 +501,12 @@ TransList Trans_Enumerate_Public(::HIR::Crate& crate)
                 Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
             }
         }
-        for(auto& impl : impl_group.second.non_named)
+        for(auto& impl_list : impl_group.second.non_named)
         {
-            Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
+            for(auto& impl : impl_list.second)
+            {
+                Trans_Enumerate_Public_TraitImpl(state, resolve, trait_path, *impl);
+            }
         }
         for(auto& impl : impl_group.second.generic)
         {
@@ -562,9 +582,12 @@ TransList Trans_Enumerate_Public(::HIR::Crate& crate)
             H1::enumerate_type_impl(state, *impl);
         }
     }
-    for(auto& impl : crate.m_type_impls.non_named)
+    for(auto& impl_list : crate.m_type_impls.non_named)
     {
-        H1::enumerate_type_impl(state, *impl);
+        for(auto& impl : impl_list.second)
+        {
+            H1::enumerate_type_impl(state, *impl);
+        }
     }
     for(auto& impl : crate.m_type_impls.generic)
     {
@@ -683,6 +706,11 @@ void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list)
         }
         Trans_Enumerate_FillFrom_PathMono(state, std::move(path));
     }
+    // Instances recorded in the metadata must be emitted, even if nothing here uses them any more
+    for(const auto& p : crate.m_shared_instances)
+    {
+        Trans_Enumerate_FillFrom_PathMono(state, p.clone());
+    }
     auto new_list = Trans_Enumerate_CommonPost(state);
 
     // Add stub entries to `new_list` for vtables and destructors, items that would be created by stages after enumerate
@@ -788,6 +816,21 @@ void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list)
 #endif
 }
 
+void Trans_Enumerate_RecordSharedInstances(::HIR::Crate& crate, const TransList& list)
+{
+    for(const auto& ent : list.m_functions)
+    {
+        const auto& fcn_ent = *ent.second;
+        // Only instances this crate generates code for (not ones already shared by an upstream crate)
+        if( !fcn_ent.monomorphised.code || fcn_ent.force_prototype )
+            continue ;
+        if( !fcn_ent.pp.has_types() || fcn_ent.ptr->m_linkage.name != "" )
+            continue ;
+        DEBUG("Shared: " << ent.first);
+        crate.m_shared_instances.insert( ent.first.clone() );
+    }
+}
+
 /// Common post-processing
 void Trans_Enumerate_CommonPost_Run(EnumState& state)
 {
@@ -1967,7 +2010,11 @@ void Trans_Enumerate_FillFrom_Function(EnumState& state, const HIR::Path& p, con
         auto it = state.orig_list->m_functions.find(p);
         if( it != state.orig_list->m_functions.end() )
         {
-            if( it->second->monomorphised.code ) {
+            if( it->second->force_prototype ) {
+                // Not emitted here (e.g. shared from upstream), so what it references isn't needed
+                DEBUG("Prototype only");
+            }
+            else if( it->second->monomorphised.code ) {
                 DEBUG("Monomorphised");
                 MIR::EnumCache  ec;
                 Trans_Enumerate_FillFrom_MIR(ec, *it->second->monomorphised.code);
@@ -19,8 +19,23 @@ struct TransOptions
     unsigned int opt_level = 0;
     bool emit_debug_info = false;
     ::std::string   build_command_file;
+    /// Number of C files the crate is split into (compiled concurrently, then merged)
+    unsigned int codegen_units = 1;
+    /// Export monomorphised generic instances for use by downstream crates (instead of each crate emitting a private copy)
+    bool share_generics = false;
 
     ::std::string   panic_crate;
+    /// Unwind through C frames using the compiler's unwind tables (running landing pads), instead of only `longjmp`ing to
+    /// the enclosing `try` (which leaks everything between)
+    bool unwind_tables = false;
+    /// Emit optimisation hints (branch hints, `restrict`, cold/noinline attributes) in the generated C
+    bool c_annotations = false;
+    /// Whole-program optimisation: emit LTO objects, and let the C compiler optimise across crates when linking
+    bool lto = false;
+    /// Directory to write profiling data to (instrumented build for profile-guided optimisation)
+    ::std::string   profile_generate;
+    /// Directory to read profiling data from (when optimising using a previous `profile_generate` build)
+    ::std::string   profile_use;
 
     ::std::vector< ::std::string>   library_search_dirs;
     ::std::vector< ::std::string>   libraries;
@@ -39,6 +54,8 @@ extern TransList Trans_Enumerate_Public(::HIR::Crate& crate);
 
 /// Re-run enumeration on monomorphised functions, removing now-unused items
 extern void Trans_Enumerate_Cleanup(const ::HIR::Crate& crate, TransList& list);
+/// Record the monomorphised instances that will be emitted with public linkage (saved in the crate metadata)
+extern void Trans_Enumerate_RecordSharedInstances(::HIR::Crate& crate, const TransList& list);
 
 extern void Trans_AutoImpls(::HIR::Crate& crate, TransList& trans_list);
 
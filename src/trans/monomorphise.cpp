@@ -162,7 +162,8 @@ namespace {
     for(const auto& var : tpl->locals)
     {
         DEBUG("- _" << output.locals.size() << " (" << var << ")");
-        output.locals.push_back( params.monomorph(resolve, var) );
+        // Interned: the same concrete types show up in many instantiations, and are used as layout cache keys
+        output.locals.push_back( params.monomorph(resolve, var).intern() );
         DEBUG(" = " << output.locals.back());
     }
     output.drop_flags = tpl->drop_flags;
@@ -10,6 +10,10 @@
 #include "../expand/cfg.hpp"
 #include <fstream>
 #include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <parallel.hpp>   // lazy_state_lock
 #include <hir/hir.hpp>
 #include <hir_typeck/helpers.hpp>
 #include <hir_conv/main_bindings.hpp>   // ConvertHIR_ConstantEvaluate_Enum
@@ -744,7 +748,7 @@ void Target_SetCfg(const ::std::string& target_name)
         });
 }
 
-bool Target_GetSizeAndAlignOf(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty, size_t& out_size, size_t& out_align)
+static bool Target_GetSizeAndAlignOf_(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty, size_t& out_size, size_t& out_align)
 {
     //TRACE_FUNCTION_FR(ty, "size=" << out_size << ", align=" << out_align);
     TU_MATCH_HDRA( (ty.data()), {)
@@ -2180,14 +2184,131 @@ namespace {
         return rv;
     }
 
-    // TODO: Thread safety on this cache?
-    static ::std::map<::HIR::TypeRef, ::std::unique_ptr<TypeRepr>>  s_cache;
+    /// Cached layout information for a type
+    /// - Each part is written at most once (with `lazy_state_lock` held), and the flag is set (with release ordering)
+    ///   after the value, so readers only need the shard lock to find the entry.
+    struct LayoutEntry
+    {
+        ::std::atomic<bool> has_repr { false };
+        /// Can be null (e.g. for generics)
+        ::std::unique_ptr<TypeRepr> repr;
+
+        ::std::atomic<bool> has_size { false };
+        /// Set if the size was loaded from an extern crate (so isn't exported again)
+        bool    size_is_extern = false;
+        size_t  size = 0;
+        size_t  align = 0;
+    };
+
+    /// Layout cache, sharded by type hash so parallel MIR optimisation/codegen workers don't contend on one lock
+    /// - Entries are never removed, so returned pointers/references stay valid after the shard lock is released
+    /// - Keys are interned, so they share storage with the (also interned) monomorphised MIR local types
+    class LayoutCache
+    {
+        static const size_t NUM_SHARDS = 16;
+        struct Key {
+            size_t  hash;
+            ::HIR::TypeRef  ty;
+
+            bool operator==(const Key& x) const { return hash == x.hash && ty == x.ty; }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& k) const { return k.hash; }
+        };
+        struct Shard {
+            ::std::mutex    lock;
+            ::std::unordered_map<Key, LayoutEntry, KeyHash> map;
+        };
+        Shard   m_shards[NUM_SHARDS];
+
+        ::std::once_flag    m_extern_loaded;
+
+    public:
+        /// Get the entry for a type, creating an empty one if it's not yet present
+        LayoutEntry& get(const ::HIR::TypeRef& ty)
+        {
+            auto h = ty.hash();
+            auto& shard = m_shards[h % NUM_SHARDS];
+            ::std::lock_guard<::std::mutex> lh { shard.lock };
+            auto it = shard.map.find(Key { h, ty.clone() });
+            if( it == shard.map.end() ) {
+                it = shard.map.emplace(::std::piecewise_construct, ::std::forward_as_tuple(Key { h, ty.intern() }), ::std::forward_as_tuple()).first;
+            }
+            return it->second;
+        }
+
+        /// Seed sizes from the layout tables of all loaded crates (done on the first size query)
+        void load_extern(const ::HIR::Crate& crate)
+        {
+            ::std::call_once(m_extern_loaded, [&]() {
+                ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
+                size_t  count = 0;
+                for(const auto& ec : crate.m_ext_crates)
+                {
+                    for(const auto& l : ec.second.m_data->m_type_layouts)
+                    {
+                        auto& ent = this->get(l.ty);
+                        if( ent.has_size.load(::std::memory_order_relaxed) )
+                            continue;
+                        ent.size = l.size;
+                        ent.align = l.align;
+                        ent.size_is_extern = true;
+                        ent.has_size.store(true, ::std::memory_order_release);
+                        count += 1;
+                    }
+                }
+                DEBUG("Loaded " << count << " type layouts from extern crates");
+                });
+        }
+
+        template<typename Cb>
+        void for_each(Cb cb)
+        {
+            for(auto& shard : m_shards)
+            {
+                ::std::lock_guard<::std::mutex> lh { shard.lock };
+                for(const auto& e : shard.map)
+                    cb(e.first.ty, e.second);
+            }
+        }
+    };
+    LayoutCache s_layout_cache;
 
     void set_type_repr(const Span& sp, const ::HIR::TypeRef& ty, ::std::unique_ptr<TypeRepr> repr)
     {
-        auto ires = s_cache.insert(::std::make_pair( ty.clone(), mv$(repr) ));
-        ASSERT_BUG(sp, ires.second, "set_type_repr called for type that already has a repr: " << ty);
-        DEBUG("Set repr for " << ires.first->first);
+        auto& ent = s_layout_cache.get(ty);
+        ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
+        ASSERT_BUG(sp, !ent.has_repr.load(::std::memory_order_relaxed), "set_type_repr called for type that already has a repr: " << ty);
+        ent.repr = mv$(repr);
+        ent.has_repr.store(true, ::std::memory_order_release);
+        DEBUG("Set repr for " << ty);
+    }
+
+    /// Returns true if the size of this type is worth caching (non-trivial to calculate, and independent of the generic scope)
+    bool is_size_cacheable(const ::HIR::TypeRef& ty)
+    {
+        switch(ty.data().tag())
+        {
+        case ::HIR::TypeData::TAG_Path:
+            switch(ty.data().as_Path().binding.tag())
+            {
+            case ::HIR::TypePathBinding::TAG_Struct:
+            case ::HIR::TypePathBinding::TAG_Enum:
+            case ::HIR::TypePathBinding::TAG_Union:
+                break;
+            default:
+                return false;
+            }
+            break;
+        case ::HIR::TypeData::TAG_Tuple:
+        case ::HIR::TypeData::TAG_Array:
+        case ::HIR::TypeData::TAG_Borrow:
+        case ::HIR::TypeData::TAG_Pointer:
+            break;
+        default:
+            return false;
+        }
+        return (ty.flags() & (::HIR::TypeRef::FLAG_HAS_GENERIC_TYPES|::HIR::TypeRef::FLAG_HAS_IVARS|::HIR::TypeRef::FLAG_HAS_ERASED)) == 0;
     }
 }
 void Target_ForceTypeRepr(const Span& sp, const ::HIR::TypeRef& ty, TypeRepr repr)
@@ -2207,18 +2328,76 @@ const TypeRepr* Target_GetTypeRepr(const Span& sp, const StaticTraitResolve& res
         return Target_GetTypeRepr(sp, resolve, ::HIR::TypeRef::new_path( mv$(path), ::HIR::TypePathBinding::make_Struct(&str) ));
     }
 #endif
-    auto it = s_cache.find(ty);
-    if( it != s_cache.end() )
+    auto& ent = s_layout_cache.get(ty);
+    if( ent.has_repr.load(::std::memory_order_acquire) )
     {
-        return it->second.get();
+        return ent.repr.get();
     }
 
-    auto ires = s_cache.insert(::std::make_pair( ty.clone(), make_type_repr(sp, resolve, ty) ));
-    if(ires.second)
+    // Generation can evaluate constants, so hold the global lock while doing it
+    ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
+    if( !ent.has_repr.load(::std::memory_order_relaxed) )
     {
-        DEBUG("Created repr for " << ires.first->first);
+        auto repr = make_type_repr(sp, resolve, ty);
+        // NOTE: Generation can recurse into this type (e.g. via a pointer), so only store if that didn't already
+        if( !ent.has_repr.load(::std::memory_order_relaxed) )
+        {
+            ent.repr = mv$(repr);
+            ent.has_repr.store(true, ::std::memory_order_release);
+            DEBUG("Created repr for " << ty);
+        }
     }
-    return ires.first->second.get();
+    return ent.repr.get();
+}
+bool Target_GetSizeAndAlignOf(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty, size_t& out_size, size_t& out_align)
+{
+    if( !is_size_cacheable(ty) )
+    {
+        return Target_GetSizeAndAlignOf_(sp, resolve, ty, out_size, out_align);
+    }
+
+    s_layout_cache.load_extern(resolve.m_crate);
+    auto& ent = s_layout_cache.get(ty);
+    if( ent.has_size.load(::std::memory_order_acquire) )
+    {
+        out_size = ent.size;
+        out_align = ent.align;
+        return true;
+    }
+
+    if( !Target_GetSizeAndAlignOf_(sp, resolve, ty, out_size, out_align) )
+        return false;
+
+    ::std::lock_guard<::std::recursive_mutex>   lh { lazy_state_lock() };
+    if( !ent.has_size.load(::std::memory_order_relaxed) )
+    {
+        ent.size = out_size;
+        ent.align = out_align;
+        ent.has_size.store(true, ::std::memory_order_release);
+    }
+    return true;
+}
+void Target_ExportTypeLayouts(::HIR::Crate& crate)
+{
+    // Only this crate's sized types are exported - other crates' types are exported by those crates (as long as the
+    // instantiation was used there)
+    crate.m_type_layouts.clear();
+    s_layout_cache.for_each([&](const ::HIR::TypeRef& ty, const LayoutEntry& ent) {
+        if( !ent.has_size.load(::std::memory_order_acquire) || ent.size_is_extern || ent.size == SIZE_MAX )
+            return ;
+        if( !ty.data().is_Path() )
+            return ;
+        const auto& p = ty.data().as_Path().path;
+        if( !p.m_data.is_Generic() || p.m_data.as_Generic().m_path.crate_name() != crate.m_crate_name )
+            return ;
+        // Closure/generator types can't be named by downstream crates
+        if( visit_ty_with(ty, [](const ::HIR::TypeRef& t){ return t.data().is_Closure() || t.data().is_Generator() || t.data().is_ErasedType(); }) )
+            return ;
+        crate.m_type_layouts.push_back(::HIR::Crate::TypeLayout { ty.clone(), ent.size, ent.align });
+        });
+    // Sort so the output is deterministic
+    ::std::sort(crate.m_type_layouts.begin(), crate.m_type_layouts.end(), [](const ::HIR::Crate::TypeLayout& a, const ::HIR::Crate::TypeLayout& b){ return a.ty < b.ty; });
+    DEBUG("Exported " << crate.m_type_layouts.size() << " type layouts");
 }
 const ::HIR::TypeRef& Target_GetInnerType(const Span& sp, const StaticTraitResolve& resolve, const TypeRepr& repr, size_t idx, const ::std::vector<size_t>& sub_fields, size_t ofs)
 {
@@ -180,6 +180,8 @@ extern bool Target_GetSizeAndAlignOf(const Span& sp, const StaticTraitResolve& r
 /// This function is for the MIR Optimisation tool, which has to be able to read and use existing layouts
 extern void Target_ForceTypeRepr(const Span& sp, const ::HIR::TypeRef& ty, TypeRepr repr);
 extern const TypeRepr* Target_GetTypeRepr(const Span& sp, const StaticTraitResolve& resolve, const ::HIR::TypeRef& ty);
+/// Save the cached layouts of this crate's types into `crate.m_type_layouts` (for downstream crates to load)
+extern void Target_ExportTypeLayouts(::HIR::Crate& crate);
 
 extern const ::HIR::TypeRef& Target_GetInnerType(const Span& sp, const StaticTraitResolve& resolve, const TypeRepr& repr, size_t idx, const ::std::vector<size_t>& sub_fields={}, size_t ofs=0);
 
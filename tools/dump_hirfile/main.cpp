@@ -67,9 +67,12 @@ namespace {
                 cb(*impl);
             }
         }
-        for(const auto& impl : ig.non_named)
+        for(const auto& non_named_il : ig.non_named)
         {
-            cb(*impl);
+            for(const auto& impl : non_named_il.second)
+            {
+                cb(*impl);
+            }
         }
         for(const auto& impl : ig.generic)
         {
@@ -16,6 +16,8 @@
 #include "stringlist.h"
 #include "jobs.hpp"
 #include "file_timestamp.h"
+#include "fingerprint.h"
+#include "build_cache.h"
 #include "os.hpp"
 #include <fstream>
 #include <cassert>
@@ -23,6 +25,7 @@
 #include <cstdint>
 #include <unordered_map>
 #include <algorithm>    // sort/find_if
+#include <memory>
 
 #ifdef _WIN32
 # define EXESUF ".exe"
@@ -39,12 +42,25 @@ struct RunState
     BuildOptions&   m_opts;
     const helpers::path& m_compiler_path;
     bool m_is_cross_compiling;
+    // Populated on first use (by `get_compiler_hash`)
+    mutable uint64_t    m_compiler_hash;
+    // Populated on first use (by `get_profile_hash`)
+    mutable uint64_t    m_profile_hash;
+    /// Shared output cache (`--cache-dir`)
+    ::std::unique_ptr<BuildCache>   m_cache;
 
     RunState(BuildOptions& opts, bool is_cross_compiling)
         : m_opts(opts)
         , m_compiler_path(os_support::get_mrustc_path())
         , m_is_cross_compiling(is_cross_compiling)
-    {}
+        , m_compiler_hash(0)
+        , m_profile_hash(0)
+    {
+        // NOTE: The cache relies on mrustc's depfile and output layout
+        if( opts.cache_dir.is_valid() && !opts.emit_mmir && !is_rustc() ) {
+            m_cache.reset(new BuildCache(opts.cache_dir));
+        }
+    }
 
     bool is_rustc() const {
         return m_compiler_path.basename() == "rustc" || m_compiler_path.basename() == "rustc.exe";
@@ -85,6 +101,14 @@ struct RunState
     }
 
     bool outfile_needs_rebuild(const helpers::path& outfile) const;
+    /// Hash of the compiler executable
+    uint64_t get_compiler_hash() const;
+    /// Hash of the profiles used by `-C profile-use` (zero if not in use)
+    /// - The profiles change the output without changing the command line or the inputs in the depfile
+    uint64_t get_profile_hash() const;
+    /// Hash of an input file (as listed in the depfile) for a fingerprint
+    /// - Crates are hashed by their public interface, unless `is_linking` (which also needs the object code)
+    uint64_t get_input_hash(const helpers::path& path, bool is_linking) const;
 
     /// Get the crate suffix (stuff added to the crate name to form the filename)
     ::std::string get_crate_suffix(const PackageManifest& manifest) const;
@@ -140,8 +164,19 @@ public:
     bool is_runnable() const override {
         return true;
     }
+    const char* skip_reason() override;
     bool complete(bool was_success) override;
     virtual helpers::path get_outfile() const = 0;
+    /// Returns true if the command line differs from the one recorded in the output's fingerprint
+    bool command_changed();
+protected:
+    /// Returns true if the output links in the dependencies' object code (instead of just using their metadata)
+    virtual bool is_linking() const = 0;
+    /// Record the inputs (from the depfile), so a future build can be skipped if they're all unchanged
+    void save_fingerprint();
+private:
+    /// Hash of everything that goes into the command line (compiler, arguments, and environment)
+    uint64_t get_command_hash();
 };
 class Job_BuildTarget: public Job_Build
 {
@@ -159,6 +194,19 @@ public:
 
     RunnableJob start() override;
     helpers::path get_outfile() const override;
+    const char* skip_reason() override;
+    bool complete(bool was_success) override;
+protected:
+    bool is_linking() const override;
+private:
+    /// Key for the shared cache, a hash of the command line with paths specific to this build replaced
+    uint64_t get_cache_key();
+    /// Hash of the current state of the inputs recorded in the cache
+    uint64_t get_cache_inputs_hash(const ::std::vector<::std::string>& inputs) const;
+    /// Replace the package and output directories with placeholders (so the cache can be shared between checkouts)
+    ::std::string normalise_path(::std::string s) const;
+    ::std::string denormalise_path(const ::std::string& s) const;
+    ::std::vector< ::std::pair<::std::string, const char*> > get_path_replacements() const;
 };
 class Job_BuildScript: public Job_Build
 {
@@ -170,6 +218,10 @@ public:
 
     RunnableJob start() override;
     helpers::path get_outfile() const override;
+protected:
+    bool is_linking() const override {
+        return true;
+    }
 };
 class Job_RunScript: public Job
 {
@@ -327,6 +379,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs, bool dry_run)
 
     RunState    run_state { opts, cross_compiling };
     JobList runner;
+    runner.set_durations_file(opts.output_dir / "job_durations.txt");
 
     struct ConvertState {
         JobList& joblist;
@@ -474,6 +527,8 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs, bool dry_run)
             job->m_dependencies.push_back(bs_job_name);
             is_dirty = true;
         }
+        // - Build script output is now available, so the command line is known
+        is_dirty = is_dirty || job->command_changed();
         // Check dependencies
         p.iter_main_dependencies([&](const PackageRef& dep) {
             if( !dep.is_disabled() )
@@ -498,7 +553,7 @@ bool BuildList::build(BuildOptions opts, unsigned num_jobs, bool dry_run)
         const bool is_host = !cross_compiling;
         auto job = ::std::make_unique<Job_BuildTarget>(run_state, m_root_manifest, target, is_host);
         auto output_ts = Timestamp::for_file(job->get_outfile());
-        bool is_dirty = run_state.outfile_needs_rebuild(job->get_outfile());
+        bool is_dirty = run_state.outfile_needs_rebuild(job->get_outfile()) || job->command_changed();
         if( m_root_manifest.has_library() ) {
             auto k = run_state.get_key(m_root_manifest, false, is_host);
             is_dirty |= convert_state.handle_dep(job->m_dependencies, output_ts, k);
@@ -735,6 +790,48 @@ bool RunState::outfile_needs_rebuild(const helpers::path& outfile) const
     }
 }
 
+uint64_t RunState::get_compiler_hash() const
+{
+    if( getenv("MINICARGO_IGNTOOLS") ) {
+        return 0;
+    }
+    if( m_compiler_hash == 0 ) {
+        m_compiler_hash = Fingerprint_HashFile(m_compiler_path);
+    }
+    return m_compiler_hash;
+}
+uint64_t RunState::get_profile_hash() const
+{
+    if( !m_opts.profile_use_dir.is_valid() || is_rustc() || m_opts.emit_mmir ) {
+        return 0;
+    }
+    // NOTE: Only calculated once, as the profiles don't change during a build (training happens before this build starts)
+    if( m_profile_hash == 0 ) {
+        m_profile_hash = Fingerprint_HashDirectory(m_opts.profile_use_dir, ".gcda");
+    }
+    return m_profile_hash;
+}
+uint64_t RunState::get_input_hash(const helpers::path& path, bool is_linking) const
+{
+    uint64_t    interface_hash;
+    if( Fingerprint_GetInterfaceHash(path + ".hir", interface_hash) )
+    {
+        // An upstream crate, the compiler only sees the metadata (and the file itself, which is the executable for
+        // proc macros) - but a linked output also needs the object code.
+        ContentHash h;
+        h.add(interface_hash);
+        h.add(Fingerprint_HashFile(path));
+        if( is_linking ) {
+            h.add(Fingerprint_HashFile(path + ".o"));
+        }
+        return h.get();
+    }
+    else
+    {
+        return Fingerprint_HashFile(path);
+    }
+}
+
 ::std::string RunState::get_build_script_out(const PackageManifest& manifest) const
 {
     return std::string("build_") + manifest.name().c_str() + (manifest.version() == PackageVersion() ? "" : get_crate_suffix(manifest).c_str());
@@ -801,14 +898,90 @@ bool RunState::outfile_needs_rebuild(const helpers::path& outfile) const
 }
 
 
+const char* Job_Build::skip_reason()
+{
+    auto outfile = get_outfile();
+    Fingerprint fp;
+    if( !fp.load(Fingerprint::path_for(outfile)) ) {
+        return nullptr;
+    }
+    if( Timestamp::for_file(outfile) == Timestamp::infinite_past() ) {
+        return nullptr;
+    }
+    if( fp.command_hash != get_command_hash() ) {
+        DEBUG("Building " << outfile << " - Command changed");
+        return nullptr;
+    }
+    for(const auto& i : fp.inputs)
+    {
+        if( parent.get_input_hash(i.first, is_linking()) != i.second ) {
+            DEBUG("Building " << outfile << " - " << i.first << " changed");
+            return nullptr;
+        }
+    }
+    DEBUG("Not building " << outfile << " - Inputs unchanged");
+    // Update the timestamp, so it's not checked again next time
+    Timestamp::touch_file(outfile);
+    return "FRESH";
+}
 bool Job_Build::complete(bool was_success)
 {
+    auto outfile = get_outfile();
     if(!was_success) {
         // On failure, remove the output (to force a rebuild next time)
-        remove(get_outfile().str().c_str());
+        remove(outfile.str().c_str());
+        remove(Fingerprint::path_for(outfile).str().c_str());
+    }
+    else if( !parent.is_rustc() ) {
+        save_fingerprint();
     }
     return true;
 }
+void Job_Build::save_fingerprint()
+{
+    auto outfile = get_outfile();
+    auto depfile_ents = load_depfile(outfile + ".d");
+    auto it = depfile_ents.find(outfile);
+    if( it != depfile_ents.end() && !it->second.empty() )
+    {
+        Fingerprint fp;
+        fp.command_hash = get_command_hash();
+        for(const auto& f : it->second)
+        {
+            fp.inputs.push_back(::std::make_pair( f.str(), parent.get_input_hash(f, is_linking()) ));
+        }
+        fp.save(Fingerprint::path_for(outfile));
+    }
+}
+bool Job_Build::command_changed()
+{
+    Fingerprint fp;
+    if( !fp.load(Fingerprint::path_for(get_outfile())) ) {
+        return false;
+    }
+    if( fp.command_hash != get_command_hash() ) {
+        DEBUG("Building " << get_outfile() << " - Command changed");
+        return true;
+    }
+    return false;
+}
+uint64_t Job_Build::get_command_hash()
+{
+    auto rjob = this->start();
+    ContentHash h;
+    h.add(parent.get_compiler_hash());
+    if( auto profile_hash = parent.get_profile_hash() ) {
+        h.add(profile_hash);
+    }
+    for(const auto& a : rjob.args.get_vec()) {
+        h.add(a);
+    }
+    for(auto kv : rjob.env) {
+        h.add(kv.first);
+        h.add(kv.second);
+    }
+    return h.get();
+}
 void Job_Build::push_args_common(StringList& args, const helpers::path& outfile, bool is_for_host) const
 {
     args.push_back("-o"); args.push_back(outfile);
@@ -827,8 +1000,19 @@ void Job_Build::push_args_common(StringList& args, const helpers::path& outfile,
     if( true /*parent.m_opts.enable_optimise*/ ) {
         args.push_back("-O");
     }
+    if( parent.m_opts.enable_lto && !parent.is_rustc() && !parent.m_opts.emit_mmir ) {
+        args.push_back("-C"); args.push_back("lto");
+    }
+    if( !parent.is_rustc() && !parent.m_opts.emit_mmir ) {
+        if( parent.m_opts.profile_generate_dir.is_valid() ) {
+            args.push_back("-C"); args.push_back(format("profile-generate=", parent.m_opts.profile_generate_dir));
+        }
+        else if( parent.m_opts.profile_use_dir.is_valid() ) {
+            args.push_back("-C"); args.push_back(format("profile-use=", parent.m_opts.profile_use_dir));
+        }
+    }
     if( parent.m_opts.emit_mmir ) {
-        args.push_back("-C"); args.push_back("codegen-type=monomir");
+        args.push_back("-C"); args.push_back(parent.m_opts.emit_mmir_binary ? "codegen-type=monomir-bin" : "codegen-type=monomir");
     }
 
     for(const auto& d : parent.m_opts.lib_search_dirs)
@@ -872,6 +1056,142 @@ helpers::path Job_BuildTarget::get_outfile() const
 {
     return parent.get_crate_path(m_manifest, m_target, m_is_for_host, nullptr, nullptr);
 }
+bool Job_BuildTarget::is_linking() const
+{
+    const char* crate_type;
+    parent.get_crate_path(m_manifest, m_target, m_is_for_host, &crate_type, nullptr);
+    return strcmp(crate_type, "rlib") != 0;
+}
+
+namespace {
+    /// Files generated alongside the main output that are stored in the cache
+    const ::std::vector<const char*> CACHED_OUTPUT_SUFFIXES = { ".hir", ".o" };
+}
+const char* Job_BuildTarget::skip_reason()
+{
+    if( const auto* rv = Job_Build::skip_reason() ) {
+        return rv;
+    }
+    if( !parent.m_cache ) {
+        return nullptr;
+    }
+    auto key = get_cache_key();
+    ::std::vector<::std::string>    inputs;
+    if( !parent.m_cache->get_inputs(key, inputs) ) {
+        return nullptr;
+    }
+    auto outfile = get_outfile();
+    if( !parent.m_cache->restore(key, get_cache_inputs_hash(inputs), outfile, CACHED_OUTPUT_SUFFIXES) ) {
+        return nullptr;
+    }
+    // Re-create the depfile and fingerprint, as if this had just been built
+    {
+        ::std::ofstream os( (outfile + ".d").str() );
+        os << outfile.str() << ":";
+        for(const auto& i : inputs) {
+            os << " " << denormalise_path(i);
+        }
+        os << ::std::endl;
+    }
+    save_fingerprint();
+    return "CACHED";
+}
+bool Job_BuildTarget::complete(bool was_success)
+{
+    auto rv = Job_Build::complete(was_success);
+    if( was_success && parent.m_cache )
+    {
+        auto outfile = get_outfile();
+        auto depfile_ents = load_depfile(outfile + ".d");
+        auto it = depfile_ents.find(outfile);
+        if( it != depfile_ents.end() && !it->second.empty() )
+        {
+            ::std::vector<::std::string>    inputs;
+            for(const auto& f : it->second) {
+                inputs.push_back(normalise_path(f.str()));
+            }
+            parent.m_cache->store(get_cache_key(), get_cache_inputs_hash(inputs), inputs, outfile, CACHED_OUTPUT_SUFFIXES);
+        }
+    }
+    return rv;
+}
+uint64_t Job_BuildTarget::get_cache_key()
+{
+    auto rjob = this->start();
+    ContentHash h;
+    h.add(parent.get_compiler_hash());
+    if( auto profile_hash = parent.get_profile_hash() ) {
+        h.add(profile_hash);
+    }
+    h.add(m_manifest.name().c_str());
+    h.add(::format(m_manifest.version()).c_str());
+    // NOTE: The arguments include the crate type, features, and target
+    for(const auto& a : rjob.args.get_vec()) {
+        h.add(normalise_path(a).c_str());
+    }
+    for(auto kv : rjob.env) {
+        h.add(kv.first);
+        h.add(normalise_path(kv.second).c_str());
+    }
+    return h.get();
+}
+uint64_t Job_BuildTarget::get_cache_inputs_hash(const ::std::vector<::std::string>& inputs) const
+{
+    ContentHash h;
+    for(const auto& i : inputs) {
+        h.add(i.c_str());
+        h.add(parent.get_input_hash(::helpers::path(denormalise_path(i)), is_linking()));
+    }
+    return h.get();
+}
+::std::vector< ::std::pair<::std::string, const char*> > Job_BuildTarget::get_path_replacements() const
+{
+    ::std::vector< ::std::pair<::std::string, const char*> >  rv;
+    auto add = [&](const helpers::path& p, const char* placeholder) {
+        if( p.is_valid() && p.str() != "" ) {
+            rv.push_back(::std::make_pair(p.str(), placeholder));
+            rv.push_back(::std::make_pair(p.to_absolute().str(), placeholder));
+        }
+        };
+    add(m_manifest.directory(), "$SRC");
+    add(parent.get_output_dir(true), "$HOST_OUT");
+    add(parent.get_output_dir(false), "$OUT");
+    // Longest first, so a directory nested within another is replaced correctly
+    ::std::stable_sort(rv.begin(), rv.end(), [](const auto& a, const auto& b){ return a.first.size() > b.first.size(); });
+    return rv;
+}
+::std::string Job_BuildTarget::normalise_path(::std::string s) const
+{
+    for(const auto& r : get_path_replacements())
+    {
+        // Only replace whole path components, at the start of the string or after a `=` (e.g. `--extern foo=<path>`)
+        size_t pos = 0;
+        while( (pos = s.find(r.first, pos)) != ::std::string::npos )
+        {
+            auto end = pos + r.first.size();
+            if( (pos == 0 || s[pos-1] == '=') && (end == s.size() || s[end] == '/' || s[end] == '\\') ) {
+                s.replace(pos, r.first.size(), r.second);
+                pos += strlen(r.second);
+            }
+            else {
+                pos += 1;
+            }
+        }
+    }
+    return s;
+}
+::std::string Job_BuildTarget::denormalise_path(const ::std::string& s) const
+{
+    for(const auto& r : get_path_replacements())
+    {
+        auto len = strlen(r.second);
+        if( s.compare(0, len, r.second) == 0 && (s.size() == len || s[len] == '/' || s[len] == '\\') ) {
+            // NOTE: The first (longest) entry for each placeholder is used, which is the absolute path
+            return r.first + s.substr(len);
+        }
+    }
+    return s;
+}
 RunnableJob Job_BuildTarget::start()
 {
     const char* crate_type;
@@ -19,8 +19,17 @@ struct BuildOptions
     ::helpers::path output_dir;
     ::helpers::path build_script_overrides;
     ::std::vector<::helpers::path>  lib_search_dirs;
+    /// Shared cache of build outputs (if valid)
+    ::helpers::path cache_dir;
     bool emit_mmir = false;
+    bool emit_mmir_binary = false;
     bool enable_debug = false;
+    /// Build all crates with `-C lto` (whole-program optimisation when linking executables)
+    bool enable_lto = false;
+    /// Build an instrumented program, writing profiles to this directory (`-C profile-generate`)
+    ::helpers::path profile_generate_dir;
+    /// Optimise using the profiles in this directory (`-C profile-use`)
+    ::helpers::path profile_use_dir;
     const char* target_name = nullptr;  // if null, host is used
     enum class Mode {
         /// Build the binary/library
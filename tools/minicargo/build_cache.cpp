@@ -0,0 +1,185 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * build_cache.cpp
+ * - Content-addressed cache of build outputs, shared between runs/checkouts (`--cache-dir`)
+ */
+#include "build_cache.h"
+#include "debug.h"
+#include "os.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#ifdef _WIN32
+# include <Windows.h>
+#else
+# include <unistd.h>
+# include <sys/stat.h>
+#endif
+
+namespace {
+    ::std::string hex(uint64_t v)
+    {
+        ::std::ostringstream    ss;
+        ss << ::std::hex << ::std::setw(16) << ::std::setfill('0') << v;
+        return ss.str();
+    }
+    bool file_exists(const ::helpers::path& p)
+    {
+        return ::std::ifstream(p.str()).good();
+    }
+    bool copy_file(const ::helpers::path& src, const ::helpers::path& dst)
+    {
+        ::std::ifstream is(src.str(), ::std::ios_base::in | ::std::ios_base::binary);
+        if( !is.good() )
+            return false;
+        ::std::ofstream os(dst.str(), ::std::ios_base::out | ::std::ios_base::binary);
+        // NOTE: Not using `os << is.rdbuf()`, as that fails on empty files (e.g. the `.rlib` marker)
+        char    buf[64*1024];
+        do {
+            is.read(buf, sizeof(buf));
+            os.write(buf, is.gcount());
+        } while( is.good() );
+        os.close();
+        if( !os.good() )
+            return false;
+#ifndef _WIN32
+        // Keep the permissions (executables - e.g. proc macros - have to stay executable)
+        struct stat st;
+        if( stat(src.str().c_str(), &st) != 0 || chmod(dst.str().c_str(), st.st_mode & 07777) != 0 )
+            return false;
+#endif
+        return true;
+    }
+    void remove_dir(const ::helpers::path& p)
+    {
+#ifdef _WIN32
+        RemoveDirectoryA(p.str().c_str());
+#else
+        rmdir(p.str().c_str());
+#endif
+    }
+    /// Rename `src` to `dst`, replacing `dst` if it's a file
+    bool rename_replace(const ::helpers::path& src, const ::helpers::path& dst)
+    {
+#ifdef _WIN32
+        return MoveFileExA(src.str().c_str(), dst.str().c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return ::std::rename(src.str().c_str(), dst.str().c_str()) == 0;
+#endif
+    }
+}
+
+BuildCache::BuildCache(::helpers::path dir):
+    m_dir(::std::move(dir))
+{
+    os_support::mkdir(m_dir);
+}
+
+::helpers::path BuildCache::get_temp_path() const
+{
+    static unsigned s_counter = 0;
+#ifdef _WIN32
+    auto pid = GetCurrentProcessId();
+#else
+    auto pid = getpid();
+#endif
+    ::std::ostringstream    ss;
+    ss << "tmp-" << pid << "-" << s_counter++;
+    return m_dir / ss.str().c_str();
+}
+
+bool BuildCache::get_inputs(uint64_t key, ::std::vector<::std::string>& out_inputs) const
+{
+    ::std::ifstream is( (m_dir / hex(key).c_str() / "inputs").str() );
+    if( !is.good() )
+        return false;
+    out_inputs.clear();
+    ::std::string   line;
+    while( ::std::getline(is, line) )
+    {
+        out_inputs.push_back(line);
+    }
+    return true;
+}
+
+bool BuildCache::restore(uint64_t key, uint64_t inputs_hash, const ::helpers::path& outfile, const ::std::vector<const char*>& suffixes) const
+{
+    auto entry_dir = m_dir / hex(key).c_str() / hex(inputs_hash).c_str();
+    if( !file_exists(entry_dir / "out") ) {
+        DEBUG("Cache miss for " << outfile << " (" << entry_dir << ")");
+        return false;
+    }
+    DEBUG("Cache hit for " << outfile << " (" << entry_dir << ")");
+    os_support::mkdir(outfile.parent());
+
+    // Copy to a temporary name then rename, so an interrupted copy doesn't leave a truncated output
+    auto restore_one = [&](const char* suffix) {
+        auto src = entry_dir / (::std::string("out") + suffix).c_str();
+        if( !file_exists(src) )
+            return true;
+        auto dst = outfile + suffix;
+        auto tmp = dst + ".tmp";
+        if( !copy_file(src, tmp) || !rename_replace(tmp, dst) ) {
+            ::std::remove(tmp.str().c_str());
+            return false;
+        }
+        return true;
+        };
+    for(const auto* s : suffixes)
+    {
+        if( !restore_one(s) )
+            return false;
+    }
+    // The main output is restored last, so an interrupted restore is seen as a missing output
+    return restore_one("");
+}
+
+void BuildCache::store(uint64_t key, uint64_t inputs_hash, const ::std::vector<::std::string>& inputs, const ::helpers::path& outfile, const ::std::vector<const char*>& suffixes) const
+{
+    auto key_dir = m_dir / hex(key).c_str();
+    auto entry_dir = key_dir / hex(inputs_hash).c_str();
+    if( file_exists(entry_dir / "out") ) {
+        return ;
+    }
+    os_support::mkdir(key_dir);
+
+    // Populate a temporary directory, then move it into place
+    auto tmp_dir = get_temp_path();
+    os_support::mkdir(tmp_dir);
+    ::std::vector<::helpers::path>  tmp_files;
+    bool ok = true;
+    auto add_one = [&](const char* suffix) {
+        auto src = outfile + suffix;
+        if( !file_exists(src) )
+            return ;
+        auto dst = tmp_dir / (::std::string("out") + suffix).c_str();
+        ok &= copy_file(src, dst);
+        tmp_files.push_back(dst);
+        };
+    add_one("");
+    for(const auto* s : suffixes)
+        add_one(s);
+    if( ok && rename_replace(tmp_dir, entry_dir) ) {
+        tmp_files.clear();
+    }
+    else {
+        // Either the copy failed, or another process stored the same entry first
+        for(const auto& f : tmp_files)
+            ::std::remove(f.str().c_str());
+        remove_dir(tmp_dir);
+    }
+
+    // Record the inputs to be checked for this key
+    auto tmp_inputs = get_temp_path();
+    {
+        ::std::ofstream os(tmp_inputs.str());
+        for(const auto& i : inputs)
+            os << i << "\n";
+    }
+    if( !rename_replace(tmp_inputs, key_dir / "inputs") ) {
+        ::std::remove(tmp_inputs.str().c_str());
+    }
+}
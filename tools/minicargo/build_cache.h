@@ -0,0 +1,36 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * build_cache.h
+ * - Content-addressed cache of build outputs, shared between runs/checkouts (`--cache-dir`)
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <path.h>
+
+/// Layout of the cache directory:
+/// - `<key>/inputs` - The (checkout-independent) input paths recorded by the most recent store with this key
+/// - `<key>/<inputs_hash>/` - The output files from a build where the above inputs hashed to `inputs_hash`
+///
+/// Both are written under a temporary name and then renamed into place, so concurrent minicargo processes never see a
+/// partially written entry (and if two processes store the same entry, one of them just discards its copy).
+class BuildCache
+{
+    ::helpers::path m_dir;
+public:
+    BuildCache(::helpers::path dir);
+
+    /// Get the inputs recorded for `key`, returns false if there's no entry for this key
+    bool get_inputs(uint64_t key, ::std::vector<::std::string>& out_inputs) const;
+    /// Copy a cached entry to `outfile` (and `outfile`+suffix for each suffix), returns false if there's no such entry
+    bool restore(uint64_t key, uint64_t inputs_hash, const ::helpers::path& outfile, const ::std::vector<const char*>& suffixes) const;
+    /// Add the outputs of a build to the cache (`outfile` and any of `outfile`+suffix that exist)
+    void store(uint64_t key, uint64_t inputs_hash, const ::std::vector<::std::string>& inputs, const ::helpers::path& outfile, const ::std::vector<const char*>& suffixes) const;
+
+private:
+    ::helpers::path get_temp_path() const;
+};
@@ -5,6 +5,7 @@
 # include <Windows.h>
 #else
 # include <sys/stat.h>
+# include <utime.h>
 #endif
 
 Timestamp Timestamp::for_file(const ::helpers::path& path)
@@ -34,4 +35,19 @@ Timestamp Timestamp::for_file(const ::helpers::path& path)
         return Timestamp::infinite_past();
     }
 #endif
-}
\ No newline at end of file
+}
+void Timestamp::touch_file(const ::helpers::path& path)
+{
+#if _WIN32
+    auto handle = CreateFile(path.str().c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+    if(handle == INVALID_HANDLE_VALUE) {
+        return ;
+    }
+    FILETIME    now;
+    GetSystemTimeAsFileTime(&now);
+    SetFileTime(handle, NULL, NULL, &now);
+    CloseHandle(handle);
+#else
+    utime(path.str().c_str(), nullptr);
+#endif
+}
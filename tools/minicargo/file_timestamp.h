@@ -21,6 +21,8 @@ class Timestamp
 
 public:
     static Timestamp for_file(const ::helpers::path& p);
+    /// Set the modification time of a file to the current time
+    static void touch_file(const ::helpers::path& p);
     static Timestamp infinite_past() {
         return Timestamp { 0 };
     }
@@ -0,0 +1,189 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * fingerprint.cpp
+ * - Content hashes of build inputs, used to skip builds when nothing they depend on has changed
+ */
+#include "fingerprint.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>   // remove
+#include <algorithm>
+#if _WIN32
+# include <Windows.h>
+#else
+# include <dirent.h>
+# include <sys/stat.h>
+#endif
+
+namespace {
+    /// Marks the end of a mrustc metadata file (see `src/hir/serialise_lowlevel.hpp`)
+    const uint64_t HIR_BLOCK_INDEX_MAGIC = 0x3258444948524d00;   // "\0MRHIDX2"
+}
+
+void ContentHash::add(const void* data, size_t len)
+{
+    const auto* p = static_cast<const uint8_t*>(data);
+    for(size_t i = 0; i < len; i ++)
+    {
+        m_val ^= p[i];
+        m_val *= 0x100000001b3;
+    }
+}
+void ContentHash::add(uint64_t v)
+{
+    uint8_t buf[8];
+    for(int i = 0; i < 8; i ++)
+        buf[i] = static_cast<uint8_t>(v >> (8*i));
+    add(buf, sizeof(buf));
+}
+void ContentHash::add(const char* s)
+{
+    add(s, strlen(s) + 1);
+}
+
+uint64_t Fingerprint_HashFile(const ::helpers::path& path)
+{
+    ::std::ifstream is(path.str(), ::std::ios_base::in | ::std::ios_base::binary);
+    if( !is.good() )
+        return 0;
+    ContentHash h;
+    char    buf[64*1024];
+    do {
+        is.read(buf, sizeof(buf));
+        h.add(buf, static_cast<size_t>(is.gcount()));
+    } while( is.good() );
+    return h.get();
+}
+
+namespace {
+    /// Call `cb(rel_path, path)` on each file with the given suffix in a directory (and its subdirectories), in sorted order
+    template<typename Cb>
+    void visit_directory(const ::helpers::path& dir, const ::std::string& rel_dir, const char* suffix, Cb& cb)
+    {
+        // Sorted, so the hash doesn't depend on the order the OS lists the entries in
+        ::std::vector< ::std::pair<::std::string, bool> >   ents;
+        #if _WIN32
+        WIN32_FIND_DATA find_data;
+        HANDLE find_handle = FindFirstFile( (dir / "*").str().c_str(), &find_data );
+        if( find_handle == INVALID_HANDLE_VALUE )
+            return ;
+        do
+        {
+            ents.push_back(::std::make_pair( ::std::string(find_data.cFileName), (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 ));
+        } while( FindNextFile(find_handle, &find_data) );
+        FindClose(find_handle);
+        #else
+        auto* dp = opendir(dir.str().c_str());
+        if( dp == nullptr )
+            return ;
+        while( const auto* dent = readdir(dp) )
+        {
+            struct stat st;
+            bool is_dir = stat( (dir / dent->d_name).str().c_str(), &st ) == 0 && S_ISDIR(st.st_mode);
+            ents.push_back(::std::make_pair( ::std::string(dent->d_name), is_dir ));
+        }
+        closedir(dp);
+        #endif
+        ::std::sort(ents.begin(), ents.end());
+
+        size_t suffix_len = strlen(suffix);
+        for(const auto& e : ents)
+        {
+            if( e.first == "." || e.first == ".." )
+                continue ;
+            auto rel = rel_dir + "/" + e.first;
+            if( e.second ) {
+                visit_directory(dir / e.first.c_str(), rel, suffix, cb);
+            }
+            else if( e.first.size() >= suffix_len && e.first.compare(e.first.size() - suffix_len, suffix_len, suffix) == 0 ) {
+                cb(rel, dir / e.first.c_str());
+            }
+        }
+    }
+}
+uint64_t Fingerprint_HashDirectory(const ::helpers::path& dir, const char* suffix)
+{
+    ContentHash h;
+    auto cb = [&](const ::std::string& rel, const ::helpers::path& path) {
+        h.add(rel.c_str());
+        h.add(Fingerprint_HashFile(path));
+        };
+    visit_directory(dir, "", suffix, cb);
+    return h.get();
+}
+void Fingerprint_RemoveFiles(const ::helpers::path& dir, const char* suffix)
+{
+    auto cb = [](const ::std::string& , const ::helpers::path& path) {
+        remove(path.str().c_str());
+        };
+    visit_directory(dir, "", suffix, cb);
+}
+
+bool Fingerprint_GetInterfaceHash(const ::helpers::path& hir_path, uint64_t& out_hash)
+{
+    // Trailer: `u64 interface_hash`, `u64 block_count`, `u64 magic` (all little-endian)
+    ::std::ifstream is(hir_path.str(), ::std::ios_base::in | ::std::ios_base::binary);
+    if( !is.good() )
+        return false;
+    is.seekg(0, ::std::ios_base::end);
+    if( static_cast<long long>(is.tellg()) < 3*8 )
+        return false;
+    is.seekg(-3*8, ::std::ios_base::end);
+    uint8_t buf[3*8];
+    is.read(reinterpret_cast<char*>(buf), sizeof(buf));
+    if( is.gcount() != sizeof(buf) )
+        return false;
+    auto get_u64 = [&](size_t ofs) {
+        uint64_t rv = 0;
+        for(int i = 0; i < 8; i ++)
+            rv |= static_cast<uint64_t>(buf[ofs+i]) << (8*i);
+        return rv;
+        };
+    if( get_u64(16) != HIR_BLOCK_INDEX_MAGIC )
+        return false;
+    out_hash = get_u64(0);
+    return true;
+}
+
+bool Fingerprint::load(const ::helpers::path& path)
+{
+    ::std::ifstream is(path.str());
+    if( !is.good() )
+        return false;
+    ::std::string   line;
+    if( !::std::getline(is, line) )
+        return false;
+    {
+        ::std::istringstream    ss(line);
+        ::std::string   tag;
+        ss >> tag >> ::std::hex >> this->command_hash;
+        if( tag != "command" || ss.fail() )
+            return false;
+    }
+    this->inputs.clear();
+    // Each input is `<hash> <path>` (the path is the rest of the line, so can contain spaces)
+    while( ::std::getline(is, line) )
+    {
+        auto sp = line.find(' ');
+        if( sp == ::std::string::npos )
+            return false;
+        uint64_t    hash;
+        ::std::istringstream(line.substr(0, sp)) >> ::std::hex >> hash;
+        this->inputs.push_back(::std::make_pair( line.substr(sp+1), hash ));
+    }
+    return true;
+}
+void Fingerprint::save(const ::helpers::path& path) const
+{
+    ::std::ofstream os(path.str());
+    os << ::std::hex;
+    os << "command " << this->command_hash << "\n";
+    for(const auto& i : this->inputs)
+    {
+        os << i.second << " " << i.first << "\n";
+    }
+}
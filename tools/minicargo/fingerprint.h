@@ -0,0 +1,60 @@
+/*
+ * minicargo - MRustC-specific clone of `cargo`
+ * - By John Hodge (Mutabah)
+ *
+ * fingerprint.h
+ * - Content hashes of build inputs, used to skip builds when nothing they depend on has changed
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <path.h>
+
+/// 64-bit FNV-1a hash (the same as is used by mrustc for the metadata interface hash)
+class ContentHash
+{
+    uint64_t    m_val;
+public:
+    ContentHash():
+        m_val(0xcbf29ce484222325)
+    {
+    }
+
+    void add(const void* data, size_t len);
+    void add(uint64_t v);
+    // NOTE: Includes the terminator, so adjacent strings can't alias
+    void add(const char* s);
+
+    uint64_t get() const {
+        return m_val;
+    }
+};
+
+/// Hash the contents of a file (returns zero if the file can't be opened)
+uint64_t Fingerprint_HashFile(const ::helpers::path& path);
+/// Hash the names and contents of all files with the given suffix in a directory (and its subdirectories)
+uint64_t Fingerprint_HashDirectory(const ::helpers::path& dir, const char* suffix);
+/// Delete all files with the given suffix in a directory (and its subdirectories)
+void Fingerprint_RemoveFiles(const ::helpers::path& dir, const char* suffix);
+/// Read the public interface hash from a mrustc metadata file (`<crate>.hir`)
+/// - Returns false if the file is missing or doesn't have one (e.g. it was generated by an older compiler)
+bool Fingerprint_GetInterfaceHash(const ::helpers::path& hir_path, uint64_t& out_hash);
+
+/// What an output was built from, saved next to the output on a successful build
+struct Fingerprint
+{
+    /// Hash of the compiler binary, the arguments, and the environment
+    uint64_t    command_hash = 0;
+    /// Every input file (from the depfile) and its hash at the time of the build
+    ::std::vector< ::std::pair<::std::string, uint64_t> >   inputs;
+
+    static ::helpers::path path_for(const ::helpers::path& outfile) {
+        return outfile + ".fingerprint";
+    }
+
+    /// Returns false if the file is missing or malformed
+    bool load(const ::helpers::path& path);
+    void save(const ::helpers::path& path) const;
+};
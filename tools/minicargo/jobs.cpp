@@ -20,6 +20,8 @@
 
 #include <cassert>
 #include <algorithm>
+#include <fstream>
+#include <functional>
 
 #ifdef _WIN32
 # include <Windows.h>
@@ -29,11 +31,130 @@ extern "C" {
 }
 #endif
 
+void JobList::set_durations_file(::helpers::path path)
+{
+    m_durations_file = ::std::move(path);
+}
 void JobList::add_job(::std::unique_ptr<Job> job)
 {
     waiting_jobs.push_back(std::move(job));
 }
 
+void JobList::load_durations()
+{
+    if( !m_durations_file.is_valid() )
+        return ;
+    ::std::ifstream is(m_durations_file.str());
+    ::std::string   line;
+    // Each line is `<seconds> <job name>`
+    while( ::std::getline(is, line) )
+    {
+        auto sp = line.find(' ');
+        if( sp == ::std::string::npos )
+            continue ;
+        m_durations[line.substr(sp+1)] = ::std::strtod(line.c_str(), nullptr);
+    }
+}
+void JobList::save_durations() const
+{
+    if( !m_durations_file.is_valid() || m_durations.empty() )
+        return ;
+    // Sorted, so the file is stable between runs
+    ::std::vector<const ::std::pair<const ::std::string, double>*>    ents;
+    for(const auto& e : m_durations)
+        ents.push_back(&e);
+    ::std::sort(ents.begin(), ents.end(), [](const auto* a, const auto* b){ return a->first < b->first; });
+    ::std::ofstream os(m_durations_file.str());
+    os << std::fixed << std::setprecision(3);
+    for(const auto* e : ents)
+        os << e->second << " " << e->first << "\n";
+}
+void JobList::calculate_priorities()
+{
+    // Jobs that haven't been run before are assumed to take the average time
+    double default_duration = 1.0;
+    if( !m_durations.empty() )
+    {
+        double total = 0;
+        for(const auto& e : m_durations)
+            total += e.second;
+        default_duration = total / m_durations.size();
+    }
+
+    ::std::unordered_map<std::string, ::std::vector<const Job*>>  dependents;
+    for(const auto& j : this->waiting_jobs)
+    {
+        for(const auto& d : j->dependencies())
+            dependents[d].push_back(j.get());
+    }
+    // Priority is this job's duration plus the longest chain of jobs waiting on it (memoised, the graph is acyclic)
+    ::std::function<double(const Job&)> visit = [&](const Job& j)->double {
+        auto it = m_priorities.find(j.name());
+        if( it != m_priorities.end() )
+            return it->second;
+        double rv = 0;
+        auto it_d = dependents.find(j.name());
+        if( it_d != dependents.end() )
+        {
+            for(const auto* d : it_d->second)
+                rv = ::std::max(rv, visit(*d));
+        }
+        auto it_dur = m_durations.find(j.name());
+        rv += (it_dur != m_durations.end() ? it_dur->second : default_duration);
+        m_priorities[j.name()] = rv;
+        return rv;
+        };
+    for(const auto& j : this->waiting_jobs)
+        visit(*j);
+}
+void JobList::record_completion(const Job& job, double start, double duration)
+{
+    CompletedJob    ent { start, duration, "" };
+    double  latest = -1;
+    for(const auto& d : job.dependencies())
+    {
+        auto it = m_timeline.find(d);
+        if( it != m_timeline.end() && it->second.start + it->second.duration > latest ) {
+            latest = it->second.start + it->second.duration;
+            ent.critical_dep = d;
+        }
+    }
+    m_timeline[job.name()] = ::std::move(ent);
+}
+void JobList::print_critical_path() const
+{
+    // Walk back from the last job to complete, following the dependency each job was waiting on
+    const ::std::string*    cur = nullptr;
+    double  end_time = 0;
+    for(const auto& e : m_timeline)
+    {
+        if( !cur || e.second.start + e.second.duration > end_time ) {
+            cur = &e.first;
+            end_time = e.second.start + e.second.duration;
+        }
+    }
+    ::std::vector<const ::std::pair<const ::std::string, CompletedJob>*>  path;
+    while( cur && *cur != "" )
+    {
+        auto it = m_timeline.find(*cur);
+        path.push_back(&*it);
+        cur = &it->second.critical_dep;
+    }
+    double  busy = 0;
+    for(const auto* e : path)
+        busy += e->second.duration;
+    // Nothing was actually built (everything was fresh/cached)
+    if( busy == 0 )
+        return ;
+    ::std::cout << "Critical path: " << std::fixed << std::setprecision(1) << busy << "s running, "
+        << (end_time - busy) << "s waiting (" << end_time << "s total)" << ::std::endl;
+    for(auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        const auto& e = **it;
+        ::std::cout << "  @" << ::std::setw(7) << e.second.start << "s " << ::std::setw(7) << e.second.duration << "s  " << e.first << ::std::endl;
+    }
+}
+
 bool JobList::run_all(size_t num_jobs, bool dry_run)
 {
     // Sort jobs by name, to provide a consistent execution order
@@ -54,6 +175,7 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         num_jobs = 1;
     }
     const auto total_job_count = this->waiting_jobs.size();
+    m_start_time = clock_t::now();
 
     bool failed = false;
     /// Number of jobserver tokens taken
@@ -116,6 +238,8 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         this->waiting_jobs.erase(new_end, this->waiting_jobs.end());
     }
     #endif
+    load_durations();
+    calculate_priorities();
 
     while( !this->waiting_jobs.empty() || !this->runnable_jobs.empty() || !this->running_jobs.empty() )
     {
@@ -162,10 +286,27 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         auto new_end = std::remove_if(waiting_jobs.begin(), waiting_jobs.end(), [](const job_t& j){ return !j; });
         waiting_jobs.erase(new_end, waiting_jobs.end());
 
-        ::std::sort(runnable_jobs.begin(), runnable_jobs.end(), [](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+        // Start the jobs with the longest chain of work after them first (ties broken by name, for stable output)
+        ::std::sort(runnable_jobs.begin(), runnable_jobs.end(), [&](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+            auto pa = m_priorities.at(a->name());
+            auto pb = m_priorities.at(b->name());
+            if( pa != pb )
+                return pa > pb;
             return a->name() < b->name();
         });
 
+        // Skip jobs that don't need running after all (e.g. a dependency was rebuilt but its interface didn't change)
+        const char* skip_reason;
+        if( !dry_run && !this->runnable_jobs.empty() && (skip_reason = this->runnable_jobs.front()->skip_reason()) )
+        {
+            auto job = ::std::move(this->runnable_jobs.front());
+            this->runnable_jobs.pop_front();
+            ::std::cout << "--- " << skip_reason << " " << job->name() << std::endl;
+            record_completion(*job, elapsed(clock_t::now()), 0);
+            this->completed_jobs.insert(job->name());
+            continue ;
+        }
+
         // Is nothing runnable?
         if( this->runnable_jobs.empty() ) {
             // Is nothing running?
@@ -231,7 +372,7 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         }
 
         auto handle = this->spawn(rjob);
-        this->running_jobs.push_back(RunningJob { handle, std::move(job), std::move(rjob) });
+        this->running_jobs.push_back(RunningJob { handle, std::move(job), std::move(rjob), clock_t::now() });
         dump_state();
     }
     while( !this->running_jobs.empty() )
@@ -239,6 +380,12 @@ bool JobList::run_all(size_t num_jobs, bool dry_run)
         failed |= !wait_one();
         dump_state();
     }
+    if( !dry_run )
+    {
+        save_durations();
+        if( !failed )
+            print_critical_path();
+    }
     // Release jobserver tokens
     if(jobserver) {
         while( n_tokens > 0 && 1+n_tokens > this->running_jobs.size()) {
@@ -331,6 +478,10 @@ bool JobList::wait_one(bool block)
     {
         ::std::cout << "Completed " << rjob.job->name() << std::endl;
         this->completed_jobs.insert(rjob.job->name());
+        auto now = clock_t::now();
+        double duration = ::std::chrono::duration<double>(now - rjob.start_time).count();
+        m_durations[rjob.job->name()] = duration;
+        record_completion(*rjob.job, elapsed(rjob.start_time), duration);
     }
     rv &= rjob.job->complete(rv);
     if(getenv("MINICARGO_RUN_ONCE") || getenv("MINICARGO_RUNONCE"))
@@ -6,6 +6,8 @@
 #include <vector>
 #include <deque>
 #include <unordered_set>
+#include <unordered_map>
+#include <chrono>
 #include "stringlist.h"
 #include <path.h>
 #include "os.hpp"
@@ -41,30 +43,63 @@ public:
     virtual const std::string& name() const = 0;
     virtual const std::vector<std::string>& dependencies() const = 0;
     virtual bool is_runnable() const = 0;
+    // Checked just before starting (once all dependencies are complete), allows skipping a job if it turns out that
+    // nothing it depends on has changed (or the output could be obtained some other way). Returns the verb to print.
+    virtual const char* skip_reason() { return nullptr; }
     virtual RunnableJob start() = 0;
     virtual bool complete(bool was_successful) = 0;
 };
 class JobList
 {
     typedef std::unique_ptr<Job>    job_t;
+    typedef ::std::chrono::steady_clock clock_t;
     struct RunningJob {
         os_support::Process handle;
         job_t   job;
         RunnableJob desc;
+        clock_t::time_point start_time;
         RunningJob(RunningJob&& ) = default;
         RunningJob& operator=(RunningJob&& ) = default;
     };
+    /// Timing of a job completed in this run (for the critical path report)
+    struct CompletedJob {
+        double  start;
+        double  duration;
+        /// The dependency that completed last (i.e. the one this job was waiting on)
+        ::std::string   critical_dep;
+    };
 
     ::std::vector<job_t>    waiting_jobs;
     ::std::deque<job_t>    runnable_jobs;
     ::std::vector<RunningJob>   running_jobs;
     ::std::unordered_set<std::string>  completed_jobs;
+
+    /// File that job durations are saved to (and loaded from)
+    ::helpers::path m_durations_file;
+    /// Duration (in seconds) of each job when last run
+    ::std::unordered_map<std::string, double>   m_durations;
+    /// Estimated time from starting a job until all jobs that depend on it are complete, used to run jobs on the
+    /// critical path first
+    ::std::unordered_map<std::string, double>   m_priorities;
+    clock_t::time_point m_start_time;
+    ::std::unordered_map<std::string, CompletedJob> m_timeline;
 public:
     JobList() {}
+    /// Load the durations of jobs from a previous build from this file, and save them back after running
+    void set_durations_file(::helpers::path path);
     void add_job(::std::unique_ptr<Job> job);
     bool run_all(size_t num_jobs, bool dry_run);
 
 private:
+    void load_durations();
+    void save_durations() const;
+    void calculate_priorities();
+    void record_completion(const Job& job, double start, double duration);
+    void print_critical_path() const;
+    double elapsed(clock_t::time_point t) const {
+        return ::std::chrono::duration<double>(t - m_start_time).count();
+    }
+
     os_support::Process spawn(const RunnableJob& j);
     bool wait_one(bool block=true);
 };
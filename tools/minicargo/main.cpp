@@ -15,6 +15,7 @@
 #include <helpers.h>
 #include "repository.h"
 #include "build.h"
+#include "fingerprint.h"    // Fingerprint_RemoveFiles
 #include <toml.h>   // TomlFile (workspace)
 #include <fstream>  // for workspace enumeration
 #include "cfg.hpp"
@@ -36,8 +37,13 @@ struct ProgramOptions
     // Output/build directory
     const char* output_directory = nullptr;
 
+    // Directory for the shared output cache
+    const char* cache_directory = nullptr;
+
     // Emit Monomorphised MIR instead of C
     bool emit_mmir = false;
+    // Use the binary encoding of monomorphised MIR
+    bool emit_mmir_binary = false;
 
     // Target name (if null, defaults to host)
     const char* target = nullptr;
@@ -58,6 +64,15 @@ struct ProgramOptions
 
     /// Enable debug output (`-g` passed)
     bool enable_debug = false;
+    /// Enable link-time optimisation (`-C lto` passed)
+    bool enable_lto = false;
+
+    /// Directory to write profiles to from an instrumented build (`-C profile-generate` passed)
+    const char* profile_generate_dir = nullptr;
+    /// Directory to read profiles from (`-C profile-use` passed)
+    const char* profile_use_dir = nullptr;
+    /// Command run on an instrumented build to populate `profile_use_dir` before the optimised build
+    const char* profile_train_command = nullptr;
 
     bool no_default_features = false;
     ::std::vector<::std::string>    features;
@@ -317,9 +332,18 @@ int main(int argc, const char* argv[])
         BuildOptions    build_opts;
         build_opts.build_script_overrides = ::std::move(bs_override_dir);
         build_opts.output_dir = opts.output_directory ? ::helpers::path(opts.output_directory) : ::helpers::path("output");
+        if( opts.cache_directory ) {
+            build_opts.cache_dir = ::helpers::path(opts.cache_directory);
+        }
         build_opts.lib_search_dirs.reserve(opts.lib_search_dirs.size());
         build_opts.emit_mmir = opts.emit_mmir;
+        build_opts.emit_mmir_binary = opts.emit_mmir_binary;
         build_opts.enable_debug = opts.enable_debug;
+        build_opts.enable_lto = opts.enable_lto;
+        if( opts.profile_generate_dir )
+            build_opts.profile_generate_dir = ::helpers::path(opts.profile_generate_dir).to_absolute();
+        if( opts.profile_use_dir )
+            build_opts.profile_use_dir = ::helpers::path(opts.profile_use_dir).to_absolute();
         build_opts.target_name = opts.target;
         for(const auto* d : opts.lib_search_dirs)
             build_opts.lib_search_dirs.push_back( ::helpers::path(d) );
@@ -328,10 +352,42 @@ int main(int argc, const char* argv[])
             opts.test ? BuildOptions::Mode::Test :
             BuildOptions::Mode::Normal
             ;
-        Debug_SetPhase("Enumerate Build");
-        auto build_list = BuildList(m, build_opts);
-        Debug_SetPhase("Run Build");
-        if( !build_list.build(::std::move(build_opts), opts.build_jobs, opts.dry_run) )
+        bool ok = true;
+        // Profile training: Build an instrumented program (into the same output directory), and run the training
+        // workload on it to generate the profiles used by the real build
+        if( opts.profile_train_command )
+        {
+            auto train_opts = build_opts;
+            train_opts.profile_generate_dir = ::std::move(train_opts.profile_use_dir);
+            train_opts.profile_use_dir = ::helpers::path();
+            // GCC merges new counts into existing profiles, so clear out the ones from the last training run (otherwise
+            // they accumulate, and ones from an older build of the program fail to merge)
+            if( !opts.dry_run )
+            {
+                Fingerprint_RemoveFiles(train_opts.profile_generate_dir, ".gcda");
+            }
+            Debug_SetPhase("Enumerate Build");
+            auto train_list = BuildList(m, train_opts);
+            Debug_SetPhase("Run Build");
+            ok = train_list.build(::std::move(train_opts), opts.build_jobs, opts.dry_run);
+            if( ok )
+            {
+                ::std::cout << "TRAINING: " << opts.profile_train_command << ::std::endl;
+                if( !opts.dry_run && system(opts.profile_train_command) != 0 )
+                {
+                    ::std::cerr << "Training command failed" << ::std::endl;
+                    ok = false;
+                }
+            }
+        }
+        if( ok )
+        {
+            Debug_SetPhase("Enumerate Build");
+            auto build_list = BuildList(m, build_opts);
+            Debug_SetPhase("Run Build");
+            ok = build_list.build(::std::move(build_opts), opts.build_jobs, opts.dry_run);
+        }
+        if( !ok )
         {
             ::std::cerr << "BUILD FAILED" << ::std::endl;
             if(opts.pause_before_quit) {
@@ -413,6 +469,10 @@ int ProgramOptions::parse(int argc, const char* argv[])
                 if( ::std::strcmp(arg, "emit-mmir") == 0 ) {
                     this->emit_mmir = true;
                 }
+                else if( ::std::strcmp(arg, "emit-mmir-binary") == 0 ) {
+                    this->emit_mmir = true;
+                    this->emit_mmir_binary = true;
+                }
                 else {
                     ::std::cerr << "Unknown debug option -Z " << arg << ::std::endl;
                     return 1;
@@ -471,6 +531,13 @@ int ProgramOptions::parse(int argc, const char* argv[])
                 }
                 this->output_directory = argv[++i];
             }
+            else if( ::std::strcmp(arg, "--cache-dir") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->cache_directory = argv[++i];
+            }
             else if( ::std::strcmp(arg, "--target") == 0 ) {
                 if(i+1 == argc) {
                     ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
@@ -500,6 +567,30 @@ int ProgramOptions::parse(int argc, const char* argv[])
             else if( ::std::strcmp(arg, "--test") == 0 ) {
                 this->test = true;
             }
+            else if( ::std::strcmp(arg, "--lto") == 0 ) {
+                this->enable_lto = true;
+            }
+            else if( ::std::strcmp(arg, "--profile-generate") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->profile_generate_dir = argv[++i];
+            }
+            else if( ::std::strcmp(arg, "--profile-use") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->profile_use_dir = argv[++i];
+            }
+            else if( ::std::strcmp(arg, "--profile-train") == 0 ) {
+                if(i+1 == argc) {
+                    ::std::cerr << "Flag " << arg << " takes an argument" << ::std::endl;
+                    return 1;
+                }
+                this->profile_train_command = argv[++i];
+            }
             else {
                 ::std::cerr << "Unknown flag " << arg << ::std::endl;
                 return 1;
@@ -512,6 +603,16 @@ int ProgramOptions::parse(int argc, const char* argv[])
         usage();
         exit(1);
     }
+    if( this->profile_generate_dir && this->profile_use_dir )
+    {
+        ::std::cerr << "--profile-generate and --profile-use can't be used together" << ::std::endl;
+        return 1;
+    }
+    if( this->profile_train_command && !this->profile_use_dir )
+    {
+        ::std::cerr << "--profile-train requires --profile-use" << ::std::endl;
+        return 1;
+    }
 
     return 0;
 }
@@ -534,10 +635,15 @@ void ProgramOptions::help() const
         << "--script-overrides <dir> : Directory containing <package>.txt files containing the build script output\n"
         << "--vendor-dir <dir>       : Directory containing vendored packages (from `cargo vendor`)\n"
         << "--output-dir,-o <dir>    : Specify the compiler output directory\n"
+        << "--cache-dir <dir>        : Look up and store build outputs in a cache shared with other builds\n"
         << "-L <dir>                 : Search for pre-built crates (e.g. libstd) in the specified directory\n"
         << "-j <count>               : Run at most <count> build tasks at once (default is to run only one)\n"
         << "-n                       : Don't build any packages, just list the packages that would be built\n"
         << "-g                       : Pass `-g` to compiler\n"
+        << "--lto                    : Pass `-C lto` to compiler (optimise across crates when linking)\n"
+        << "--profile-generate <dir> : Build an instrumented program that writes profiles to <dir>\n"
+        << "--profile-use <dir>      : Optimise using the profiles in <dir>\n"
+        << "--profile-train <cmd>    : Before the `--profile-use` build, do an instrumented build and run <cmd> to create the profiles\n"
         << "--no-default-features    : \n"
         << "--features <list>        : \n"
         ;
@@ -26,6 +26,8 @@ struct ProgramOptions
 
     // Output logfile
     ::std::string   logfile;
+    // Disable pre-decoding of function bodies (so every statement is logged)
+    bool    no_predecode = false;
     // Arguments for the program
     ::std::vector<const char*>  args;
 
@@ -64,6 +66,7 @@ int main(int argc, const char* argv[])
 
     // Load HIR tree
     auto tree = ModuleTree {};
+    tree.enable_predecode = !opts.no_predecode;
     try
     {
         tree.load_file(opts.infile);
@@ -205,6 +208,9 @@ int ProgramOptions::parse(int argc, const char* argv[])
                 const char* opt = argv[++argidx];
                 this->logfile = opt;
             }
+            else if( ::std::strcmp(arg, "--no-predecode") == 0 ) {
+                this->no_predecode = true;
+            }
             //else if( ::std::strcmp(arg, "--api") == 0 ) {
             //}
             else {
@@ -93,8 +93,27 @@ struct MirHelpers
     ValueRef get_value_and_type(const ::MIR::LValue& lv, ::HIR::TypeRef& ty)
     {
         auto vr = get_value_and_type_root(lv.m_root, ty);
-        for(const auto& w : lv.m_wrappers)
+        size_t  first_wrapper = 0;
+        if( !lv.m_wrappers.empty() )
         {
+            // Use the layout resolved at load time for the leading fields (if available)
+            auto it = this->frame.fcn->lvalue_layouts.find(&lv);
+            if( it != this->frame.fcn->lvalue_layouts.end() )
+            {
+                const auto& layout = it->second;
+                vr.m_offset += layout.ofs;
+                if( layout.size != SIZE_MAX )
+                {
+                    LOG_ASSERT(vr.m_size >= layout.size, "Field didn't fit in the value - " << layout.size << " required, but " << vr.m_size << " available");
+                    vr.m_size = layout.size;
+                }
+                ty = layout.ty;
+                first_wrapper = layout.n_wrappers;
+            }
+        }
+        for(size_t wrapper_idx = first_wrapper; wrapper_idx < lv.m_wrappers.size(); wrapper_idx ++)
+        {
+            const auto& w = lv.m_wrappers[wrapper_idx];
             switch(w.tag())
             {
             case ::MIR::LValue::Wrapper::TAGDEAD:    throw "";
@@ -574,11 +593,184 @@ void InterpreterThread::start(const RcString& p, ::std::vector<Value> args)
         LOG_TODO("Handle immediate return thread entry");
     }
 }
+/// Run the pre-decoded instructions (see `ModuleTree::predecode`) of `frame` from its current position
+/// - Stops at the first instruction that has no pre-decoded form (or that fails a check), leaving the frame pointing at it
+/// - Uses a threaded (computed goto) dispatch where available, with a `switch` otherwise
+void InterpreterThread::run_predecoded(StackFrame& frame)
+{
+    typedef Function::Instr Instr;
+    const auto& code = frame.fcn->code;
+    const Instr* pc = code.data() + frame.fcn->block_starts.at(frame.bb_idx) + frame.stmt_idx;
+
+    auto get_slot = [&](const Instr::Operand& o)->Value& {
+        switch(o.kind)
+        {
+        case Instr::Operand::Kind::Return:  return frame.ret;
+        case Instr::Operand::Kind::Argument:    return frame.args.at(o.idx);
+        case Instr::Operand::Kind::Local:   return frame.locals[o.idx];
+        case Instr::Operand::Kind::Immediate:   break;
+        }
+        throw "";
+        };
+    // Read an integer operand (zero/sign extended to 64 bits), fails if it's out of range or has a relocation
+    auto read_int = [&](const Instr::Operand& o, unsigned size, bool is_signed, uint64_t& out)->bool {
+        if( o.kind == Instr::Operand::Kind::Immediate ) {
+            out = o.imm;
+        }
+        else {
+            const auto& v = get_slot(o);
+            if( o.ofs + size > v.size() || v.get_relocation(o.ofs) )
+                return false;
+            out = 0;
+            v.read_bytes(o.ofs, &out, size);   // TODO: Endian
+        }
+        if( size < 8 ) {
+            out &= (UINT64_C(1) << (size * 8)) - 1;
+            if( is_signed && (out >> (size * 8 - 1)) != 0 )
+                out |= ~UINT64_C(0) << (size * 8);
+        }
+        return true;
+        };
+
+#ifdef __GNUC__
+    // NOTE: Must be in the same order as `Function::Instr::Op`
+    static const void* const s_labels[] = {
+        &&op_Generic, &&op_Copy, &&op_Const, &&op_BinOp, &&op_SetDropFlag, &&op_Nop, &&op_Goto, &&op_If,
+        };
+# define OP(name)   op_##name:
+# define DISPATCH() goto *s_labels[static_cast<unsigned>(pc->op)]
+#else
+# define OP(name)   case Instr::Op::name:
+# define DISPATCH() goto dispatch
+#endif
+#define NEXT()  do { pc ++; m_instruction_count ++; DISPATCH(); } while(0)
+#define JUMP(tgt)   do { pc = code.data() + (tgt); m_instruction_count ++; DISPATCH(); } while(0)
+
+    try
+    {
+#ifdef __GNUC__
+        DISPATCH();
+#else
+    dispatch:
+        switch(pc->op)
+        {
+#endif
+        OP(Generic) {
+            goto generic;
+            }
+        OP(Copy) {
+            if( pc->size > 0 )
+            {
+                auto& src = get_slot(pc->a);
+                auto& dst = get_slot(pc->dst);
+                if( pc->a.ofs + pc->size > src.size() || pc->dst.ofs + pc->size > dst.size() )
+                    goto generic;
+                dst.write_value(pc->dst.ofs, src.read_value(pc->a.ofs, pc->size));
+            }
+            NEXT();
+            }
+        OP(Const) {
+            auto& dst = get_slot(pc->dst);
+            if( pc->dst.ofs + pc->size > dst.size() )
+                goto generic;
+            dst.write_bytes(pc->dst.ofs, &pc->a.imm, pc->size);   // TODO: Endian
+            NEXT();
+            }
+        OP(BinOp) {
+            uint64_t    l, r;
+            if( !read_int(pc->a, pc->size, pc->is_signed, l) || !read_int(pc->b, pc->size, pc->is_signed, r) )
+                goto generic;
+            auto& dst = get_slot(pc->dst);
+            int res;
+            switch(pc->binop)
+            {
+            case ::MIR::eBinOp::EQ: case ::MIR::eBinOp::NE:
+            case ::MIR::eBinOp::GT: case ::MIR::eBinOp::GE:
+            case ::MIR::eBinOp::LT: case ::MIR::eBinOp::LE: {
+                if( pc->dst.ofs + 1 > dst.size() )
+                    goto generic;
+                res = pc->is_signed
+                    ? Ops::do_compare(static_cast<int64_t>(l), static_cast<int64_t>(r))
+                    : Ops::do_compare(l, r);
+                bool res_bool;
+                switch(pc->binop)
+                {
+                case ::MIR::eBinOp::EQ: res_bool = (res == 0);  break;
+                case ::MIR::eBinOp::NE: res_bool = (res != 0);  break;
+                case ::MIR::eBinOp::GT: res_bool = (res == 1);  break;
+                case ::MIR::eBinOp::GE: res_bool = (res == 1 || res == 0);  break;
+                case ::MIR::eBinOp::LT: res_bool = (res == -1); break;
+                default:                res_bool = (res == -1 || res == 0); break;
+                }
+                dst.write_u8(pc->dst.ofs, res_bool ? 1 : 0);
+                } break;
+            default: {
+                if( pc->dst.ofs + pc->size > dst.size() )
+                    goto generic;
+                uint64_t    v;
+                switch(pc->binop)
+                {
+                case ::MIR::eBinOp::ADD:    v = l + r;  break;
+                case ::MIR::eBinOp::SUB:    v = l - r;  break;
+                case ::MIR::eBinOp::MUL:    v = l * r;  break;
+                case ::MIR::eBinOp::BIT_AND:    v = l & r;  break;
+                case ::MIR::eBinOp::BIT_OR: v = l | r;  break;
+                case ::MIR::eBinOp::BIT_XOR:    v = l ^ r;  break;
+                default:
+                    goto generic;
+                }
+                dst.write_bytes(pc->dst.ofs, &v, pc->size);    // TODO: Endian
+                } break;
+            }
+            NEXT();
+            }
+        OP(SetDropFlag) {
+            bool val = (pc->target[1] == ~0u ? false : frame.drop_flags.at(pc->target[1])) != pc->flag_val;
+            frame.drop_flags.at(pc->target[0]) = val;
+            NEXT();
+            }
+        OP(Nop) {
+            NEXT();
+            }
+        OP(Goto) {
+            JUMP(pc->target[0]);
+            }
+        OP(If) {
+            const auto& v = get_slot(pc->a);
+            if( pc->a.ofs + 1 > v.size() )
+                goto generic;
+            uint8_t b = v.read_u8(pc->a.ofs);
+            if( b > 1 )
+                goto generic;
+            JUMP(pc->target[b ? 0 : 1]);
+            }
+#ifndef __GNUC__
+        }
+#endif
+    }
+    catch(...)
+    {
+        frame.bb_idx = pc->bb_idx;
+        frame.stmt_idx = pc->stmt_idx;
+        throw;
+    }
+#undef JUMP
+#undef NEXT
+#undef DISPATCH
+#undef OP
+generic:
+    frame.bb_idx = pc->bb_idx;
+    frame.stmt_idx = pc->stmt_idx;
+}
 bool InterpreterThread::step_one(Value& out_thread_result)
 {
     assert( !this->m_stack.empty() );
     assert( !this->m_stack.back().cb );
     auto& cur_frame = this->m_stack.back();
+    if( !cur_frame.fcn->code.empty() )
+    {
+        this->run_predecoded(cur_frame);
+    }
     auto instr_idx = this->m_instruction_count++;
     TRACE_FUNCTION_R("#" << instr_idx << " " << cur_frame.fcn->my_path << " BB" << cur_frame.bb_idx << "/" << cur_frame.stmt_idx, "#" << instr_idx);
     const auto& bb = cur_frame.fcn->m_mir.blocks.at( cur_frame.bb_idx );
@@ -115,6 +115,8 @@ public:
     bool step_one(Value& out_thread_result);
 
 private:
+    // Runs pre-decoded instructions of `frame` until one needs `step_one`
+    void run_predecoded(StackFrame& frame);
     bool pop_stack(Value& out_thread_result);
 
     // Returns true if the call was resolved instantly
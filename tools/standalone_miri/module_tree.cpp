@@ -13,6 +13,8 @@
 #include <algorithm>    // std::find
 #include "debug.hpp"
 #include <path.h>
+#include <mmir_binary.hpp>
+#include <cstring>
 
 ModuleTree::ModuleTree()
 {
@@ -47,6 +49,15 @@ void ModuleTree::load_file(const ::std::string& path)
     }
 
     TRACE_FUNCTION_R(path, "");
+    {
+        char    magic[sizeof(MmirBinary::MAGIC)] = {};
+        ::std::ifstream(path, ::std::ios_base::in | ::std::ios_base::binary).read(magic, sizeof(magic));
+        if( ::std::memcmp(magic, MmirBinary::MAGIC, sizeof(magic)) == 0 )
+        {
+            load_binary_file(path);
+            return ;
+        }
+    }
     auto parse = Parser { *this, path };
 
     while(parse.parse_one())
@@ -54,6 +65,361 @@ void ModuleTree::load_file(const ::std::string& path)
         // Keep going!
     }
 }
+namespace {
+    /// Call `cb` on every lvalue in a function body
+    void visit_mir_lvalues(const ::MIR::Function& mir, ::std::function<void(const ::MIR::LValue&)> cb)
+    {
+        auto visit_param = [&](const ::MIR::Param& p) {
+            if( const auto* e = p.opt_LValue() )
+                cb(*e);
+            else if( const auto* e = p.opt_Borrow() )
+                cb(e->val);
+            };
+        auto visit_params = [&](const ::std::vector<::MIR::Param>& ps) {
+            for(const auto& p : ps)
+                visit_param(p);
+            };
+        for(const auto& bb : mir.blocks)
+        {
+            for(const auto& stmt : bb.statements)
+            {
+                TU_MATCH_HDRA( (stmt), {)
+                TU_ARMA(Assign, se) {
+                    cb(se.dst);
+                    TU_MATCH_HDRA( (se.src), {)
+                    TU_ARMA(Use, re)        cb(re);
+                    TU_ARMA(Borrow, re)     cb(re.val);
+                    TU_ARMA(Constant, re)   {}
+                    TU_ARMA(SizedArray, re) visit_param(re.val);
+                    TU_ARMA(Cast, re)       cb(re.val);
+                    TU_ARMA(BinOp, re)      { visit_param(re.val_l); visit_param(re.val_r); }
+                    TU_ARMA(UniOp, re)      cb(re.val);
+                    TU_ARMA(DstMeta, re)    cb(re.val);
+                    TU_ARMA(DstPtr, re)     cb(re.val);
+                    TU_ARMA(MakeDst, re)    { visit_param(re.ptr_val); visit_param(re.meta_val); }
+                    TU_ARMA(Tuple, re)      visit_params(re.vals);
+                    TU_ARMA(Array, re)      visit_params(re.vals);
+                    TU_ARMA(UnionVariant, re)   visit_param(re.val);
+                    TU_ARMA(EnumVariant, re)    visit_params(re.vals);
+                    TU_ARMA(Struct, re)     visit_params(re.vals);
+                    }
+                    }
+                TU_ARMA(Asm, se) {
+                    for(const auto& v : se.outputs)
+                        cb(v.second);
+                    for(const auto& v : se.inputs)
+                        cb(v.second);
+                    }
+                TU_ARMA(Asm2, se) {
+                    for(const auto& p : se.params)
+                    {
+                        if( const auto* e = p.opt_Reg() )
+                        {
+                            if( e->input )  visit_param(*e->input);
+                            if( e->output ) cb(*e->output);
+                        }
+                    }
+                    }
+                TU_ARMA(SetDropFlag, se) {}
+                TU_ARMA(Drop, se)   cb(se.slot);
+                TU_ARMA(ScopeEnd, se) {}
+                }
+            }
+            TU_MATCH_HDRA( (bb.terminator), {)
+            default:
+                break;
+            TU_ARMA(If, te)     cb(te.cond);
+            TU_ARMA(Switch, te) cb(te.val);
+            TU_ARMA(SwitchValue, te)    cb(te.val);
+            TU_ARMA(Call, te) {
+                cb(te.ret_val);
+                if( const auto* e = te.fcn.opt_Value() )
+                    cb(*e);
+                visit_params(te.args);
+                }
+            }
+        }
+    }
+}
+
+/// Resolve the leading `Field`/`Downcast` wrappers of every slot-rooted lvalue in `fcn` (see `Function::LValueLayout`)
+void ModuleTree::resolve_lvalue_layouts(const Function& fcn)
+{
+    visit_mir_lvalues(fcn.m_mir, [&](const ::MIR::LValue& lv) {
+        if( lv.m_wrappers.empty() )
+            return ;
+        const ::HIR::TypeRef* root_ty;
+        TU_MATCH_HDRA( (lv.m_root), {)
+        TU_ARMA(Return, e)  root_ty = &fcn.ret_ty;
+        TU_ARMA(Local, e)   root_ty = e < fcn.m_mir.locals.size() ? &fcn.m_mir.locals[e] : nullptr;
+        TU_ARMA(Argument, e)    root_ty = e < fcn.args.size() ? &fcn.args[e] : nullptr;
+        TU_ARMA(Static, e)  root_ty = nullptr;
+        }
+        if( !root_ty || *root_ty == RawType::Unreachable )
+            return ;
+
+        Function::LValueLayout  layout { 0, 0, SIZE_MAX, *root_ty };
+        for(const auto& w : lv.m_wrappers)
+        {
+            unsigned idx;
+            if( w.is_Field() )
+                idx = w.as_Field();
+            else if( w.is_Downcast() )
+                idx = w.as_Downcast();
+            else
+                break;
+            // Only resolve fields that `get_field` can handle without erroring, anything else is left for the interpreter to report
+            if( const auto* tw = layout.ty.get_wrapper() ) {
+                if( tw->type != TypeWrapper::Ty::Array || idx >= tw->size )
+                    break;
+            }
+            else {
+                if( layout.ty.inner_type != RawType::Composite || idx >= layout.ty.composite_type().fields.size() )
+                    break;
+            }
+            size_t  inner_ofs;
+            auto inner_ty = layout.ty.get_field(idx, inner_ofs);
+            layout.ofs += inner_ofs;
+            if( w.is_Field() && inner_ty.get_meta_type() == RawType::Unreachable )
+                layout.size = inner_ty.get_size();
+            layout.ty = ::std::move(inner_ty);
+            layout.n_wrappers ++;
+        }
+        if( layout.n_wrappers > 0 )
+            fcn.lvalue_layouts.insert(::std::make_pair(&lv, ::std::move(layout)));
+        });
+}
+
+namespace {
+    /// Resolve an lvalue that only accesses (sized) fields of a slot to the slot and a fixed offset
+    bool predecode_slot(const Function& fcn, const ::MIR::LValue& lv, Function::Instr::Operand& out, ::HIR::TypeRef& out_ty)
+    {
+        typedef Function::Instr::Operand::Kind  Kind;
+        const ::HIR::TypeRef* root_ty;
+        TU_MATCH_HDRA( (lv.m_root), {)
+        TU_ARMA(Return, e) {
+            out.kind = Kind::Return;
+            out.idx = 0;
+            root_ty = &fcn.ret_ty;
+            }
+        TU_ARMA(Local, e) {
+            if( e >= fcn.m_mir.locals.size() )
+                return false;
+            out.kind = Kind::Local;
+            out.idx = e;
+            root_ty = &fcn.m_mir.locals[e];
+            }
+        TU_ARMA(Argument, e) {
+            if( e >= fcn.args.size() )
+                return false;
+            out.kind = Kind::Argument;
+            out.idx = e;
+            root_ty = &fcn.args[e];
+            }
+        TU_ARMA(Static, e) {
+            return false;
+            }
+        }
+        if( *root_ty == RawType::Unreachable )
+            return false;
+        out.ofs = 0;
+        out.imm = 0;
+        if( lv.m_wrappers.empty() )
+        {
+            out_ty = *root_ty;
+        }
+        else
+        {
+            auto it = fcn.lvalue_layouts.find(&lv);
+            if( it == fcn.lvalue_layouts.end() || it->second.n_wrappers != lv.m_wrappers.size() )
+                return false;
+            out.ofs = it->second.ofs;
+            out_ty = it->second.ty;
+        }
+        return out_ty.get_meta_type() == RawType::Unreachable;
+    }
+    /// Resolve an integer/bool constant to an immediate
+    bool predecode_const(const ::MIR::Constant& c, Function::Instr::Operand& out, ::HIR::TypeRef& out_ty)
+    {
+        out.kind = Function::Instr::Operand::Kind::Immediate;
+        out.idx = 0;
+        out.ofs = 0;
+        out.imm = 0;
+        // NOTE: Only the leading bytes are used, the same as `MirHelpers::const_to_value`
+        TU_MATCH_HDRA( (c), {)
+        default:
+            return false;
+        TU_ARMA(Int, ce) {
+            out_ty = ::HIR::TypeRef(ce.t);
+            ::std::memcpy(&out.imm, &ce.v, sizeof(out.imm));
+            }
+        TU_ARMA(Uint, ce) {
+            out_ty = ::HIR::TypeRef(ce.t);
+            ::std::memcpy(&out.imm, &ce.v, sizeof(out.imm));
+            }
+        TU_ARMA(Bool, ce) {
+            out_ty = ::HIR::TypeRef(RawType::Bool);
+            out.imm = ce.v ? 1 : 0;
+            }
+        }
+        return out_ty.get_size() <= sizeof(out.imm);
+    }
+    /// Resolve a parameter that's either a slot (see `predecode_slot`) or an integer/bool constant
+    bool predecode_operand(const Function& fcn, const ::MIR::Param& p, Function::Instr::Operand& out, ::HIR::TypeRef& out_ty)
+    {
+        if( const auto* e = p.opt_LValue() )
+            return predecode_slot(fcn, *e, out, out_ty);
+        if( const auto* e = p.opt_Constant() )
+            return predecode_const(*e, out, out_ty);
+        return false;
+    }
+    /// Check if a `BinOp` can use the pre-decoded form, and if its operands are signed
+    bool predecode_binop_ty(::MIR::eBinOp op, const ::HIR::TypeRef& ty, bool& is_signed)
+    {
+        if( ty.get_wrapper() )
+            return false;
+        bool is_int = true;
+        switch(ty.inner_type)
+        {
+        case RawType::U8: case RawType::U16: case RawType::U32: case RawType::U64: case RawType::USize:
+            is_signed = false;
+            break;
+        case RawType::I8: case RawType::I16: case RawType::I32: case RawType::I64: case RawType::ISize:
+            is_signed = true;
+            break;
+        case RawType::Bool:
+        case RawType::Char:
+            is_signed = false;
+            is_int = false;
+            break;
+        default:
+            return false;
+        }
+        switch(op)
+        {
+        case ::MIR::eBinOp::EQ: case ::MIR::eBinOp::NE:
+        case ::MIR::eBinOp::GT: case ::MIR::eBinOp::GE:
+        case ::MIR::eBinOp::LT: case ::MIR::eBinOp::LE:
+            return true;
+        case ::MIR::eBinOp::BIT_AND: case ::MIR::eBinOp::BIT_OR: case ::MIR::eBinOp::BIT_XOR:
+            return is_int || ty.inner_type == RawType::Bool;
+        case ::MIR::eBinOp::ADD: case ::MIR::eBinOp::SUB: case ::MIR::eBinOp::MUL:
+            return is_int;
+        default:
+            return false;
+        }
+    }
+}
+
+/// Lower the body of `fcn` to `Function::code`
+/// - Statements/terminators that only shuffle primitives between slots get a form with the slot offsets and sizes
+///   resolved, and everything else is left as `Generic` (to be run by `InterpreterThread::step_one`)
+void ModuleTree::predecode(const Function& fcn)
+{
+    typedef Function::Instr Instr;
+    const auto& blocks = fcn.m_mir.blocks;
+    fcn.block_starts.clear();
+    fcn.block_starts.reserve(blocks.size());
+    unsigned n_instrs = 0;
+    for(const auto& bb : blocks)
+    {
+        fcn.block_starts.push_back(n_instrs);
+        n_instrs += static_cast<unsigned>(bb.statements.size() + 1);
+    }
+    fcn.code.clear();
+    fcn.code.reserve(n_instrs);
+
+    for(unsigned bb_idx = 0; bb_idx < blocks.size(); bb_idx ++)
+    {
+        const auto& bb = blocks[bb_idx];
+        for(unsigned stmt_idx = 0; stmt_idx <= bb.statements.size(); stmt_idx ++)
+        {
+            Instr   instr {};
+            instr.op = Instr::Op::Generic;
+            instr.bb_idx = bb_idx;
+            instr.stmt_idx = stmt_idx;
+
+            ::HIR::TypeRef  ty_dst, ty_a, ty_b;
+            if( stmt_idx < bb.statements.size() )
+            {
+                const auto& stmt = bb.statements[stmt_idx];
+                if( const auto* se = stmt.opt_Assign() )
+                {
+                    if( predecode_slot(fcn, se->dst, instr.dst, ty_dst) )
+                    {
+                        if( const auto* re = se->src.opt_Use() )
+                        {
+                            if( predecode_slot(fcn, *re, instr.a, ty_a) )
+                            {
+                                instr.op = Instr::Op::Copy;
+                                instr.size = static_cast<unsigned>(ty_a.get_size());
+                            }
+                        }
+                        else if( const auto* re = se->src.opt_Constant() )
+                        {
+                            if( predecode_const(*re, instr.a, ty_a) )
+                            {
+                                instr.op = Instr::Op::Const;
+                                instr.size = static_cast<unsigned>(ty_a.get_size());
+                            }
+                        }
+                        else if( const auto* re = se->src.opt_BinOp() )
+                        {
+                            if( predecode_operand(fcn, re->val_l, instr.a, ty_a)
+                             && predecode_operand(fcn, re->val_r, instr.b, ty_b)
+                             && ty_a == ty_b
+                             && predecode_binop_ty(re->op, ty_a, instr.is_signed)
+                                )
+                            {
+                                instr.op = Instr::Op::BinOp;
+                                instr.binop = re->op;
+                                instr.size = static_cast<unsigned>(ty_a.get_size());
+                            }
+                        }
+                    }
+                }
+                else if( const auto* se = stmt.opt_SetDropFlag() )
+                {
+                    instr.op = Instr::Op::SetDropFlag;
+                    instr.target[0] = se->idx;
+                    instr.target[1] = se->other;
+                    instr.flag_val = se->new_val;
+                }
+                else if( const auto* se = stmt.opt_Asm() )
+                {
+                    // An empty `asm!` is just a `black_box`
+                    if( se->tpl == "" && se->outputs.empty() )
+                        instr.op = Instr::Op::Nop;
+                }
+            }
+            else
+            {
+                TU_MATCH_HDRA( (bb.terminator), {)
+                default:
+                    break;
+                TU_ARMA(Goto, te) {
+                    if( te < blocks.size() )
+                    {
+                        instr.op = Instr::Op::Goto;
+                        instr.target[0] = fcn.block_starts[te];
+                    }
+                    }
+                TU_ARMA(If, te) {
+                    if( te.bb_true < blocks.size() && te.bb_false < blocks.size()
+                     && predecode_slot(fcn, te.cond, instr.a, ty_a) && ty_a.get_size() == 1 )
+                    {
+                        instr.op = Instr::Op::If;
+                        instr.target[0] = fcn.block_starts[te.bb_true];
+                        instr.target[1] = fcn.block_starts[te.bb_false];
+                    }
+                    }
+                }
+            }
+            fcn.code.push_back(instr);
+        }
+    }
+}
+
 void ModuleTree::validate()
 {
     TRACE_FUNCTION_R("", "");
@@ -64,14 +430,22 @@ void ModuleTree::validate()
     }
 #endif
 
-    for(const auto& fcn : this->functions)
+    for(auto& fcn : this->functions)
     {
         // TODO: This doesn't actually happen yet (this combination can't be parsed)
-        if( fcn.second.external.link_name != "" && !fcn.second.m_mir.blocks.empty() )
+        if( fcn.second.external.link_name != "" && fcn.second.has_body() )
         {
             LOG_DEBUG(fcn.first << " = '" << fcn.second.external.link_name << "'");
             ext_functions.insert(::std::make_pair( fcn.second.external.link_name, &fcn.second ));
         }
+
+        // Bodies from binary files are resolved when they're decoded
+        if( !fcn.second.lazy_body_file )
+        {
+            resolve_lvalue_layouts(fcn.second);
+            if( enable_predecode )
+                predecode(fcn.second);
+        }
     }
 }
 // Parse a single item from a .mir file
@@ -91,22 +465,7 @@ bool Parser::parse_one()
 
         lex.check_consume(';');
 
-        // TODO: If the file cannot be found, then search for it using some relative rules
-        if( !::std::ifstream(path).good() ) {
-            // parent 1 is the dir containing the current file, parent 2 is its parent
-            // - This is a massive hack for build scripts, that are compiled/invoked using an absolute path
-            auto d = ::helpers::path(lex.filename()).parent().parent();
-            if( ::std::ifstream((d / path).str()).good() ) {
-                path = (d / path).str();
-            }
-            else {
-                d = d.parent();
-                if( ::std::ifstream((d / path).str()).good() ) {
-                    path = (d / path).str();
-                }
-            }
-        }
-        this->tree.load_file(path);
+        this->tree.load_file(ModuleTree::find_crate_file(lex.filename(), ::std::move(path)));
     }
     else if( lex.consume_if("fn") )
     {
@@ -200,7 +559,7 @@ bool Parser::parse_one()
                         LOG_ERROR(lex << "Re-definition of " << p << " with differing bodies");
                     }
                 }
-                else {
+                else if( !exist.lazy_body_file ) {
                     exist.m_mir = ::std::move(body);
                 }
             }
@@ -1423,14 +1782,38 @@ RawType Parser::parse_core_type()
 }
 const DataType* Parser::get_composite(RcString gp)
 {
-    auto it = tree.data_types.find(gp);
-    if( it == tree.data_types.end() )
+    return tree.get_composite_ref(::std::move(gp));
+}
+
+::std::string ModuleTree::find_crate_file(const ::std::string& from_file, ::std::string path)
+{
+    // TODO: If the file cannot be found, then search for it using some relative rules
+    if( !::std::ifstream(path).good() ) {
+        // parent 1 is the dir containing the current file, parent 2 is its parent
+        // - This is a massive hack for build scripts, that are compiled/invoked using an absolute path
+        auto d = ::helpers::path(from_file).parent().parent();
+        if( ::std::ifstream((d / path).str()).good() ) {
+            path = (d / path).str();
+        }
+        else {
+            d = d.parent();
+            if( ::std::ifstream((d / path).str()).good() ) {
+                path = (d / path).str();
+            }
+        }
+    }
+    return path;
+}
+const DataType* ModuleTree::get_composite_ref(RcString gp)
+{
+    auto it = data_types.find(gp);
+    if( it == data_types.end() )
     {
         // TODO: Later on need to check if the type is valid.
         auto v = ::std::make_unique<DataType>(DataType {});
         v->populated = false;
         v->my_path = gp;
-        auto ir = tree.data_types.insert(::std::make_pair( ::std::move(gp), ::std::move(v)) );
+        auto ir = data_types.insert(::std::make_pair( ::std::move(gp), ::std::move(v)) );
         it = ir.first;
     }
     return it->second.get();
@@ -1443,6 +1826,8 @@ const Function& ModuleTree::get_function(const HIR::Path& p) const
     {
         LOG_ERROR("Unable to find function " << p << " for invoke");
     }
+    if( it->second.lazy_body_file )
+        load_body(it->second);
     return it->second;
 }
 const Function* ModuleTree::get_function_opt(const HIR::Path& p) const
@@ -1452,6 +1837,8 @@ const Function* ModuleTree::get_function_opt(const HIR::Path& p) const
     {
         return nullptr;
     }
+    if( it->second.lazy_body_file )
+        load_body(it->second);
     return &it->second;
 }
 const Function* ModuleTree::get_ext_function(const char* name) const
@@ -1461,6 +1848,8 @@ const Function* ModuleTree::get_ext_function(const char* name) const
     {
         return nullptr;
     }
+    if( it->second->lazy_body_file )
+        load_body(*it->second);
     return it->second;
 }
 const Static& ModuleTree::get_static(const HIR::Path& p) const
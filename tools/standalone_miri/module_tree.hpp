@@ -10,12 +10,16 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <memory>
 
 #include "../../src/include/rc_string.hpp"
 #include "../../src/mir/mir.hpp"
 #include "hir_sim.hpp"
 #include "value.hpp"
 
+struct BinaryMmirFile;
+
 struct Function
 {
     RcString    my_path;
@@ -28,7 +32,82 @@ struct Function
         ::std::string   link_name;
         ::std::string   link_abi;
     } external;
-    ::MIR::Function m_mir;
+    // NOTE: Mutable so the body can be decoded on first use (see `ModuleTree::load_body`)
+    mutable ::MIR::Function m_mir;
+
+    /// Pre-resolved leading `Field`/`Downcast` wrappers of an lvalue rooted in a slot (local/argument/return)
+    /// - These only depend on the (fixed) slot types, so are computed once after loading (see `ModuleTree::validate`)
+    struct LValueLayout {
+        /// Number of wrappers covered
+        unsigned    n_wrappers;
+        /// Offset from the start of the slot
+        size_t  ofs;
+        /// Size of the resulting value (SIZE_MAX if unchanged from the slot)
+        size_t  size;
+        ::HIR::TypeRef  ty;
+    };
+    mutable ::std::unordered_map<const ::MIR::LValue*, LValueLayout>   lvalue_layouts;
+
+    /// Pre-decoded instruction for one MIR statement/terminator (see `ModuleTree::predecode`)
+    /// - Only simple operations on slots have a pre-decoded form, everything else is `Generic` and handled by `step_one`
+    struct Instr
+    {
+        enum class Op : uint8_t {
+            /// Run the MIR statement/terminator through the full interpreter
+            Generic,
+            /// `dst = src` (sized copy between slots)
+            Copy,
+            /// `dst = imm` (integer/bool constant)
+            Const,
+            /// `dst = a <binop> b` (integers/bool/char up to 64 bits, falls back to `Generic` if either has a relocation)
+            BinOp,
+            /// `drop_flags[flag] = (other == ~0u ? false : drop_flags[other]) != flag_val`
+            SetDropFlag,
+            /// No-op (e.g. an empty `asm!`)
+            Nop,
+            /// Jump to `target[0]`
+            Goto,
+            /// Jump to `target[0]` if the bool in `a` is true, else to `target[1]`
+            If,
+        };
+        /// A slot (or an immediate), with the offset of the accessed field within it
+        struct Operand {
+            enum class Kind : uint8_t { Return, Argument, Local, Immediate } kind;
+            unsigned    idx;
+            size_t  ofs;
+            uint64_t    imm;
+        };
+
+        Op  op;
+        /// Operation for `BinOp`
+        ::MIR::eBinOp   binop;
+        /// Operands are signed integers (`BinOp`)
+        bool    is_signed;
+        /// New flag value (`SetDropFlag`)
+        bool    flag_val;
+        /// Size of the value being written (`Copy`/`Const`) or of the operands (`BinOp`)
+        unsigned    size;
+        /// Location in the MIR (for `Generic` and error reporting)
+        unsigned    bb_idx;
+        unsigned    stmt_idx;
+        Operand dst;
+        Operand a;
+        Operand b;
+        /// Instruction indexes for `Goto`/`If`, drop flag indexes for `SetDropFlag`
+        unsigned    target[2];
+    };
+    /// Pre-decoded body, with the statements of each block followed by its terminator
+    mutable ::std::vector<Instr>    code;
+    /// Index into `code` of the first statement of each block
+    mutable ::std::vector<unsigned> block_starts;
+
+    /// Binary file containing the (not yet decoded) body, and the offset of the body within it
+    mutable const BinaryMmirFile*   lazy_body_file = nullptr;
+    mutable size_t  lazy_body_ofs = 0;
+
+    bool has_body() const {
+        return lazy_body_file || !m_mir.blocks.empty();
+    }
 };
 struct Static
 {
@@ -79,7 +158,13 @@ class ModuleTree
     ::std::set<FunctionType>    function_types; // note: insertion doesn't invaliate pointers.
 
     ::std::map<RcString, const Function*> ext_functions;
+
+    /// Loaded binary files (kept mapped, as function bodies are decoded on first use)
+    ::std::vector<::std::shared_ptr<BinaryMmirFile>>    binary_files;
 public:
+    /// Lower function bodies to `Function::code` when they're loaded (`--no-predecode` clears this)
+    bool    enable_predecode = true;
+
     ModuleTree();
 
     void load_file(const ::std::string& path);
@@ -105,6 +190,8 @@ public:
     void iterate_functions(std::function<void(RcString name, const Function& s)> cb) const {
         for(const auto& e : this->functions)
         {
+            if( e.second.lazy_body_file )
+                load_body(e.second);
             cb(e.first, e.second);
         }
     }
@@ -114,6 +201,18 @@ public:
             cb(e.first, *e.second);
         }
     }
+
+private:
+    // module_tree_binary.cpp
+    void load_binary_file(const ::std::string& path);
+    void load_body(const Function& f) const;
+
+    /// Locate a `crate` referenced by `from_file`
+    static ::std::string find_crate_file(const ::std::string& from_file, ::std::string path);
+    /// Get a composite type by name, creating an unpopulated placeholder if it hasn't been defined yet
+    const DataType* get_composite_ref(RcString p);
+    static void resolve_lvalue_layouts(const Function& fcn);
+    static void predecode(const Function& fcn);
 };
 
 // struct/union/enum
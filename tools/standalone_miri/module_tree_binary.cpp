@@ -0,0 +1,776 @@
+/*
+ * mrustc Standalone MIRI
+ * - by John Hodge (Mutabah)
+ *
+ * module_tree_binary.cpp
+ * - Loading of binary .mir files (see `src/include/mmir_binary.hpp`)
+ */
+#include "module_tree.hpp"
+#include "debug.hpp"
+#include <mmir_binary.hpp>
+#include <cstring>
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# include <Windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+/// A memory-mapped binary MMIR file, along with its decoded string and type tables
+struct BinaryMmirFile
+{
+    ::std::string   path;
+    const uint8_t*  data = nullptr;
+    size_t  size = 0;
+#ifdef _WIN32
+    HANDLE  file_handle = INVALID_HANDLE_VALUE;
+    HANDLE  map_handle = NULL;
+#endif
+
+    ::std::vector<RcString> strings;
+    ::std::vector<::HIR::TypeRef>   types;
+
+    BinaryMmirFile(::std::string path):
+        path(::std::move(path))
+    {
+    }
+    BinaryMmirFile(const BinaryMmirFile&) = delete;
+    ~BinaryMmirFile()
+    {
+#ifdef _WIN32
+        if( data )  UnmapViewOfFile(data);
+        if( map_handle )    CloseHandle(map_handle);
+        if( file_handle != INVALID_HANDLE_VALUE )   CloseHandle(file_handle);
+#else
+        if( data )  munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    bool map()
+    {
+#ifdef _WIN32
+        file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if( file_handle == INVALID_HANDLE_VALUE )
+            return false;
+        LARGE_INTEGER   file_size;
+        if( !GetFileSizeEx(file_handle, &file_size) )
+            return false;
+        size = static_cast<size_t>(file_size.QuadPart);
+        map_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if( !map_handle )
+            return false;
+        data = static_cast<const uint8_t*>(MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0));
+        return data != nullptr;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if( fd < 0 )
+            return false;
+        struct stat st;
+        if( fstat(fd, &st) != 0 || st.st_size == 0 ) {
+            close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if( p == MAP_FAILED )
+            return false;
+        data = static_cast<const uint8_t*>(p);
+        return true;
+#endif
+    }
+};
+
+namespace {
+    const RawType S_PRIMITIVE_TYPES[] = {
+        RawType::USize, RawType::ISize,
+        RawType::U8, RawType::I8,
+        RawType::U16, RawType::I16,
+        RawType::U32, RawType::I32,
+        RawType::U64, RawType::I64,
+        RawType::U128, RawType::I128,
+        RawType::F32, RawType::F64,
+        RawType::Bool,
+        RawType::Char, RawType::Str,
+        };
+
+    /// Cursor over a binary file, decoding values written by `BinaryWriter` (trans/codegen_mmir.cpp)
+    struct Reader
+    {
+        const BinaryMmirFile& file;
+        const uint8_t*  cur;
+        const uint8_t*  end;
+
+        Reader(const BinaryMmirFile& file, size_t ofs, size_t end_ofs):
+            file(file),
+            cur(file.data + ofs),
+            end(file.data + end_ofs)
+        {
+        }
+
+        size_t ofs() const {
+            return cur - file.data;
+        }
+
+        uint64_t get_uint() {
+            uint64_t    rv;
+            if( !MmirBinary::read_uint(cur, end, rv) )
+                LOG_ERROR(file.path << ": Truncated file at offset " << ofs());
+            return rv;
+        }
+        int64_t get_sint() {
+            return MmirBinary::decode_sint(get_uint());
+        }
+        unsigned get_unsigned() {
+            return static_cast<unsigned>(get_uint());
+        }
+        uint8_t get_u8() {
+            if( cur == end )
+                LOG_ERROR(file.path << ": Truncated file at offset " << ofs());
+            return *cur++;
+        }
+        /// Index into a table of `count` entries
+        size_t get_idx(size_t count) {
+            auto v = get_uint();
+            if( v >= count )
+                LOG_ERROR(file.path << ": Index " << v << " out of range (" << count << ") at offset " << ofs());
+            return static_cast<size_t>(v);
+        }
+        ::std::string get_str() {
+            auto len = get_idx(end - cur + 1);
+            ::std::string   rv(reinterpret_cast<const char*>(cur), len);
+            cur += len;
+            return rv;
+        }
+        ::std::vector<uint8_t> get_bytes() {
+            auto len = get_idx(end - cur + 1);
+            ::std::vector<uint8_t>  rv(cur, cur + len);
+            cur += len;
+            return rv;
+        }
+        const RcString& get_istr() {
+            return file.strings[get_idx(file.strings.size())];
+        }
+        const ::HIR::TypeRef& get_type() {
+            return file.types[get_idx(file.types.size())];
+        }
+        RawType get_primitive() {
+            return S_PRIMITIVE_TYPES[get_idx(sizeof(S_PRIMITIVE_TYPES)/sizeof(S_PRIMITIVE_TYPES[0]))];
+        }
+
+        ::MIR::LValue get_lvalue()
+        {
+            ::MIR::LValue::Storage  root = ::MIR::LValue::Storage::new_Return();
+            switch( get_u8() )
+            {
+            case ::MIR::LValue::Storage::TAG_Return:    break;
+            case ::MIR::LValue::Storage::TAG_Argument:  root = ::MIR::LValue::Storage::new_Argument(get_unsigned()); break;
+            case ::MIR::LValue::Storage::TAG_Local:     root = ::MIR::LValue::Storage::new_Local(get_unsigned()); break;
+            case ::MIR::LValue::Storage::TAG_Static:    root = ::MIR::LValue::Storage::new_Static(HIR::Path { get_istr() }); break;
+            default:
+                LOG_ERROR(file.path << ": Bad lvalue at offset " << ofs());
+            }
+            ::std::vector<::MIR::LValue::Wrapper>   wrappers;
+            auto n_wrappers = get_idx(end - cur + 1);
+            wrappers.reserve(n_wrappers);
+            for(size_t i = 0; i < n_wrappers; i ++)
+                wrappers.push_back(::MIR::LValue::Wrapper::from_inner(static_cast<uint32_t>(get_uint())));
+            return ::MIR::LValue(::std::move(root), ::std::move(wrappers));
+        }
+        ::MIR::Constant get_constant()
+        {
+            switch( get_u8() )
+            {
+            case ::MIR::Constant::TAG_Int: {
+                auto lo = static_cast<uint64_t>(get_sint());
+                auto hi = static_cast<uint64_t>(get_sint());
+                return ::MIR::Constant::make_Int({ S128(U128(lo, hi)), ::HIR::CoreType { get_primitive() } });
+                }
+            case ::MIR::Constant::TAG_Uint: {
+                auto lo = get_uint();
+                auto hi = get_uint();
+                return ::MIR::Constant::make_Uint({ U128(lo, hi), ::HIR::CoreType { get_primitive() } });
+                }
+            case ::MIR::Constant::TAG_Float: {
+                auto bits = get_uint();
+                double  v;
+                ::std::memcpy(&v, &bits, sizeof(double));
+                return ::MIR::Constant::make_Float({ v, ::HIR::CoreType { get_primitive() } });
+                }
+            case ::MIR::Constant::TAG_Bool:
+                return ::MIR::Constant::make_Bool({ get_u8() != 0 });
+            case ::MIR::Constant::TAG_Bytes:
+                return ::MIR::Constant::make_Bytes(get_bytes());
+            case ::MIR::Constant::TAG_StaticString:
+                return ::MIR::Constant::make_StaticString(get_str());
+            case ::MIR::Constant::TAG_ItemAddr:
+                return ::MIR::Constant::make_ItemAddr({ ::std::make_unique<HIR::Path>(HIR::Path { get_istr() }) });
+            default:
+                LOG_ERROR(file.path << ": Bad constant at offset " << ofs());
+            }
+        }
+        ::MIR::Param get_param()
+        {
+            switch( get_u8() )
+            {
+            case ::MIR::Param::TAG_LValue:
+                return get_lvalue();
+            case ::MIR::Param::TAG_Borrow: {
+                auto bt = static_cast<::HIR::BorrowType>(get_u8());
+                return ::MIR::Param::make_Borrow({ bt, get_lvalue() });
+                }
+            case ::MIR::Param::TAG_Constant:
+                return get_constant();
+            default:
+                LOG_ERROR(file.path << ": Bad param at offset " << ofs());
+            }
+        }
+        ::std::vector<::MIR::Param> get_params()
+        {
+            ::std::vector<::MIR::Param> rv;
+            auto n = get_idx(end - cur + 1);
+            rv.reserve(n);
+            for(size_t i = 0; i < n; i ++)
+                rv.push_back(get_param());
+            return rv;
+        }
+        ::MIR::RValue get_rvalue()
+        {
+            switch( get_u8() )
+            {
+            case ::MIR::RValue::TAG_Use:
+                return ::MIR::RValue::make_Use(get_lvalue());
+            case ::MIR::RValue::TAG_Borrow: {
+                auto bt = static_cast<::HIR::BorrowType>(get_u8());
+                return ::MIR::RValue::make_Borrow({ bt, get_lvalue() });
+                }
+            case ::MIR::RValue::TAG_Constant:
+                return ::MIR::RValue::make_Constant(get_constant());
+            case ::MIR::RValue::TAG_SizedArray: {
+                auto val = get_param();
+                return ::MIR::RValue::make_SizedArray({ ::std::move(val), ::HIR::ArraySize { get_unsigned() } });
+                }
+            case ::MIR::RValue::TAG_Cast: {
+                auto val = get_lvalue();
+                return ::MIR::RValue::make_Cast({ ::std::move(val), get_type() });
+                }
+            case ::MIR::RValue::TAG_BinOp: {
+                auto val_l = get_param();
+                auto op = static_cast<::MIR::eBinOp>(get_u8());
+                return ::MIR::RValue::make_BinOp({ ::std::move(val_l), op, get_param() });
+                }
+            case ::MIR::RValue::TAG_UniOp: {
+                auto val = get_lvalue();
+                return ::MIR::RValue::make_UniOp({ ::std::move(val), static_cast<::MIR::eUniOp>(get_u8()) });
+                }
+            case ::MIR::RValue::TAG_DstMeta:
+                return ::MIR::RValue::make_DstMeta({ get_lvalue() });
+            case ::MIR::RValue::TAG_DstPtr:
+                return ::MIR::RValue::make_DstPtr({ get_lvalue() });
+            case ::MIR::RValue::TAG_MakeDst: {
+                auto ptr_val = get_param();
+                return ::MIR::RValue::make_MakeDst({ ::std::move(ptr_val), get_param() });
+                }
+            case ::MIR::RValue::TAG_Tuple:
+                return ::MIR::RValue::make_Tuple({ get_params() });
+            case ::MIR::RValue::TAG_Array:
+                return ::MIR::RValue::make_Array({ get_params() });
+            case ::MIR::RValue::TAG_UnionVariant: {
+                auto path = HIR::GenericPath { get_istr() };
+                auto idx = get_unsigned();
+                return ::MIR::RValue::make_UnionVariant({ ::std::move(path), idx, get_param() });
+                }
+            case ::MIR::RValue::TAG_EnumVariant: {
+                auto path = HIR::GenericPath { get_istr() };
+                auto idx = get_unsigned();
+                return ::MIR::RValue::make_EnumVariant({ ::std::move(path), idx, get_params() });
+                }
+            case ::MIR::RValue::TAG_Struct: {
+                auto path = HIR::GenericPath { get_istr() };
+                return ::MIR::RValue::make_Struct({ ::std::move(path), get_params() });
+                }
+            default:
+                LOG_ERROR(file.path << ": Bad rvalue at offset " << ofs());
+            }
+        }
+        ::MIR::Statement get_statement()
+        {
+            switch( get_u8() )
+            {
+            case ::MIR::Statement::TAG_Assign: {
+                auto dst = get_lvalue();
+                return ::MIR::Statement::make_Assign({ ::std::move(dst), get_rvalue() });
+                }
+            case ::MIR::Statement::TAG_Asm: {
+                ::MIR::Statement::Data_Asm  rv;
+                rv.tpl = get_str();
+                auto get_operands = [&](::std::vector<::std::pair<::std::string, ::MIR::LValue>>& out) {
+                    auto n = get_idx(end - cur + 1);
+                    for(size_t i = 0; i < n; i ++)
+                    {
+                        auto name = get_str();
+                        out.push_back(::std::make_pair(::std::move(name), get_lvalue()));
+                    }
+                    };
+                get_operands(rv.outputs);
+                get_operands(rv.inputs);
+                auto get_strings = [&](::std::vector<::std::string>& out) {
+                    auto n = get_idx(end - cur + 1);
+                    for(size_t i = 0; i < n; i ++)
+                        out.push_back(get_str());
+                    };
+                get_strings(rv.clobbers);
+                get_strings(rv.flags);
+                return ::MIR::Statement::make_Asm(::std::move(rv));
+                }
+            case ::MIR::Statement::TAG_Asm2: {
+                ::MIR::Statement::Data_Asm2 rv;
+                auto options = get_u8();
+                #define _(n,i)  rv.options.n = (options >> i) & 1
+                _(pure, 0);
+                _(nomem, 1);
+                _(readonly, 2);
+                _(preserves_flags, 3);
+                _(noreturn, 4);
+                _(nostack, 5);
+                _(att_syntax, 6);
+                #undef _
+                auto n_lines = get_idx(end - cur + 1);
+                for(size_t i = 0; i < n_lines; i ++)
+                {
+                    AsmCommon::Line line;
+                    auto n_frags = get_idx(end - cur + 1);
+                    for(size_t j = 0; j < n_frags; j ++)
+                    {
+                        AsmCommon::LineFragment frag;
+                        frag.before = get_str();
+                        frag.index = get_unsigned();
+                        frag.modifier = static_cast<char>(get_u8());
+                        line.frags.push_back(::std::move(frag));
+                    }
+                    line.trailing = get_str();
+                    rv.lines.push_back(::std::move(line));
+                }
+                auto n_params = get_idx(end - cur + 1);
+                for(size_t i = 0; i < n_params; i ++)
+                {
+                    switch( get_u8() )
+                    {
+                    case ::MIR::AsmParam::TAG_Const:
+                        rv.params.push_back(get_constant());
+                        break;
+                    case ::MIR::AsmParam::TAG_Sym:
+                        rv.params.push_back(HIR::Path { get_istr() });
+                        break;
+                    case ::MIR::AsmParam::TAG_Reg: {
+                        ::MIR::AsmParam::Data_Reg   param;
+                        param.dir = static_cast<AsmCommon::Direction>(get_u8());
+                        switch( get_u8() )
+                        {
+                        case AsmCommon::RegisterSpec::TAG_Class:
+                            param.spec = AsmCommon::RegisterSpec::make_Class(static_cast<AsmCommon::RegisterClass>(get_u8()));
+                            break;
+                        case AsmCommon::RegisterSpec::TAG_Explicit:
+                            param.spec = AsmCommon::RegisterSpec::make_Explicit(get_str());
+                            break;
+                        default:
+                            LOG_ERROR(file.path << ": Bad asm register at offset " << ofs());
+                        }
+                        if( get_u8() )
+                            param.input = ::std::make_unique<::MIR::Param>(get_param());
+                        if( get_u8() )
+                            param.output = ::std::make_unique<::MIR::LValue>(get_lvalue());
+                        rv.params.push_back(::std::move(param));
+                        } break;
+                    default:
+                        LOG_ERROR(file.path << ": Bad asm parameter at offset " << ofs());
+                    }
+                }
+                return ::MIR::Statement::make_Asm2(::std::move(rv));
+                }
+            case ::MIR::Statement::TAG_SetDropFlag: {
+                auto idx = get_unsigned();
+                bool new_val = get_u8() != 0;
+                auto other = get_unsigned();
+                return ::MIR::Statement::make_SetDropFlag({ idx, new_val, other - 1 });
+                }
+            case ::MIR::Statement::TAG_Drop: {
+                auto kind = static_cast<::MIR::eDropKind>(get_u8());
+                auto slot = get_lvalue();
+                auto flag_idx = get_unsigned();
+                return ::MIR::Statement::make_Drop({ kind, ::std::move(slot), flag_idx - 1 });
+                }
+            default:
+                LOG_ERROR(file.path << ": Bad statement at offset " << ofs());
+            }
+        }
+        ::MIR::Terminator get_terminator()
+        {
+            auto get_targets = [&]() {
+                ::std::vector<::MIR::BasicBlockId>  rv;
+                auto n = get_idx(end - cur + 1);
+                for(size_t i = 0; i < n; i ++)
+                    rv.push_back(get_unsigned());
+                return rv;
+                };
+            switch( get_u8() )
+            {
+            case ::MIR::Terminator::TAG_Incomplete:
+                return ::MIR::Terminator::make_Incomplete({});
+            case ::MIR::Terminator::TAG_Return:
+                return ::MIR::Terminator::make_Return({});
+            case ::MIR::Terminator::TAG_Diverge:
+                return ::MIR::Terminator::make_Diverge({});
+            case ::MIR::Terminator::TAG_Goto:
+                return ::MIR::Terminator::make_Goto(get_unsigned());
+            case ::MIR::Terminator::TAG_Panic:
+                return ::MIR::Terminator::make_Panic({ get_unsigned() });
+            case ::MIR::Terminator::TAG_If: {
+                auto cond = get_lvalue();
+                auto bb_true = get_unsigned();
+                return ::MIR::Terminator::make_If({ ::std::move(cond), bb_true, get_unsigned() });
+                }
+            case ::MIR::Terminator::TAG_Switch: {
+                auto val = get_lvalue();
+                return ::MIR::Terminator::make_Switch({ ::std::move(val), get_targets() });
+                }
+            case ::MIR::Terminator::TAG_SwitchValue: {
+                auto val = get_lvalue();
+                auto def_target = get_unsigned();
+                auto targets = get_targets();
+                ::MIR::SwitchValues values;
+                switch( get_u8() )
+                {
+                case ::MIR::SwitchValues::TAG_Unsigned: {
+                    ::std::vector<uint64_t> vals;
+                    for(size_t i = 0; i < targets.size(); i ++)
+                        vals.push_back(get_uint());
+                    values = ::MIR::SwitchValues::make_Unsigned(::std::move(vals));
+                    } break;
+                case ::MIR::SwitchValues::TAG_Signed: {
+                    ::std::vector<int64_t> vals;
+                    for(size_t i = 0; i < targets.size(); i ++)
+                        vals.push_back(get_sint());
+                    values = ::MIR::SwitchValues::make_Signed(::std::move(vals));
+                    } break;
+                case ::MIR::SwitchValues::TAG_String: {
+                    ::std::vector<::std::string> vals;
+                    for(size_t i = 0; i < targets.size(); i ++)
+                        vals.push_back(get_str());
+                    values = ::MIR::SwitchValues::make_String(::std::move(vals));
+                    } break;
+                case ::MIR::SwitchValues::TAG_ByteString: {
+                    ::std::vector<::std::vector<uint8_t>> vals;
+                    for(size_t i = 0; i < targets.size(); i ++)
+                        vals.push_back(get_bytes());
+                    values = ::MIR::SwitchValues::make_ByteString(::std::move(vals));
+                    } break;
+                default:
+                    LOG_ERROR(file.path << ": Bad switch values at offset " << ofs());
+                }
+                return ::MIR::Terminator::make_SwitchValue({ ::std::move(val), def_target, ::std::move(targets), ::std::move(values) });
+                }
+            case ::MIR::Terminator::TAG_Call: {
+                auto ret_block = get_unsigned();
+                auto panic_block = get_unsigned();
+                auto ret_val = get_lvalue();
+                ::MIR::CallTarget   ct;
+                switch( get_u8() )
+                {
+                case ::MIR::CallTarget::TAG_Value:
+                    ct = get_lvalue();
+                    break;
+                case ::MIR::CallTarget::TAG_Path:
+                    ct = HIR::Path { get_istr() };
+                    break;
+                case ::MIR::CallTarget::TAG_Intrinsic: {
+                    auto name = get_istr();
+                    ::HIR::PathParams   params;
+                    auto n = get_idx(end - cur + 1);
+                    for(size_t i = 0; i < n; i ++)
+                        params.tys.push_back(get_type());
+                    ct = ::MIR::CallTarget::make_Intrinsic({ ::std::move(name), ::std::move(params) });
+                    } break;
+                default:
+                    LOG_ERROR(file.path << ": Bad call target at offset " << ofs());
+                }
+                return ::MIR::Terminator::make_Call({ ret_block, panic_block, ::std::move(ret_val), ::std::move(ct), get_params() });
+                }
+            default:
+                LOG_ERROR(file.path << ": Bad terminator at offset " << ofs());
+            }
+        }
+        ::MIR::Function get_function_body()
+        {
+            ::MIR::Function rv;
+            auto n_locals = get_idx(end - cur + 1);
+            for(size_t i = 0; i < n_locals; i ++)
+                rv.locals.push_back(get_type());
+            auto n_drop_flags = get_idx(end - cur + 1);
+            for(size_t i = 0; i < n_drop_flags; i ++)
+                rv.drop_flags.push_back(get_u8() != 0);
+            auto n_blocks = get_idx(end - cur + 1);
+            rv.blocks.reserve(n_blocks);
+            for(size_t i = 0; i < n_blocks; i ++)
+            {
+                ::std::vector<::MIR::Statement> stmts;
+                auto n_stmts = get_idx(end - cur + 1);
+                stmts.reserve(n_stmts);
+                for(size_t j = 0; j < n_stmts; j ++)
+                    stmts.push_back(get_statement());
+                auto term = get_terminator();
+                rv.blocks.push_back(::MIR::BasicBlock { ::std::move(stmts), ::std::move(term) });
+            }
+            return rv;
+        }
+    };
+}
+
+void ModuleTree::load_binary_file(const ::std::string& path)
+{
+    auto file_ptr = ::std::make_shared<BinaryMmirFile>(path);
+    auto& file = *file_ptr;
+    if( !file.map() || file.size < MmirBinary::HEADER_SIZE )
+    {
+        LOG_ERROR("Unable to map binary MMIR file " << path);
+    }
+    uint64_t    trailer_ofs = 0;
+    for(size_t i = 0; i < 8; i ++)
+        trailer_ofs |= static_cast<uint64_t>(file.data[sizeof(MmirBinary::MAGIC) + i]) << (i*8);
+    if( trailer_ofs < MmirBinary::HEADER_SIZE || trailer_ofs > file.size )
+    {
+        LOG_ERROR(path << ": Bad trailer offset " << trailer_ofs);
+    }
+
+    Reader  tr { file, static_cast<size_t>(trailer_ofs), file.size };
+
+    // - String table
+    auto n_strings = tr.get_idx(file.size);
+    file.strings.reserve(n_strings);
+    for(size_t i = 0; i < n_strings; i ++)
+        file.strings.push_back(RcString::new_interned(tr.get_str()));
+
+    // - Type table (each type only refers to earlier entries)
+    auto n_types = tr.get_idx(file.size);
+    file.types.reserve(n_types);
+    for(size_t i = 0; i < n_types; i ++)
+    {
+        auto inner = [&]() {
+            return file.types[tr.get_idx(file.types.size())];
+            };
+        ::HIR::TypeRef  ty;
+        switch( static_cast<MmirBinary::TypeTag>(tr.get_u8()) )
+        {
+        case MmirBinary::TypeTag::Unit:
+            ty = ::HIR::TypeRef::unit();
+            break;
+        case MmirBinary::TypeTag::Diverge:
+            ty = ::HIR::TypeRef::diverge();
+            break;
+        case MmirBinary::TypeTag::Primitive:
+            ty = ::HIR::TypeRef(tr.get_primitive());
+            break;
+        case MmirBinary::TypeTag::Composite:
+            ty = ::HIR::TypeRef(get_composite_ref(tr.get_istr()));
+            break;
+        case MmirBinary::TypeTag::TraitObject:
+            ty = ::HIR::TypeRef(RawType::TraitObject);
+            ty.ptr.composite_type = get_composite_ref(tr.get_istr());
+            break;
+        case MmirBinary::TypeTag::Array: {
+            auto count = tr.get_uint();
+            ty = inner().wrap(TypeWrapper::Ty::Array, static_cast<size_t>(count));
+            } break;
+        case MmirBinary::TypeTag::Slice:
+            ty = inner().wrap(TypeWrapper::Ty::Slice, 0);
+            break;
+        case MmirBinary::TypeTag::Borrow: {
+            auto bt = tr.get_u8();
+            ty = inner().wrap(TypeWrapper::Ty::Borrow, bt);
+            } break;
+        case MmirBinary::TypeTag::Pointer: {
+            auto bt = tr.get_u8();
+            ty = inner().wrap(TypeWrapper::Ty::Pointer, bt);
+            } break;
+        case MmirBinary::TypeTag::Function: {
+            auto flags = tr.get_u8();
+            ::std::string abi = tr.get_istr().c_str();
+            ::std::vector<::HIR::TypeRef>   args;
+            auto n_args = tr.get_idx(file.size);
+            for(size_t j = 0; j < n_args; j ++)
+                args.push_back(inner());
+            auto ret_ty = inner();
+            auto ft = FunctionType {
+                (flags & 1) != 0,
+                (flags & 2) != 0,
+                abi == "" ? "Rust" : ::std::move(abi),
+                ::std::move(args),
+                ::std::move(ret_ty)
+                };
+            ty = ::HIR::TypeRef(&*function_types.insert(::std::move(ft)).first);
+            } break;
+        default:
+            LOG_ERROR(path << ": Bad type at offset " << tr.ofs());
+        }
+        file.types.push_back(::std::move(ty));
+    }
+
+    // - Dependencies (loaded before this file's items, same as `crate` in the textual form)
+    auto n_crates = tr.get_idx(file.size);
+    for(size_t i = 0; i < n_crates; i ++)
+    {
+        this->load_file(find_crate_file(path, tr.get_istr().c_str()));
+    }
+
+    // - Items
+    auto n_items = tr.get_idx(file.size);
+    for(size_t i = 0; i < n_items; i ++)
+    {
+        auto kind = static_cast<MmirBinary::ItemType>(tr.get_u8());
+        auto ofs = tr.get_idx(trailer_ofs);
+        Reader  r { file, ofs, static_cast<size_t>(trailer_ofs) };
+        switch(kind)
+        {
+        case MmirBinary::ItemType::Type: {
+            auto p = r.get_istr();
+            auto rv = DataType {};
+            rv.populated = true;
+            rv.my_path = p;
+            rv.size = static_cast<size_t>(r.get_uint());
+            rv.alignment = static_cast<size_t>(r.get_uint());
+            if( auto drop_glue = r.get_idx(file.strings.size() + 1) )
+                rv.drop_glue = HIR::Path { file.strings[drop_glue - 1] };
+            if( auto dst_meta = r.get_idx(file.types.size() + 1) )
+                rv.dst_meta = file.types[dst_meta - 1];
+            else
+                rv.dst_meta = ::HIR::TypeRef::diverge();
+            auto n_fields = r.get_idx(trailer_ofs);
+            for(size_t j = 0; j < n_fields; j ++)
+            {
+                auto ofs = static_cast<size_t>(r.get_uint());
+                rv.fields.push_back(::std::make_pair(ofs, r.get_type()));
+            }
+            auto n_variants = r.get_idx(trailer_ofs);
+            if( n_variants > 0 )
+            {
+                rv.tag_path.base_field = static_cast<size_t>(r.get_uint());
+                auto n_other = r.get_idx(trailer_ofs);
+                for(size_t j = 0; j < n_other; j ++)
+                    rv.tag_path.other_indexes.push_back(static_cast<size_t>(r.get_uint()));
+                for(size_t j = 0; j < n_variants; j ++)
+                {
+                    DataType::VariantValue  var;
+                    var.tag_data = r.get_str();
+                    var.data_field = static_cast<size_t>(r.get_uint()) - 1;
+                    rv.variants.push_back(::std::move(var));
+                }
+            }
+            if( rv.alignment == 0 && rv.fields.size() != 0 )
+            {
+                LOG_ERROR(path << ": Alignment of zero with fields is invalid, " << p);
+            }
+
+            LOG_DEBUG(path << ": type " << p);
+            auto it = this->data_types.find(p);
+            if( it == this->data_types.end() ) {
+                this->data_types.insert(::std::make_pair( p, ::std::make_unique<DataType>(::std::move(rv)) ));
+            }
+            else if( it->second->alignment == 0 ) {
+                *it->second = ::std::move(rv);
+            }
+            } break;
+        case MmirBinary::ItemType::Static: {
+            auto p = r.get_istr();
+            Static  s;
+            s.ty = r.get_type();
+            s.init.bytes = r.get_bytes();
+            auto n_relocs = r.get_idx(trailer_ofs);
+            for(size_t j = 0; j < n_relocs; j ++)
+            {
+                auto ofs = static_cast<size_t>(r.get_uint());
+                auto len = static_cast<size_t>(r.get_uint());
+                if( r.get_u8() )
+                    s.init.relocs.push_back( Static::InitValue::Relocation::new_item(ofs, len, HIR::Path { r.get_istr() }) );
+                else
+                    s.init.relocs.push_back( Static::InitValue::Relocation::new_string(ofs, len, r.get_str()) );
+            }
+
+            LOG_DEBUG(path << ": static " << p);
+            auto it = this->statics.find(p);
+            if( it == this->statics.end() ) {
+                this->statics.insert(::std::make_pair( p, ::std::move(s) ));
+            }
+            else {
+                if( it->second.ty != s.ty ) {
+                    LOG_ERROR("Redefinition of " << p << " with different types");
+                }
+                if( it->second.init.bytes.empty() ) {
+                    it->second.init = ::std::move(s.init);
+                }
+            }
+            } break;
+        case MmirBinary::ItemType::Function: {
+            auto p = r.get_istr();
+            ::std::vector<::HIR::TypeRef>   arg_tys;
+            auto n_args = r.get_idx(trailer_ofs);
+            for(size_t j = 0; j < n_args; j ++)
+                arg_tys.push_back(r.get_type());
+            auto rv_ty = r.get_type();
+            auto flags = r.get_u8();
+            Function::ExtInfo   ext;
+            if( flags & MmirBinary::FUNCTION_IS_EXTERN )
+            {
+                ext.link_name = r.get_str();
+                ext.link_abi = r.get_str();
+            }
+            bool is_variadic = (flags & MmirBinary::FUNCTION_IS_VARIADIC) != 0;
+            // The body isn't decoded until the function is used
+            const BinaryMmirFile* body_file = (flags & MmirBinary::FUNCTION_HAS_BODY) ? &file : nullptr;
+            size_t body_ofs = r.ofs();
+
+            LOG_DEBUG(path << ": fn " << p);
+            auto it = this->functions.find(p);
+            if( it == this->functions.end() ) {
+                Function    f { p, ::std::move(arg_tys), ::std::move(rv_ty), is_variadic, ::std::move(ext), {} };
+                f.lazy_body_file = body_file;
+                f.lazy_body_ofs = body_ofs;
+                this->functions.insert(::std::make_pair( p, ::std::move(f) ));
+            }
+            else {
+                auto& exist = it->second;
+                if( exist.args != arg_tys || exist.ret_ty != rv_ty || exist.is_variadic != is_variadic ) {
+                    LOG_NOTICE(path << ": Non-matching redefinition of " << p << "\n"
+                        << exist.args << " " << exist.ret_ty << "\n"
+                        << arg_tys << " " << rv_ty
+                        );
+                }
+                // NOTE: Unlike the textual form, duplicate bodies aren't compared (that would need both to be decoded)
+                if( body_file && !exist.has_body() ) {
+                    exist.lazy_body_file = body_file;
+                    exist.lazy_body_ofs = body_ofs;
+                }
+            }
+            } break;
+        default:
+            LOG_ERROR(path << ": Bad item kind at trailer offset " << tr.ofs());
+        }
+    }
+
+    binary_files.push_back(::std::move(file_ptr));
+}
+
+void ModuleTree::load_body(const Function& f) const
+{
+    assert(f.lazy_body_file);
+    const auto& file = *f.lazy_body_file;
+    TRACE_FUNCTION_R(f.my_path, "");
+    Reader  r { file, f.lazy_body_ofs, file.size };
+    f.m_mir = r.get_function_body();
+    f.lazy_body_file = nullptr;
+    resolve_lvalue_layouts(f);
+    if( enable_predecode )
+        predecode(f);
+}